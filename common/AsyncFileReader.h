@@ -0,0 +1,511 @@
+#ifndef ASYNC_FILE_READER_H
+#define ASYNC_FILE_READER_H
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Reads many whole files with io_uring, keeping up to `depth` opens and
+// reads in flight so the loader is not stalled on open() or on a cold
+// page cache one file at a time.
+//
+// Each in-flight file owns one slot: a buffer from a pool registered with
+// the kernel (IORING_REGISTER_BUFFERS), read with IORING_OP_READ_FIXED.
+// Files larger than a slot's buffer are read into a heap buffer instead.
+// Opens go through IORING_OP_OPENAT. When a file is complete, the handler
+// runs on the thread that called readAll() and typically hands the data to
+// a parser task; that task calls release(slot) when it is done with the
+// bytes, and the slot takes the next file.
+//
+// When every slot is held by a parser and nothing is in flight, readAll()
+// waits through the wait hook, which a task-based caller sets so the
+// waiting thread runs parser tasks instead of blocking.
+//
+// io_uring is used through raw syscalls (no liburing). available() is
+// false without Linux io_uring support, when the kernel or a seccomp
+// policy refuses it, or when the kernel's io_uring lacks OPENAT / READ
+// (IORING_REGISTER_PROBE); callers then read files the blocking way.
+// Should the ring fail part way (io_uring_enter errors, or an operation
+// comes back as unsupported), readAll() returns false and unreadFiles()
+// lists the files it never handed over, for the caller to read itself.
+//
+//   AsyncFileReader reader;
+//   if (reader.available() && !reader.readAll(paths, [&](const AsyncFileReader::File& f) { ...; reader.release(f.slot); }))
+//       for (size_t i : reader.unreadFiles()) ...   // blocking reads
+
+#if defined(__linux__)
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <mutex>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+class AsyncFileReader {
+public:
+    struct File {
+        size_t index;           // position in the paths passed to readAll()
+        const char* data;
+        size_t size;
+        int error;              // errno of the failed open / read, else 0
+        uint64_t ioNanos;       // open submitted to last byte read
+        int slot;               // pass to release()
+    };
+
+    typedef std::function<void(const File&)> Handler;
+    typedef std::function<void(const std::function<bool()>& ready)> WaitHook;
+
+    explicit AsyncFileReader(unsigned depth = 32, size_t bufferBytes = 1 << 20)
+        : bufferSize(bufferBytes) {
+        depth = std::max(1u, depth);
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        ringFd = static_cast<int>(syscall(__NR_io_uring_setup, depth * 2, &params));
+        if (ringFd < 0) {
+            reason = std::string("io_uring_setup: ") + std::strerror(errno);
+            return;
+        }
+        if (!mapRings(params)) {
+            reason = std::string("io_uring mmap: ") + std::strerror(errno);
+            return;
+        }
+        bool fixedReads = false;
+        if (!probeOps(fixedReads)) return;
+
+        // One anonymous mapping split into the slot buffers
+        poolBytes = bufferSize * depth;
+        void* pool = mmap(nullptr, poolBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (pool == MAP_FAILED) {
+            reason = std::string("buffer mmap: ") + std::strerror(errno);
+            return;
+        }
+        bufferPool = static_cast<char*>(pool);
+        slots.resize(depth);
+        std::vector<iovec> iovecs(depth);
+        for (unsigned i = 0; i < depth; ++i) {
+            slots[i].buffer = bufferPool + i * bufferSize;
+            iovecs[i].iov_base = slots[i].buffer;
+            iovecs[i].iov_len = bufferSize;
+            freeSlots.push_back(static_cast<int>(i));
+        }
+        // Registration pins the pages; without it (memlock limit, or no
+        // READ_FIXED) the same buffers are read with plain IORING_OP_READ
+        registered = fixedReads &&
+                     syscall(__NR_io_uring_register, ringFd, IORING_REGISTER_BUFFERS, iovecs.data(), depth) == 0;
+        ready = true;
+    }
+
+    ~AsyncFileReader() {
+        if (bufferPool) munmap(bufferPool, poolBytes);
+        if (sqes) munmap(sqes, sqeBytes);
+        if (cqRing && cqRing != sqRing) munmap(cqRing, cqRingBytes);
+        if (sqRing) munmap(sqRing, sqRingBytes);
+        if (ringFd >= 0) ::close(ringFd);
+    }
+
+    AsyncFileReader(const AsyncFileReader&) = delete;
+    AsyncFileReader& operator=(const AsyncFileReader&) = delete;
+
+    bool available() const { return ready; }
+    const std::string& unavailableReason() const { return reason; }
+    bool buffersRegistered() const { return registered; }
+    unsigned getDepth() const { return static_cast<unsigned>(slots.size()); }
+
+    void setWaitHook(WaitHook hook) { waitHook = std::move(hook); }
+
+    // Safe from any thread
+    void release(int slot) {
+        std::lock_guard<std::mutex> lock(freeMutex);
+        slots[slot].overflow.clear();
+        slots[slot].overflow.shrink_to_fit();
+        freeSlots.push_back(slot);
+        freeCount.store(freeSlots.size(), std::memory_order_release);
+        slotFreed.notify_one();
+    }
+
+    // handler(file) for every path, in completion order, on this thread;
+    // returns once every file was handed over (not necessarily released).
+    // False if io_uring failed part way: no further files are started, the
+    // operations in flight are drained, and unreadFiles() lists the files
+    // that were not handed over.
+    bool readAll(const std::vector<std::string>& paths, const Handler& handler) {
+        size_t next = 0;
+        size_t inFlight = 0;
+        failed = false;
+        unread.clear();
+        while ((next < paths.size() && !failed) || inFlight > 0) {
+            unsigned queued = 0;
+            int slot;
+            while (!failed && next < paths.size() && takeSlot(slot)) {
+                startOpen(slot, next, paths[next]);
+                ++next;
+                ++inFlight;
+                ++queued;
+            }
+            if (queued > 0 && !submit(queued)) inFlight -= dropUnsubmitted();
+
+            if (inFlight == 0) {
+                if (failed) break;
+                // Every slot is with a parser
+                std::function<bool()> slotFree = [this]() { return freeCount.load(std::memory_order_acquire) > 0; };
+                if (waitHook) {
+                    waitHook(slotFree);
+                } else {
+                    std::unique_lock<std::mutex> lock(freeMutex);
+                    slotFreed.wait(lock, [this]() { return !freeSlots.empty(); });
+                }
+                continue;
+            }
+            // Block for one completion, then reap all that are ready. If
+            // even waiting fails the operations in flight cannot be
+            // drained; their files are reported unread.
+            if (enter(0, 1, IORING_ENTER_GETEVENTS) < 0) {
+                fail("io_uring_enter");
+                for (size_t i = 0; i < slots.size(); ++i) {
+                    if (slots[i].busy) unread.push_back(slots[i].index);
+                }
+                break;
+            }
+            unsigned resubmit = 0;
+            reap([&](uint64_t userData, int result) {
+                int s = static_cast<int>(userData);
+                if (complete(s, result, handler, resubmit)) --inFlight;
+            });
+            if (resubmit > 0 && !submit(resubmit)) inFlight -= dropUnsubmitted();
+        }
+        for (; next < paths.size(); ++next) unread.push_back(next);
+        std::sort(unread.begin(), unread.end());
+        return !failed;
+    }
+
+    // Indexes of the paths the last readAll() did not hand over
+    const std::vector<size_t>& unreadFiles() const { return unread; }
+
+private:
+    struct Slot {
+        char* buffer = nullptr;
+        std::vector<char> overflow;   // files larger than the buffer
+        char* target = nullptr;
+        size_t index = 0;
+        int fd = -1;
+        size_t size = 0;
+        size_t done = 0;
+        bool opening = false;
+        bool busy = false;            // an operation is submitted or queued
+        std::chrono::steady_clock::time_point start;
+    };
+
+    size_t bufferSize;
+    int ringFd = -1;
+    bool ready = false;
+    bool registered = false;
+    bool failed = false;
+    std::string reason;
+    std::vector<size_t> unread;
+
+    void* sqRing = nullptr;
+    void* cqRing = nullptr;
+    size_t sqRingBytes = 0;
+    size_t cqRingBytes = 0;
+    io_uring_sqe* sqes = nullptr;
+    size_t sqeBytes = 0;
+    unsigned* sqHead = nullptr;
+    unsigned* sqTail = nullptr;
+    unsigned* sqMask = nullptr;
+    unsigned* sqArray = nullptr;
+    unsigned* cqHead = nullptr;
+    unsigned* cqTail = nullptr;
+    unsigned* cqMask = nullptr;
+    io_uring_cqe* cqes = nullptr;
+
+    char* bufferPool = nullptr;
+    size_t poolBytes = 0;
+    std::vector<Slot> slots;
+    std::mutex freeMutex;
+    std::condition_variable slotFreed;
+    std::vector<int> freeSlots;
+    std::atomic<size_t> freeCount{0};
+    WaitHook waitHook;
+
+    bool mapRings(const io_uring_params& p) {
+        sqRingBytes = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+        cqRingBytes = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+        bool single = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single) sqRingBytes = cqRingBytes = std::max(sqRingBytes, cqRingBytes);
+
+        sqRing = mmap(nullptr, sqRingBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQ_RING);
+        if (sqRing == MAP_FAILED) {
+            sqRing = nullptr;
+            return false;
+        }
+        if (single) {
+            cqRing = sqRing;
+        } else {
+            cqRing = mmap(nullptr, cqRingBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_CQ_RING);
+            if (cqRing == MAP_FAILED) {
+                cqRing = nullptr;
+                return false;
+            }
+        }
+        sqeBytes = p.sq_entries * sizeof(io_uring_sqe);
+        void* s = mmap(nullptr, sqeBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQES);
+        if (s == MAP_FAILED) return false;
+        sqes = static_cast<io_uring_sqe*>(s);
+
+        char* sq = static_cast<char*>(sqRing);
+        sqHead = reinterpret_cast<unsigned*>(sq + p.sq_off.head);
+        sqTail = reinterpret_cast<unsigned*>(sq + p.sq_off.tail);
+        sqMask = reinterpret_cast<unsigned*>(sq + p.sq_off.ring_mask);
+        sqArray = reinterpret_cast<unsigned*>(sq + p.sq_off.array);
+        char* cq = static_cast<char*>(cqRing);
+        cqHead = reinterpret_cast<unsigned*>(cq + p.cq_off.head);
+        cqTail = reinterpret_cast<unsigned*>(cq + p.cq_off.tail);
+        cqMask = reinterpret_cast<unsigned*>(cq + p.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(cq + p.cq_off.cqes);
+        return true;
+    }
+
+    // The opcodes readAll() needs; READ_FIXED only with registered buffers
+    bool probeOps(bool& fixedReads) {
+        const unsigned opCount = 256;
+        std::vector<char> bytes(sizeof(io_uring_probe) + opCount * sizeof(io_uring_probe_op), 0);
+        io_uring_probe* probe = reinterpret_cast<io_uring_probe*>(bytes.data());
+        if (syscall(__NR_io_uring_register, ringFd, IORING_REGISTER_PROBE, probe, opCount) != 0) {
+            reason = std::string("io_uring probe: ") + std::strerror(errno);
+            return false;
+        }
+        auto supported = [probe](unsigned op) {
+            return op < probe->ops_len && (probe->ops[op].flags & IO_URING_OP_SUPPORTED) != 0;
+        };
+        if (!supported(IORING_OP_OPENAT) || !supported(IORING_OP_READ)) {
+            reason = "io_uring without OPENAT / READ";
+            return false;
+        }
+        fixedReads = supported(IORING_OP_READ_FIXED);
+        return true;
+    }
+
+    void fail(const char* what) {
+        if (!failed) reason = std::string(what) + ": " + std::strerror(errno);
+        failed = true;
+    }
+
+    int enter(unsigned toSubmit, unsigned minComplete, unsigned flags) {
+        int r;
+        do {
+            r = static_cast<int>(syscall(__NR_io_uring_enter, ringFd, toSubmit, minComplete, flags, nullptr, 0));
+        } while (r < 0 && errno == EINTR);
+        return r;
+    }
+
+    // The ring holds 2 x depth entries and each slot has at most one
+    // operation queued, so a free entry always exists
+    io_uring_sqe* nextSqe() {
+        unsigned tail = *sqTail;
+        unsigned index = tail & *sqMask;
+        io_uring_sqe* sqe = &sqes[index];
+        std::memset(sqe, 0, sizeof(*sqe));
+        sqArray[index] = index;
+        __atomic_store_n(sqTail, tail + 1, __ATOMIC_RELEASE);
+        return sqe;
+    }
+
+    // False (and failed) if the kernel stops taking entries; the rest stay
+    // queued for dropUnsubmitted()
+    bool submit(unsigned count) {
+        while (count > 0) {
+            int r = enter(count, 0, 0);
+            if (r <= 0) {
+                if (r == 0) errno = EAGAIN;
+                fail("io_uring_enter");
+                return false;
+            }
+            count -= static_cast<unsigned>(r);
+        }
+        return true;
+    }
+
+    // Take back the entries the kernel never consumed (without SQPOLL it
+    // reads them only inside io_uring_enter); their files become unread
+    // and their slots free. Returns how many operations were dropped.
+    size_t dropUnsubmitted() {
+        unsigned head = __atomic_load_n(sqHead, __ATOMIC_ACQUIRE);
+        unsigned tail = *sqTail;
+        for (unsigned i = head; i != tail; ++i) {
+            int slot = static_cast<int>(sqes[sqArray[i & *sqMask]].user_data);
+            abandon(slot);
+        }
+        __atomic_store_n(sqTail, head, __ATOMIC_RELEASE);
+        return tail - head;
+    }
+
+    // The slot's file will not be handed over
+    void abandon(int slot) {
+        Slot& s = slots[slot];
+        if (s.fd >= 0) ::close(s.fd);
+        s.fd = -1;
+        s.busy = false;
+        unread.push_back(s.index);
+        release(slot);
+    }
+
+    template <typename Fn>
+    void reap(Fn fn) {
+        unsigned head = *cqHead;
+        unsigned tail = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+        while (head != tail) {
+            const io_uring_cqe& cqe = cqes[head & *cqMask];
+            fn(cqe.user_data, cqe.res);
+            ++head;
+        }
+        __atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+    }
+
+    bool takeSlot(int& slot) {
+        std::lock_guard<std::mutex> lock(freeMutex);
+        if (freeSlots.empty()) return false;
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+        freeCount.store(freeSlots.size(), std::memory_order_release);
+        return true;
+    }
+
+    void startOpen(int slot, size_t index, const std::string& path) {
+        Slot& s = slots[slot];
+        s.index = index;
+        s.fd = -1;
+        s.size = 0;
+        s.done = 0;
+        s.opening = true;
+        s.busy = true;
+        s.start = std::chrono::steady_clock::now();
+        io_uring_sqe* sqe = nextSqe();
+        sqe->opcode = IORING_OP_OPENAT;
+        sqe->fd = AT_FDCWD;
+        sqe->addr = reinterpret_cast<uint64_t>(path.c_str());
+        sqe->open_flags = O_RDONLY | O_CLOEXEC;
+        sqe->user_data = static_cast<uint64_t>(slot);
+    }
+
+    void queueRead(int slot) {
+        Slot& s = slots[slot];
+        size_t remaining = s.size - s.done;
+        io_uring_sqe* sqe = nextSqe();
+        sqe->fd = s.fd;
+        sqe->addr = reinterpret_cast<uint64_t>(s.target + s.done);
+        sqe->len = static_cast<uint32_t>(std::min<size_t>(remaining, 1u << 30));
+        sqe->off = s.done;
+        sqe->user_data = static_cast<uint64_t>(slot);
+        if (registered && s.target == s.buffer) {
+            sqe->opcode = IORING_OP_READ_FIXED;
+            sqe->buf_index = static_cast<uint16_t>(slot);
+        } else {
+            sqe->opcode = IORING_OP_READ;
+        }
+    }
+
+    // One completion for a slot; true when its file was handed over or,
+    // after an unsupported operation, abandoned
+    bool complete(int slot, int result, const Handler& handler, unsigned& resubmit) {
+        Slot& s = slots[slot];
+        if (result == -EINVAL || result == -EOPNOTSUPP) {
+            errno = -result;
+            fail(s.opening ? "io_uring openat" : "io_uring read");
+            abandon(slot);
+            return true;
+        }
+        if (s.opening) {
+            s.opening = false;
+            struct stat info;
+            if (result < 0) return finish(slot, -result, handler);
+            s.fd = result;
+            if (fstat(s.fd, &info) != 0) return finish(slot, errno, handler);
+            s.size = static_cast<size_t>(info.st_size);
+            if (s.size > bufferSize) {
+                s.overflow.resize(s.size);
+                s.target = s.overflow.data();
+            } else {
+                s.target = s.buffer;
+            }
+            if (s.size == 0) return finish(slot, 0, handler);
+            queueRead(slot);
+            ++resubmit;
+            return false;
+        }
+        if (result < 0 && result != -EAGAIN && result != -EINTR) return finish(slot, -result, handler);
+        if (result > 0) s.done += static_cast<size_t>(result);
+        // EOF before the stat size means the file shrank; hand over what was read
+        if (s.done >= s.size || result == 0) {
+            s.size = s.done;
+            return finish(slot, 0, handler);
+        }
+        queueRead(slot);
+        ++resubmit;
+        return false;
+    }
+
+    bool finish(int slot, int error, const Handler& handler) {
+        Slot& s = slots[slot];
+        if (s.fd >= 0) ::close(s.fd);
+        s.fd = -1;
+        s.busy = false;
+        File file;
+        file.index = s.index;
+        file.data = s.target;
+        file.size = error ? 0 : s.size;
+        file.error = error;
+        file.ioNanos = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - s.start).count());
+        file.slot = slot;
+        handler(file);
+        return true;
+    }
+};
+
+#else  // !__linux__
+
+class AsyncFileReader {
+public:
+    struct File {
+        size_t index;
+        const char* data;
+        size_t size;
+        int error;
+        uint64_t ioNanos;
+        int slot;
+    };
+    typedef std::function<void(const File&)> Handler;
+    typedef std::function<void(const std::function<bool()>& ready)> WaitHook;
+
+    explicit AsyncFileReader(unsigned = 32, size_t = 1 << 20) {}
+    bool available() const { return false; }
+    const std::string& unavailableReason() const { return reason; }
+    bool buffersRegistered() const { return false; }
+    unsigned getDepth() const { return 0; }
+    void setWaitHook(WaitHook) {}
+    void release(int) {}
+    bool readAll(const std::vector<std::string>& paths, const Handler&) {
+        unread.resize(paths.size());
+        for (size_t i = 0; i < paths.size(); ++i) unread[i] = i;
+        return false;
+    }
+    const std::vector<size_t>& unreadFiles() const { return unread; }
+
+private:
+    std::string reason = "io_uring needs Linux";
+    std::vector<size_t> unread;
+};
+
+#endif  // __linux__
+
+#endif  // ASYNC_FILE_READER_H
@@ -0,0 +1,461 @@
+#ifndef BENCH_HARNESS_H
+#define BENCH_HARNESS_H
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+#include "Metrics.h"
+#include "PerfCounters.h"
+#include "Trace.h"
+
+// Small benchmark harness shared by the fire-data and world-bank bench
+// targets: warm-up runs, repeated timed runs, median / p99 with a
+// distribution-free 95% confidence interval for the median, and a
+// Google-Benchmark-like JSON report for tracking regressions.
+//
+// Cases run at several thread counts also get speedup and parallel
+// efficiency against the same case at the lowest thread count, printed as
+// a scaling table and written to the JSON / CSV reports.
+
+struct BenchOptions {
+    int warmup = 2;
+    int repetitions = 15;
+    std::string filter;     // run only benchmarks whose name contains this
+    std::string jsonPath;   // write the JSON report here if set
+    std::string dataPath;   // dataset location, meaning is up to the caller
+    std::string csvPath;    // write the scaling CSV here if set
+    std::string metricsPath; // counters / histograms (.json or Prometheus text)
+    std::string tracePath;  // Chrome trace of the whole run
+    std::vector<int> threadCounts;
+    bool scaling = false;   // thread-count sweep: print the scaling table
+    bool pinThreads = false;
+    bool perfCounters = false; // read hardware counters around every case
+};
+
+struct BenchResult {
+    std::string name;
+    std::string baseName;   // name without the /threads:N suffix
+    int threads = 1;
+    std::vector<double> samplesMs;
+    double minMs = 0, maxMs = 0, meanMs = 0, stddevMs = 0;
+    double medianMs = 0, p99Ms = 0;
+    double ciLowMs = 0, ciHighMs = 0;
+    // Relative to the same case at its lowest thread count
+    double speedup = 1.0, efficiency = 1.0;
+    // Hardware counters per repetition (--perf), rows = rows touched per run
+    bool hasCounters = false;
+    PerfCounters::Sample counters;
+    size_t rows = 0;
+};
+
+class BenchSuite {
+private:
+    std::string suiteName;
+    BenchOptions options;
+    std::vector<BenchResult> results;
+    PerfCounters perf;
+    size_t rowsPerRun = 0;
+
+    static double percentile(const std::vector<double>& sorted, double p) {
+        // Nearest-rank percentile
+        size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * sorted.size()));
+        rank = std::min(std::max<size_t>(rank, 1), sorted.size());
+        return sorted[rank - 1];
+    }
+
+    static void summarise(BenchResult& result) {
+        std::vector<double> sorted = result.samplesMs;
+        std::sort(sorted.begin(), sorted.end());
+        size_t n = sorted.size();
+
+        result.minMs = sorted.front();
+        result.maxMs = sorted.back();
+        result.medianMs = n % 2 ? sorted[n / 2] : (sorted[n / 2 - 1] + sorted[n / 2]) / 2.0;
+        result.p99Ms = percentile(sorted, 99.0);
+
+        double sum = 0;
+        for (double s : sorted) sum += s;
+        result.meanMs = sum / n;
+        double var = 0;
+        for (double s : sorted) var += (s - result.meanMs) * (s - result.meanMs);
+        result.stddevMs = n > 1 ? std::sqrt(var / (n - 1)) : 0.0;
+
+        // 95% CI for the median from order statistics: ranks n/2 -+ 1.96*sqrt(n)/2
+        double half = 1.96 * std::sqrt(static_cast<double>(n)) / 2.0;
+        long lo = static_cast<long>(std::floor(n / 2.0 - half));
+        long hi = static_cast<long>(std::ceil(n / 2.0 + half));
+        lo = std::max(lo, 1L);
+        hi = std::min(hi, static_cast<long>(n));
+        result.ciLowMs = sorted[lo - 1];
+        result.ciHighMs = sorted[hi - 1];
+    }
+
+    // speedup = baseline median / median, efficiency = speedup / (threads / baseline threads)
+    static void computeScaling(std::vector<BenchResult>& list) {
+        for (BenchResult& r : list) {
+            const BenchResult* baseline = &r;
+            for (const BenchResult& other : list) {
+                if (other.baseName == r.baseName && other.threads < baseline->threads) {
+                    baseline = &other;
+                }
+            }
+            r.speedup = r.medianMs > 0 ? baseline->medianMs / r.medianMs : 0.0;
+            r.efficiency = r.speedup * baseline->threads / r.threads;
+        }
+    }
+
+    static std::string jsonEscape(const std::string& text) {
+        std::string out;
+        for (char c : text) {
+            if (c == '"' || c == '\\') out += '\\';
+            out += c;
+        }
+        return out;
+    }
+
+public:
+    BenchSuite(const std::string& name, const BenchOptions& benchOptions)
+        : suiteName(name), options(benchOptions) {
+        if (!options.tracePath.empty()) {
+            TraceRecorder::instance().start();
+        }
+        if (options.perfCounters) {
+            if (!perf.open()) {
+                std::cerr << "Hardware counters off: " << perf.unavailableReason() << std::endl;
+            } else if (!perf.unavailableReason().empty()) {
+                std::cerr << "Hardware counters " << perf.unavailableReason() << std::endl;
+            }
+        }
+    }
+
+    // Counters opened for --perf; threads created before the suite (an
+    // OpenMP pool) must attach themselves to be counted
+    PerfCounters& getPerfCounters() { return perf; }
+
+    // Rows each run of the following cases touches, for per-row counter figures
+    void setRowsPerRun(size_t rows) { rowsPerRun = rows; }
+
+    const BenchOptions& getOptions() const { return options; }
+    const std::vector<BenchResult>& getResults() const { return results; }
+
+    bool selected(const std::string& name) const {
+        return options.filter.empty() || name.find(options.filter) != std::string::npos;
+    }
+
+    // Times fn() after the warm-up runs. repetitions <= 0 uses the suite default;
+    // slow cases such as a full load can ask for fewer.
+    template<typename Func>
+    const BenchResult* run(const std::string& name, int threads, Func&& fn, int repetitions = 0) {
+        std::string fullName = name + "/threads:" + std::to_string(threads);
+        if (!selected(fullName)) {
+            return nullptr;
+        }
+
+        int reps = repetitions > 0 ? repetitions : options.repetitions;
+        int warmup = repetitions > 0 ? std::min(options.warmup, 1) : options.warmup;
+        for (int i = 0; i < warmup; ++i) {
+            fn();
+        }
+
+        BenchResult result;
+        result.name = fullName;
+        result.baseName = name;
+        result.threads = threads;
+        result.rows = rowsPerRun;
+        PerfCounters::Sample before;
+        if (perf.isOpen()) {
+            before = perf.read();
+        }
+        for (int i = 0; i < reps; ++i) {
+            auto start = std::chrono::steady_clock::now();
+            fn();
+            auto end = std::chrono::steady_clock::now();
+            result.samplesMs.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+        }
+        if (perf.isOpen()) {
+            result.counters = PerfCounters::Sample::delta(before, perf.read(), reps);
+            result.hasCounters = true;
+        }
+        summarise(result);
+
+        std::cerr << "  " << std::setw(52) << std::left << fullName
+                  << " median " << std::fixed << std::setprecision(4) << result.medianMs << " ms" << std::endl;
+        results.push_back(result);
+        computeScaling(results);
+        return &results.back();
+    }
+
+    void printTable(std::ostream& out) const {
+        out << "\n" << std::string(104, '=') << "\n";
+        out << std::setw(52) << std::left << suiteName
+            << std::setw(13) << std::right << "median (ms)"
+            << std::setw(13) << std::right << "p99 (ms)"
+            << std::setw(26) << std::right << "95% CI of median (ms)" << "\n";
+        out << std::string(104, '-') << "\n";
+        for (const BenchResult& r : results) {
+            std::ostringstream ci;
+            ci << std::fixed << std::setprecision(4) << r.ciLowMs << " - " << r.ciHighMs;
+            out << std::setw(52) << std::left << r.name
+                << std::setw(13) << std::right << std::fixed << std::setprecision(4) << r.medianMs
+                << std::setw(13) << std::right << r.p99Ms
+                << std::setw(26) << std::right << ci.str() << "\n";
+        }
+    }
+
+    // IPC and misses per row (per run if the row count is unknown)
+    void printCounterTable(std::ostream& out) const {
+        out << "\n" << std::string(129, '=') << "\n";
+        out << std::setw(52) << std::left << "hardware counters (per row)"
+            << std::setw(8) << std::right << "IPC"
+            << std::setw(12) << std::right << "cycles"
+            << std::setw(12) << std::right << "instr"
+            << std::setw(12) << std::right << "LLC miss"
+            << std::setw(11) << std::right << "br miss"
+            << std::setw(11) << std::right << "dTLB miss"
+            << std::setw(11) << std::right << "faults" << "\n";
+        out << std::string(129, '-') << "\n";
+        const PerfCounters::Event perRow[] = {
+            PerfCounters::CYCLES, PerfCounters::INSTRUCTIONS, PerfCounters::LLC_MISSES,
+            PerfCounters::BRANCH_MISSES, PerfCounters::DTLB_MISSES, PerfCounters::PAGE_FAULTS
+        };
+        const int widths[] = {12, 12, 12, 11, 11, 11};
+        for (const BenchResult& r : results) {
+            if (!r.hasCounters) continue;
+            double divisor = r.rows > 0 ? static_cast<double>(r.rows) : 1.0;
+            out << std::setw(52) << std::left << r.name << std::setw(8) << std::right;
+            if (r.counters.has(PerfCounters::CYCLES) && r.counters.has(PerfCounters::INSTRUCTIONS)) {
+                out << std::fixed << std::setprecision(2) << r.counters.ipc();
+            } else {
+                out << "-";
+            }
+            for (int i = 0; i < 6; ++i) {
+                out << std::setw(widths[i]) << std::right;
+                if (r.counters.has(perRow[i])) {
+                    out << std::fixed << std::setprecision(3) << r.counters.get(perRow[i]) / divisor;
+                } else {
+                    out << "-";
+                }
+            }
+            out << "\n";
+        }
+    }
+
+    // Wall time, speedup and efficiency per case, grouped by case
+    void printScalingTable(std::ostream& out) const {
+        std::vector<std::string> order;
+        for (const BenchResult& r : results) {
+            if (std::find(order.begin(), order.end(), r.baseName) == order.end()) {
+                order.push_back(r.baseName);
+            }
+        }
+
+        out << "\n" << std::string(92, '=') << "\n";
+        out << std::setw(44) << std::left << suiteName + " scaling"
+            << std::setw(9) << std::right << "threads"
+            << std::setw(13) << std::right << "median (ms)"
+            << std::setw(12) << std::right << "speedup"
+            << std::setw(14) << std::right << "efficiency" << "\n";
+        out << std::string(92, '-') << "\n";
+        for (const std::string& baseName : order) {
+            for (const BenchResult& r : results) {
+                if (r.baseName != baseName) continue;
+                out << std::setw(44) << std::left << r.baseName
+                    << std::setw(9) << std::right << r.threads
+                    << std::setw(13) << std::right << std::fixed << std::setprecision(4) << r.medianMs
+                    << std::setw(11) << std::right << std::setprecision(2) << r.speedup << "x"
+                    << std::setw(13) << std::right << std::setprecision(1) << r.efficiency * 100.0 << "%\n";
+            }
+        }
+    }
+
+    bool writeCSV(const std::string& path) const {
+        std::ofstream out(path);
+        if (!out.is_open()) {
+            std::cerr << "Error: could not write " << path << std::endl;
+            return false;
+        }
+
+        out << "benchmark,threads,pinned,repetitions,median_ms,p99_ms,mean_ms,stddev_ms,speedup,efficiency\n";
+        out << std::setprecision(6) << std::fixed;
+        for (const BenchResult& r : results) {
+            std::string name = r.baseName;
+            if (name.find_first_of(",\"") != std::string::npos) {
+                std::string quoted = "\"";
+                for (char c : name) {
+                    if (c == '"') quoted += '"';
+                    quoted += c;
+                }
+                name = quoted + "\"";
+            }
+            out << name << "," << r.threads << "," << (options.pinThreads ? 1 : 0) << ","
+                << r.samplesMs.size() << "," << r.medianMs << "," << r.p99Ms << ","
+                << r.meanMs << "," << r.stddevMs << "," << r.speedup << "," << r.efficiency << "\n";
+        }
+        return true;
+    }
+
+    bool writeJSON(const std::string& path) const {
+        std::ofstream out(path);
+        if (!out.is_open()) {
+            std::cerr << "Error: could not write " << path << std::endl;
+            return false;
+        }
+
+        char host[256] = "unknown";
+        gethostname(host, sizeof(host) - 1);
+        std::time_t now = std::time(nullptr);
+        char date[64];
+        std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+        out << "{\n  \"context\": {\n"
+            << "    \"suite\": \"" << jsonEscape(suiteName) << "\",\n"
+            << "    \"date\": \"" << date << "\",\n"
+            << "    \"host_name\": \"" << jsonEscape(host) << "\",\n"
+            << "    \"num_cpus\": " << sysconf(_SC_NPROCESSORS_ONLN) << ",\n"
+            << "    \"warmup\": " << options.warmup << ",\n"
+            << "    \"repetitions\": " << options.repetitions << ",\n"
+            << "    \"pinned_threads\": " << (options.pinThreads ? "true" : "false") << "\n"
+            << "  },\n  \"benchmarks\": [";
+
+        out << std::setprecision(6) << std::fixed;
+        for (size_t i = 0; i < results.size(); ++i) {
+            const BenchResult& r = results[i];
+            out << (i ? "," : "") << "\n    {\n"
+                << "      \"name\": \"" << jsonEscape(r.name) << "\",\n"
+                << "      \"threads\": " << r.threads << ",\n"
+                << "      \"repetitions\": " << r.samplesMs.size() << ",\n"
+                << "      \"time_unit\": \"ms\",\n"
+                << "      \"median\": " << r.medianMs << ",\n"
+                << "      \"p99\": " << r.p99Ms << ",\n"
+                << "      \"mean\": " << r.meanMs << ",\n"
+                << "      \"stddev\": " << r.stddevMs << ",\n"
+                << "      \"min\": " << r.minMs << ",\n"
+                << "      \"max\": " << r.maxMs << ",\n"
+                << "      \"median_ci95_low\": " << r.ciLowMs << ",\n"
+                << "      \"median_ci95_high\": " << r.ciHighMs << ",\n"
+                << "      \"speedup\": " << r.speedup << ",\n"
+                << "      \"efficiency\": " << r.efficiency;
+            if (r.hasCounters) {
+                out << ",\n      \"rows\": " << r.rows << ",\n      \"counters_per_run\": {";
+                bool firstCounter = true;
+                for (int e = 0; e < PerfCounters::EVENT_COUNT; ++e) {
+                    if (!r.counters.valid[e]) continue;
+                    out << (firstCounter ? "" : ", ") << "\"" << PerfCounters::eventName(e) << "\": " << r.counters.values[e];
+                    firstCounter = false;
+                }
+                out << "}";
+                if (r.counters.has(PerfCounters::CYCLES) && r.counters.has(PerfCounters::INSTRUCTIONS)) {
+                    out << ",\n      \"ipc\": " << r.counters.ipc();
+                }
+            }
+            out << "\n    }";
+        }
+        out << "\n  ]\n}\n";
+        return true;
+    }
+
+    // Parses --warmup N --reps N --filter S --json PATH --csv PATH --metrics PATH
+    // --trace PATH --data PATH --threads 1,2,4 --scaling --pin --perf
+    static BenchOptions parseArgs(int argc, char* argv[]) {
+        BenchOptions parsed;
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            bool hasValue = i + 1 < argc;
+            if (arg == "--warmup" && hasValue) {
+                parsed.warmup = std::atoi(argv[++i]);
+            } else if (arg == "--reps" && hasValue) {
+                parsed.repetitions = std::max(1, std::atoi(argv[++i]));
+            } else if (arg == "--filter" && hasValue) {
+                parsed.filter = argv[++i];
+            } else if (arg == "--json" && hasValue) {
+                parsed.jsonPath = argv[++i];
+            } else if (arg == "--csv" && hasValue) {
+                parsed.csvPath = argv[++i];
+            } else if (arg == "--metrics" && hasValue) {
+                parsed.metricsPath = argv[++i];
+            } else if (arg == "--trace" && hasValue) {
+                parsed.tracePath = argv[++i];
+            } else if (arg == "--scaling") {
+                parsed.scaling = true;
+            } else if (arg == "--perf") {
+                parsed.perfCounters = true;
+            } else if (arg == "--pin") {
+                parsed.pinThreads = true;
+            } else if (arg == "--data" && hasValue) {
+                parsed.dataPath = argv[++i];
+            } else if (arg == "--threads" && hasValue) {
+                std::string list = argv[++i];
+                size_t pos = 0;
+                while (pos < list.size()) {
+                    size_t comma = list.find(',', pos);
+                    if (comma == std::string::npos) comma = list.size();
+                    int t = std::atoi(list.substr(pos, comma - pos).c_str());
+                    if (t > 0) parsed.threadCounts.push_back(t);
+                    pos = comma + 1;
+                }
+            } else {
+                std::cerr << "Usage: " << argv[0]
+                          << " [--warmup N] [--reps N] [--filter TEXT] [--json FILE] [--csv FILE]"
+                          << " [--metrics FILE] [--trace FILE] [--data PATH] [--threads 1,2,4] [--scaling] [--pin] [--perf]" << std::endl;
+                std::exit(arg == "--help" ? 0 : 1);
+            }
+        }
+        return parsed;
+    }
+
+    // Prints the table the options ask for and writes the requested reports
+    bool report(std::ostream& out) const {
+        if (options.scaling) {
+            printScalingTable(out);
+        } else {
+            printTable(out);
+        }
+        if (perf.isOpen()) {
+            printCounterTable(out);
+        }
+        bool ok = true;
+        if (!options.jsonPath.empty()) {
+            ok = writeJSON(options.jsonPath) && ok;
+            if (ok) out << "\nWrote " << options.jsonPath << std::endl;
+        }
+        if (!options.csvPath.empty()) {
+            ok = writeCSV(options.csvPath) && ok;
+            if (ok) out << "Wrote " << options.csvPath << std::endl;
+        }
+        if (!options.metricsPath.empty()) {
+            if (MetricsRegistry::instance().writeFile(options.metricsPath)) {
+                out << "Wrote " << options.metricsPath << std::endl;
+            } else if (!MetricsRegistry::enabled) {
+                std::cerr << "Metrics are compiled out (ENABLE_METRICS=OFF)" << std::endl;
+            }
+        }
+        if (!options.tracePath.empty()) {
+            TraceRecorder::instance().stop();
+            if (TraceRecorder::instance().writeFile(options.tracePath)) {
+                out << "Wrote " << options.tracePath << std::endl;
+            }
+        }
+        return ok;
+    }
+
+    // 1, 2, 4, ... up to maxThreads, plus maxThreads itself
+    static std::vector<int> defaultThreadCounts(int maxThreads) {
+        std::vector<int> counts;
+        for (int t = 1; t < maxThreads; t *= 2) {
+            counts.push_back(t);
+        }
+        counts.push_back(std::max(1, maxThreads));
+        return counts;
+    }
+};
+
+#endif // BENCH_HARNESS_H
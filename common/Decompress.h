@@ -0,0 +1,292 @@
+#ifndef DECOMPRESS_H
+#define DECOMPRESS_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <vector>
+
+#ifndef HAVE_ZLIB
+#define HAVE_ZLIB 0
+#endif
+#ifndef HAVE_ZSTD
+#define HAVE_ZSTD 0
+#endif
+
+#if HAVE_ZLIB
+#include <zlib.h>
+#endif
+#if HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+// Streaming decompression of .gz / .zst inputs, so loaders can read
+// compressed downloads without unpacking them to disk first. Input is fed
+// in chunks (from a file or from a buffer read some other way) and output
+// comes back through a callback in chunks of at most kChunkBytes, which
+// the caller tokenizes as it arrives.
+//
+// Formats are compiled in when the build finds the library: HAVE_ZLIB for
+// gzip, HAVE_ZSTD for zstd. Concatenated gzip members and zstd frames are
+// read as one stream, as gunzip / zstdcat do.
+//
+//   Decompressor::forEachChunk("data.csv.gz", [&](const char* p, size_t n) { ... }, error);
+class Decompressor {
+public:
+    enum Format { NONE, GZIP, ZSTD };
+
+    typedef std::function<void(const char* data, size_t size)> Sink;
+
+    static constexpr size_t kChunkBytes = 256 << 10;
+
+    // From the file extension
+    static Format formatOf(const std::string& path) {
+        if (endsWith(path, ".gz")) return GZIP;
+        if (endsWith(path, ".zst")) return ZSTD;
+        return NONE;
+    }
+
+    static bool supported(Format format) {
+        switch (format) {
+        case NONE: return true;
+        case GZIP: return HAVE_ZLIB != 0;
+        case ZSTD: return HAVE_ZSTD != 0;
+        }
+        return false;
+    }
+
+    static const char* name(Format format) {
+        switch (format) {
+        case NONE: return "none";
+        case GZIP: return "gzip";
+        case ZSTD: return "zstd";
+        }
+        return "?";
+    }
+
+    // path itself if it exists, else path.gz or path.zst, else path
+    static std::string findInput(const std::string& path) {
+        for (const char* suffix : {"", ".gz", ".zst"}) {
+            std::string candidate = path + suffix;
+            if (formatOf(candidate) != NONE && !supported(formatOf(candidate))) continue;
+            if (std::ifstream(candidate).good()) return candidate;
+        }
+        return path;
+    }
+
+    explicit Decompressor(Format format) : format(format) {
+#if HAVE_ZLIB
+        if (format == GZIP) {
+            std::memset(&zs, 0, sizeof(zs));
+            // 16 + MAX_WBITS: gzip header and trailer, not raw zlib
+            if (inflateInit2(&zs, 16 + MAX_WBITS) != Z_OK) {
+                error = "inflateInit2 failed";
+                return;
+            }
+            zsOpen = true;
+        }
+#endif
+#if HAVE_ZSTD
+        if (format == ZSTD) {
+            dstream = ZSTD_createDStream();
+            if (dstream == nullptr) {
+                error = "ZSTD_createDStream failed";
+                return;
+            }
+        }
+#endif
+        if (!supported(format)) {
+            error = std::string("built without ") + name(format) + " support";
+            return;
+        }
+        if (format != NONE) out.resize(kChunkBytes);
+    }
+
+    ~Decompressor() {
+#if HAVE_ZLIB
+        if (zsOpen) inflateEnd(&zs);
+#endif
+#if HAVE_ZSTD
+        if (dstream) ZSTD_freeDStream(dstream);
+#endif
+    }
+
+    Decompressor(const Decompressor&) = delete;
+    Decompressor& operator=(const Decompressor&) = delete;
+
+    bool ok() const { return error.empty(); }
+    const std::string& getError() const { return error; }
+    uint64_t getBytesIn() const { return bytesIn; }
+    uint64_t getBytesOut() const { return bytesOut; }
+
+    // Decompress the next piece of input; false (see getError()) on corrupt data
+    bool feed(const char* data, size_t size, const Sink& sink) {
+        if (!ok()) return false;
+        bytesIn += size;
+        switch (format) {
+        case NONE:
+            bytesOut += size;
+            if (size > 0) sink(data, size);
+            return true;
+        case GZIP: return feedGzip(data, size, sink);
+        case ZSTD: return feedZstd(data, size, sink);
+        }
+        return false;
+    }
+
+    // After the last feed(): false if the input stopped inside a stream
+    bool finish() {
+        if (!ok()) return false;
+        if (midStream) {
+            error = std::string("truncated ") + name(format) + " input";
+            return false;
+        }
+        return true;
+    }
+
+    // Feed a whole buffer and finish
+    bool decompress(const char* data, size_t size, const Sink& sink) {
+        return feed(data, size, sink) && finish();
+    }
+
+    // Read path (compressed by its extension) in chunks and pass the
+    // decompressed bytes to sink; on failure error says why
+    static bool forEachChunk(const std::string& path, const Sink& sink, std::string& error) {
+        Decompressor decompressor(formatOf(path));
+        if (!decompressor.ok()) {
+            error = path + ": " + decompressor.getError();
+            return false;
+        }
+        std::FILE* file = std::fopen(path.c_str(), "rb");
+        if (file == nullptr) {
+            error = "Could not open file " + path;
+            return false;
+        }
+        std::vector<char> in(kChunkBytes);
+        bool good = true;
+        size_t n;
+        while (good && (n = std::fread(in.data(), 1, in.size(), file)) > 0) {
+            good = decompressor.feed(in.data(), n, sink);
+        }
+        if (good && std::ferror(file)) {
+            error = "Read error on " + path;
+            std::fclose(file);
+            return false;
+        }
+        std::fclose(file);
+        if (!good || !decompressor.finish()) {
+            error = path + ": " + decompressor.getError();
+            return false;
+        }
+        return true;
+    }
+
+    // Whole decompressed contents of path appended to contents
+    static bool readAll(const std::string& path, std::string& contents, std::string& error) {
+        return forEachChunk(path, [&contents](const char* p, size_t n) { contents.append(p, n); }, error);
+    }
+
+private:
+    Format format;
+    std::string error;
+    std::vector<char> out;
+    uint64_t bytesIn = 0;
+    uint64_t bytesOut = 0;
+    bool midStream = false;     // input ended inside a member / frame?
+
+#if HAVE_ZLIB
+    z_stream zs;
+    bool zsOpen = false;
+#endif
+#if HAVE_ZSTD
+    ZSTD_DStream* dstream = nullptr;
+#endif
+
+    static bool endsWith(const std::string& s, const char* suffix) {
+        size_t n = std::strlen(suffix);
+        return s.size() >= n && s.compare(s.size() - n, n, suffix) == 0;
+    }
+
+    void emit(size_t produced, const Sink& sink) {
+        if (produced == 0) return;
+        bytesOut += produced;
+        sink(out.data(), produced);
+    }
+
+    bool feedGzip(const char* data, size_t size, const Sink& sink) {
+#if HAVE_ZLIB
+        zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+        zs.avail_in = static_cast<uInt>(size);
+        while (zs.avail_in > 0) {
+            midStream = true;
+            zs.next_out = reinterpret_cast<Bytef*>(out.data());
+            zs.avail_out = static_cast<uInt>(out.size());
+            int rc = inflate(&zs, Z_NO_FLUSH);
+            emit(out.size() - zs.avail_out, sink);
+            if (rc == Z_STREAM_END) {
+                // Another member may follow
+                midStream = false;
+                inflateReset(&zs);
+            } else if (rc != Z_OK && rc != Z_BUF_ERROR) {
+                error = std::string("gzip: ") + (zs.msg ? zs.msg : "corrupt input");
+                return false;
+            }
+        }
+        // Output still buffered inside zlib once the input is consumed
+        while (midStream) {
+            zs.next_out = reinterpret_cast<Bytef*>(out.data());
+            zs.avail_out = static_cast<uInt>(out.size());
+            int rc = inflate(&zs, Z_NO_FLUSH);
+            size_t produced = out.size() - zs.avail_out;
+            emit(produced, sink);
+            if (rc == Z_STREAM_END) {
+                midStream = false;
+                inflateReset(&zs);
+            } else if (rc != Z_OK && rc != Z_BUF_ERROR) {
+                error = std::string("gzip: ") + (zs.msg ? zs.msg : "corrupt input");
+                return false;
+            }
+            if (produced == 0) break;
+        }
+        return true;
+#else
+        (void)data;
+        (void)size;
+        (void)sink;
+        return false;
+#endif
+    }
+
+    bool feedZstd(const char* data, size_t size, const Sink& sink) {
+#if HAVE_ZSTD
+        ZSTD_inBuffer input = {data, size, 0};
+        // Loop until the input is consumed and the last call left room in
+        // the output, so nothing stays buffered in the decoder
+        bool outputFull = true;
+        while (input.pos < input.size || outputFull) {
+            ZSTD_outBuffer output = {out.data(), out.size(), 0};
+            size_t rc = ZSTD_decompressStream(dstream, &output, &input);
+            if (ZSTD_isError(rc)) {
+                error = std::string("zstd: ") + ZSTD_getErrorName(rc);
+                return false;
+            }
+            emit(output.pos, sink);
+            // 0: a frame just ended
+            midStream = rc != 0;
+            outputFull = output.pos == output.size;
+            if (input.pos == input.size && output.pos == 0) break;
+        }
+        return true;
+#else
+        (void)data;
+        (void)size;
+        (void)sink;
+        return false;
+#endif
+    }
+};
+
+#endif // DECOMPRESS_H
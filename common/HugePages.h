@@ -0,0 +1,158 @@
+#ifndef HUGE_PAGES_H
+#define HUGE_PAGES_H
+
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+// 2 MB pages for large column buffers. A scan over hundreds of MB of
+// columns touches a new 4 KB page every few hundred rows, and each one
+// costs a TLB entry; a 2 MB page covers 512 of them.
+//
+//   OFF          plain mmap, the kernel's default policy decides
+//   TRANSPARENT  2 MB aligned mapping + madvise(MADV_HUGEPAGE), so
+//                transparent huge pages are used when THP is "madvise"
+//   EXPLICIT     MAP_HUGETLB from the reserved pool (vm.nr_hugepages),
+//                falling back to TRANSPARENT when the pool is short
+//
+// The mode is process-wide and applies to buffers mapped after it is set.
+// Whether pages really became huge is up to the kernel (THP may be off,
+// memory fragmented); hugeBytes() reads the outcome from /proc/self/smaps.
+class HugePages {
+public:
+    enum Mode { OFF, TRANSPARENT, EXPLICIT };
+
+    static constexpr size_t kPageBytes = size_t(2) << 20;
+
+    struct Stats {
+        size_t explicitMaps = 0;        // MAP_HUGETLB succeeded
+        size_t explicitFallbacks = 0;   // MAP_HUGETLB failed, fell back
+        size_t advisedMaps = 0;         // madvise(MADV_HUGEPAGE) accepted
+    };
+
+    static Mode mode() { return static_cast<Mode>(modeFlag().load(std::memory_order_relaxed)); }
+    static void setMode(Mode m) { modeFlag().store(m, std::memory_order_relaxed); }
+
+    static const char* modeName(Mode m) {
+        switch (m) {
+            case TRANSPARENT: return "thp";
+            case EXPLICIT: return "explicit";
+            default: return "off";
+        }
+    }
+
+    // "off", "thp" or "explicit"; false for anything else
+    static bool parseMode(const std::string& text, Mode& m) {
+        for (Mode candidate : {OFF, TRANSPARENT, EXPLICIT}) {
+            if (text == modeName(candidate)) {
+                m = candidate;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static size_t roundUp(size_t bytes) { return (bytes + kPageBytes - 1) & ~(kPageBytes - 1); }
+
+    // Anonymous mapping of bytes (a multiple of kPageBytes) in the current
+    // mode; nullptr if even the plain mapping fails. Release with unmap().
+    static void* map(size_t bytes) {
+        Mode m = mode();
+        if (m == EXPLICIT) {
+            void* p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (p != MAP_FAILED) {
+                counters().explicitMaps++;
+                return p;
+            }
+            counters().explicitFallbacks++;
+        }
+        if (m == OFF) {
+            void* p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            return p == MAP_FAILED ? nullptr : p;
+        }
+
+        // Over-map by one huge page and trim both ends, so the range is
+        // 2 MB aligned and every 2 MB of it can be one huge page
+        size_t span = bytes + kPageBytes;
+        void* raw = mmap(nullptr, span, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw == MAP_FAILED) return nullptr;
+        uintptr_t begin = reinterpret_cast<uintptr_t>(raw);
+        uintptr_t aligned = (begin + kPageBytes - 1) & ~(kPageBytes - 1);
+        if (aligned > begin) munmap(raw, aligned - begin);
+        size_t tail = begin + span - (aligned + bytes);
+        if (tail > 0) munmap(reinterpret_cast<void*>(aligned + bytes), tail);
+#ifdef MADV_HUGEPAGE
+        if (madvise(reinterpret_cast<void*>(aligned), bytes, MADV_HUGEPAGE) == 0) counters().advisedMaps++;
+#endif
+        return reinterpret_cast<void*>(aligned);
+    }
+
+    static void unmap(void* p, size_t bytes) { munmap(p, bytes); }
+
+    static Stats stats() {
+        Stats s;
+        s.explicitMaps = counters().explicitMaps.load();
+        s.explicitFallbacks = counters().explicitFallbacks.load();
+        s.advisedMaps = counters().advisedMaps.load();
+        return s;
+    }
+
+    // Bytes of [data, data + bytes) backed by huge pages (transparent or
+    // hugetlb) right now, from /proc/self/smaps; 0 where that is missing.
+    // A mapping the kernel merged with a neighbour is counted up to its
+    // overlap with the range.
+    static size_t hugeBytes(const void* data, size_t bytes) {
+        uintptr_t first = reinterpret_cast<uintptr_t>(data);
+        uintptr_t last = first + bytes;
+        std::ifstream smaps("/proc/self/smaps");
+        std::string line;
+        size_t total = 0;
+        size_t overlap = 0;
+        size_t huge = 0;
+        while (std::getline(smaps, line)) {
+            unsigned long start, end;
+            char dash;
+            std::istringstream header(line);
+            if (line.find(':') > line.find(' ') && (header >> std::hex >> start >> dash >> end) && dash == '-') {
+                total += std::min(overlap, huge);
+                huge = 0;
+                overlap = 0;
+                if (start < last && end > first) {
+                    overlap = std::min<uintptr_t>(end, last) - std::max<uintptr_t>(start, first);
+                }
+                continue;
+            }
+            if (overlap == 0) continue;
+            if (line.compare(0, 14, "AnonHugePages:") == 0 || line.compare(0, 16, "Private_Hugetlb:") == 0 ||
+                line.compare(0, 15, "Shared_Hugetlb:") == 0) {
+                huge += std::stoull(line.substr(line.find(':') + 1)) << 10;
+            }
+        }
+        return total + std::min(overlap, huge);
+    }
+
+private:
+    struct Counters {
+        std::atomic<size_t> explicitMaps{0};
+        std::atomic<size_t> explicitFallbacks{0};
+        std::atomic<size_t> advisedMaps{0};
+    };
+
+    static Counters& counters() {
+        static Counters c;
+        return c;
+    }
+
+    static std::atomic<int>& modeFlag() {
+        static std::atomic<int> flag{OFF};
+        return flag;
+    }
+};
+
+#endif // HUGE_PAGES_H
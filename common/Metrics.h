@@ -0,0 +1,410 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <cstdint>
+#include <string>
+
+// Counters and histograms for the load and query hot paths.
+//
+// Every thread writes to its own shard (plain relaxed stores, no locked
+// read-modify-write), and readers sum the shards when a snapshot is taken.
+// Shards of finished threads are folded into a retired total, so counts
+// from short-lived pthread / OpenMP workers are kept.
+//
+// Use the macros at instrumentation points:
+//   METRICS_COUNTER_ADD("fire_rows_parsed_total", rows);
+//   METRICS_HISTOGRAM_OBSERVE("fire_rows_per_file", rows);
+//   METRICS_SCOPED_TIMER("fire_query_seconds{query=\"by_date\"}");
+// Names may carry Prometheus labels. Timers record nanoseconds and are
+// exported in seconds. Build with ENABLE_METRICS=0 (CMake option
+// ENABLE_METRICS=OFF) and the macros expand to nothing; the export
+// functions then return an empty report.
+
+#ifndef ENABLE_METRICS
+#define ENABLE_METRICS 1
+#endif
+
+#if ENABLE_METRICS
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+class MetricsRegistry {
+public:
+    static const bool enabled = true;
+    static const int kMaxCounters = 64;
+    static const int kMaxHistograms = 48;
+    // Bucket b holds values in [2^(b-1), 2^b); the last one is open-ended
+    static const int kBuckets = 42;
+
+    struct Shard {
+        std::atomic<uint64_t> counters[kMaxCounters];
+        std::atomic<uint64_t> buckets[kMaxHistograms][kBuckets];
+        std::atomic<uint64_t> sums[kMaxHistograms];
+
+        Shard() {
+            for (auto& c : counters) c.store(0, std::memory_order_relaxed);
+            for (auto& h : buckets)
+                for (auto& b : h) b.store(0, std::memory_order_relaxed);
+            for (auto& s : sums) s.store(0, std::memory_order_relaxed);
+        }
+    };
+
+    struct HistogramSnapshot {
+        std::string name;
+        double scale;   // multiplier from recorded units to exported units
+        uint64_t count;
+        uint64_t sum;
+        uint64_t buckets[kBuckets];
+    };
+
+    static MetricsRegistry& instance() {
+        // Never destroyed: thread-local shards may outlive static destructors
+        static MetricsRegistry* registry = new MetricsRegistry();
+        return *registry;
+    }
+
+    static uint64_t now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // Register a metric and return its slot; the macros cache the slot in a
+    // function-local static. -1 once the fixed slot table is full.
+    int counterId(const std::string& name) {
+        return slotFor(counterNames, kMaxCounters, name);
+    }
+
+    int histogramId(const std::string& name, double scale = 1.0) {
+        std::lock_guard<std::mutex> lock(mutex);
+        int id = findOrAdd(histogramNames, kMaxHistograms, name);
+        if (id >= 0 && static_cast<size_t>(id) == histogramScales.size()) {
+            histogramScales.push_back(scale);
+        }
+        return id;
+    }
+
+    static void add(int id, uint64_t delta) {
+        if (id < 0) return;
+        std::atomic<uint64_t>& c = localShard().counters[id];
+        c.store(c.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+    }
+
+    static void observe(int id, uint64_t value) {
+        if (id < 0) return;
+        Shard& shard = localShard();
+        int bucket = value == 0 ? 0 : 64 - __builtin_clzll(value);
+        bucket = std::min(bucket, kBuckets - 1);
+        std::atomic<uint64_t>& b = shard.buckets[id][bucket];
+        b.store(b.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        std::atomic<uint64_t>& s = shard.sums[id];
+        s.store(s.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    // Sum of every live and retired shard
+    std::vector<std::pair<std::string, uint64_t>> counterSnapshot() {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::vector<std::pair<std::string, uint64_t>> out;
+        for (size_t id = 0; id < counterNames.size(); ++id) {
+            uint64_t total = retired.counters[id].load(std::memory_order_relaxed);
+            for (Shard* shard : live) total += shard->counters[id].load(std::memory_order_relaxed);
+            out.push_back({counterNames[id], total});
+        }
+        return out;
+    }
+
+    std::vector<HistogramSnapshot> histogramSnapshot() {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::vector<HistogramSnapshot> out;
+        for (size_t id = 0; id < histogramNames.size(); ++id) {
+            HistogramSnapshot h;
+            h.name = histogramNames[id];
+            h.scale = histogramScales[id];
+            h.count = 0;
+            h.sum = retired.sums[id].load(std::memory_order_relaxed);
+            for (Shard* shard : live) h.sum += shard->sums[id].load(std::memory_order_relaxed);
+            for (int b = 0; b < kBuckets; ++b) {
+                h.buckets[b] = retired.buckets[id][b].load(std::memory_order_relaxed);
+                for (Shard* shard : live) h.buckets[b] += shard->buckets[id][b].load(std::memory_order_relaxed);
+                h.count += h.buckets[b];
+            }
+            out.push_back(h);
+        }
+        return out;
+    }
+
+    // Zero every shard, e.g. between benchmark phases
+    void reset() {
+        std::lock_guard<std::mutex> lock(mutex);
+        clearShard(retired);
+        for (Shard* shard : live) clearShard(*shard);
+    }
+
+    // Prometheus text exposition format (cumulative le buckets)
+    std::string toPrometheus() {
+        // Sorted so every metric family is one contiguous block
+        std::vector<std::pair<std::string, uint64_t>> counters = counterSnapshot();
+        std::vector<HistogramSnapshot> histograms = histogramSnapshot();
+        std::sort(counters.begin(), counters.end());
+        std::sort(histograms.begin(), histograms.end(),
+                  [](const HistogramSnapshot& a, const HistogramSnapshot& b) { return a.name < b.name; });
+
+        std::ostringstream out;
+        std::string lastFamily;
+        for (const auto& counter : counters) {
+            std::string family = familyOf(counter.first);
+            if (family != lastFamily) {
+                out << "# TYPE " << family << " counter\n";
+                lastFamily = family;
+            }
+            out << counter.first << " " << counter.second << "\n";
+        }
+        lastFamily.clear();
+        for (const HistogramSnapshot& h : histograms) {
+            std::string family = familyOf(h.name);
+            std::string labels = labelsOf(h.name);
+            if (family != lastFamily) {
+                out << "# TYPE " << family << " histogram\n";
+                lastFamily = family;
+            }
+            uint64_t cumulative = 0;
+            int top = highestBucket(h);
+            for (int b = 0; b <= top && b < kBuckets - 1; ++b) {
+                cumulative += h.buckets[b];
+                out << family << "_bucket{" << labels << (labels.empty() ? "" : ",")
+                    << "le=\"" << upperBound(b) * h.scale << "\"} " << cumulative << "\n";
+            }
+            out << family << "_bucket{" << labels << (labels.empty() ? "" : ",")
+                << "le=\"+Inf\"} " << h.count << "\n";
+            out << family << "_sum" << braced(labels) << " " << h.sum * h.scale << "\n";
+            out << family << "_count" << braced(labels) << " " << h.count << "\n";
+        }
+        return out.str();
+    }
+
+    std::string toJSON() {
+        std::ostringstream out;
+        out << "{\n  \"counters\": {";
+        bool first = true;
+        for (const auto& counter : counterSnapshot()) {
+            out << (first ? "" : ",") << "\n    \"" << jsonEscape(counter.first) << "\": " << counter.second;
+            first = false;
+        }
+        out << "\n  },\n  \"histograms\": {";
+        first = true;
+        for (const HistogramSnapshot& h : histogramSnapshot()) {
+            out << (first ? "" : ",") << "\n    \"" << jsonEscape(h.name) << "\": {"
+                << "\"count\": " << h.count << ", \"sum\": " << h.sum * h.scale << ", \"buckets\": [";
+            // Non-cumulative, empty buckets left out
+            bool firstBucket = true;
+            for (int b = 0; b < kBuckets; ++b) {
+                if (h.buckets[b] == 0) continue;
+                out << (firstBucket ? "" : ", ") << "{\"le\": ";
+                firstBucket = false;
+                if (b == kBuckets - 1) out << "\"+Inf\"";
+                else out << upperBound(b) * h.scale;
+                out << ", \"count\": " << h.buckets[b] << "}";
+            }
+            out << "]}";
+            first = false;
+        }
+        out << "\n  }\n}\n";
+        return out.str();
+    }
+
+    // Writes JSON for *.json paths, Prometheus text otherwise
+    bool writeFile(const std::string& path) {
+        std::ofstream out(path);
+        if (!out.is_open()) {
+            std::cerr << "Error: could not write " << path << std::endl;
+            return false;
+        }
+        bool json = path.size() >= 5 && path.compare(path.size() - 5, 5, ".json") == 0;
+        out << (json ? toJSON() : toPrometheus());
+        return true;
+    }
+
+    // Records the time between construction and destruction
+    class ScopedTimer {
+    private:
+        int id;
+        uint64_t start;
+
+    public:
+        explicit ScopedTimer(int histogramId) : id(histogramId), start(now()) {}
+        ~ScopedTimer() { observe(id, now() - start); }
+    };
+
+private:
+    std::mutex mutex;
+    std::vector<std::string> counterNames;
+    std::vector<std::string> histogramNames;
+    std::vector<double> histogramScales;
+    std::vector<Shard*> live;
+    Shard retired;
+
+    // Owns the calling thread's shard; folds it into retired at thread exit
+    struct ShardHandle {
+        Shard* shard;
+
+        ShardHandle() : shard(new Shard()) {
+            MetricsRegistry& registry = instance();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            registry.live.push_back(shard);
+        }
+
+        ~ShardHandle() {
+            MetricsRegistry& registry = instance();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            accumulate(registry.retired, *shard);
+            registry.live.erase(std::find(registry.live.begin(), registry.live.end(), shard));
+            delete shard;
+        }
+    };
+
+    static Shard& localShard() {
+        static thread_local ShardHandle handle;
+        return *handle.shard;
+    }
+
+    int slotFor(std::vector<std::string>& names, int limit, const std::string& name) {
+        std::lock_guard<std::mutex> lock(mutex);
+        return findOrAdd(names, limit, name);
+    }
+
+    static int findOrAdd(std::vector<std::string>& names, int limit, const std::string& name) {
+        auto it = std::find(names.begin(), names.end(), name);
+        if (it != names.end()) return static_cast<int>(it - names.begin());
+        if (static_cast<int>(names.size()) >= limit) return -1;
+        names.push_back(name);
+        return static_cast<int>(names.size()) - 1;
+    }
+
+    static void accumulate(Shard& target, const Shard& source) {
+        for (int i = 0; i < kMaxCounters; ++i) {
+            target.counters[i].fetch_add(source.counters[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+        for (int h = 0; h < kMaxHistograms; ++h) {
+            target.sums[h].fetch_add(source.sums[h].load(std::memory_order_relaxed), std::memory_order_relaxed);
+            for (int b = 0; b < kBuckets; ++b) {
+                target.buckets[h][b].fetch_add(source.buckets[h][b].load(std::memory_order_relaxed), std::memory_order_relaxed);
+            }
+        }
+    }
+
+    static void clearShard(Shard& shard) {
+        for (auto& c : shard.counters) c.store(0, std::memory_order_relaxed);
+        for (auto& h : shard.buckets)
+            for (auto& b : h) b.store(0, std::memory_order_relaxed);
+        for (auto& s : shard.sums) s.store(0, std::memory_order_relaxed);
+    }
+
+    static double upperBound(int bucket) {
+        return bucket == 0 ? 0.0 : static_cast<double>((1ULL << bucket) - 1);
+    }
+
+    static int highestBucket(const HistogramSnapshot& h) {
+        int top = 0;
+        for (int b = 0; b < kBuckets; ++b) {
+            if (h.buckets[b] != 0) top = b;
+        }
+        return top;
+    }
+
+    static std::string familyOf(const std::string& name) {
+        return name.substr(0, name.find('{'));
+    }
+
+    static std::string labelsOf(const std::string& name) {
+        size_t open = name.find('{');
+        if (open == std::string::npos) return "";
+        return name.substr(open + 1, name.size() - open - 2);
+    }
+
+    static std::string braced(const std::string& labels) {
+        return labels.empty() ? "" : "{" + labels + "}";
+    }
+
+    // Quotes, backslashes and control characters (a newline in a label
+    // value) would break the JSON
+    static std::string jsonEscape(const std::string& text) {
+        std::string out;
+        for (char c : text) {
+            if (c == '"' || c == '\\') {
+                out += '\\';
+                out += c;
+            } else if (static_cast<unsigned char>(c) < 0x20) {
+                char code[8];
+                std::snprintf(code, sizeof(code), "\\u%04x", static_cast<unsigned>(c));
+                out += code;
+            } else {
+                out += c;
+            }
+        }
+        return out;
+    }
+};
+
+#define METRICS_CONCAT_INNER(a, b) a##b
+#define METRICS_CONCAT(a, b) METRICS_CONCAT_INNER(a, b)
+
+#define METRICS_COUNTER_ADD(name, delta)                                                    \
+    do {                                                                                    \
+        static const int metricsSlot = MetricsRegistry::instance().counterId(name);        \
+        MetricsRegistry::add(metricsSlot, static_cast<uint64_t>(delta));                    \
+    } while (0)
+
+#define METRICS_HISTOGRAM_OBSERVE(name, value)                                              \
+    do {                                                                                    \
+        static const int metricsSlot = MetricsRegistry::instance().histogramId(name);      \
+        MetricsRegistry::observe(metricsSlot, static_cast<uint64_t>(value));                \
+    } while (0)
+
+// Elapsed nanoseconds (e.g. from MetricsRegistry::now() deltas), exported in seconds
+#define METRICS_TIME_OBSERVE(name, nanoseconds)                                             \
+    do {                                                                                    \
+        static const int metricsSlot = MetricsRegistry::instance().histogramId(name, 1e-9); \
+        MetricsRegistry::observe(metricsSlot, static_cast<uint64_t>(nanoseconds));          \
+    } while (0)
+
+#define METRICS_SCOPED_TIMER(name)                                                          \
+    static const int METRICS_CONCAT(metricsTimerSlot, __LINE__) =                           \
+        MetricsRegistry::instance().histogramId(name, 1e-9);                               \
+    MetricsRegistry::ScopedTimer METRICS_CONCAT(metricsTimer, __LINE__)(                    \
+        METRICS_CONCAT(metricsTimerSlot, __LINE__))
+
+#else // !ENABLE_METRICS
+
+// Compiled out: same API, no state, no clock reads
+class MetricsRegistry {
+public:
+    static const bool enabled = false;
+
+    static MetricsRegistry& instance() {
+        static MetricsRegistry registry;
+        return registry;
+    }
+
+    static uint64_t now() { return 0; }
+    void reset() {}
+    std::string toPrometheus() { return ""; }
+    std::string toJSON() { return "{\n  \"counters\": {},\n  \"histograms\": {}\n}\n"; }
+    bool writeFile(const std::string&) { return false; }
+};
+
+// sizeof keeps the arguments "used" without evaluating them
+#define METRICS_COUNTER_ADD(name, delta) ((void)sizeof(delta))
+#define METRICS_HISTOGRAM_OBSERVE(name, value) ((void)sizeof(value))
+#define METRICS_TIME_OBSERVE(name, nanoseconds) ((void)sizeof(nanoseconds))
+#define METRICS_SCOPED_TIMER(name) ((void)0)
+
+#endif // ENABLE_METRICS
+
+#endif // METRICS_H
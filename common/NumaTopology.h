@@ -0,0 +1,269 @@
+#ifndef NUMA_TOPOLOGY_H
+#define NUMA_TOPOLOGY_H
+
+#include <sched.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifndef HAVE_NUMA
+#define HAVE_NUMA 0
+#endif
+
+#if HAVE_NUMA
+#include <numa.h>
+#endif
+
+#include "HugePages.h"
+
+// NUMA nodes of the CPUs this process may run on, read from
+// /sys/devices/system/node (one node when that is missing). Used to pin
+// workers socket by socket and to place data next to the threads that
+// scan it:
+//
+//   - cpuOrder() lists the allowed CPUs node by node, so worker i pinned
+//     to cpuOrder()[i] (ThreadAffinity::pin) fills one node before the
+//     next, and a static split of rows over workers is a split over nodes.
+//   - FirstTouchAllocator leaves new arrays untouched, so the pages of
+//     each block land on the node of the thread that writes it first.
+//   - bindToNode() pins pages to a node explicitly through libnuma
+//     (HAVE_NUMA); without it, placement relies on first touch alone.
+class NumaTopology {
+public:
+    static const NumaTopology& instance() {
+        static const NumaTopology topology;
+        return topology;
+    }
+
+    // OS ids of the nodes that have allowed CPUs, ascending
+    const std::vector<int>& nodes() const { return nodeIds; }
+    int nodeCount() const { return static_cast<int>(nodeIds.size()); }
+
+    // Allowed CPUs, node by node
+    const std::vector<int>& cpuOrder() const { return order; }
+
+    const std::vector<int>& cpusOf(int node) const {
+        static const std::vector<int> none;
+        for (size_t i = 0; i < nodeIds.size(); ++i) {
+            if (nodeIds[i] == node) return nodeCpus[i];
+        }
+        return none;
+    }
+
+    // OS node id of a CPU, -1 if unknown
+    int nodeOfCpu(int cpu) const {
+        return cpu >= 0 && cpu < static_cast<int>(cpuNode.size()) ? cpuNode[cpu] : -1;
+    }
+
+    // Node of worker i when workers are pinned in cpuOrder()
+    int nodeOfWorker(int worker) const {
+        if (order.empty() || worker < 0) return nodeIds.empty() ? 0 : nodeIds[0];
+        return nodeOfCpu(order[worker % order.size()]);
+    }
+
+    // Node the calling thread is running on now
+    int currentNode() const {
+#if defined(__linux__)
+        int node = nodeOfCpu(sched_getcpu());
+        if (node >= 0) return node;
+#endif
+        return nodeIds.empty() ? 0 : nodeIds[0];
+    }
+
+    // e.g. "2 nodes (0: 16 CPUs, 1: 16 CPUs; libnuma)"
+    std::string describe() const {
+        std::ostringstream out;
+        out << nodeIds.size() << (nodeIds.size() == 1 ? " node (" : " nodes (");
+        for (size_t i = 0; i < nodeIds.size(); ++i) {
+            out << (i ? ", " : "") << nodeIds[i] << ": " << nodeCpus[i].size() << " CPUs";
+        }
+        out << (libnumaAvailable() ? "; libnuma)" : "; first touch)");
+        return out.str();
+    }
+
+    // Can bindToNode() place pages?
+    static bool libnumaAvailable() {
+#if HAVE_NUMA
+        static const bool available = numa_available() >= 0;
+        return available;
+#else
+        return false;
+#endif
+    }
+
+    // Place the whole pages of [data, data + bytes) on node before they are
+    // first touched; false without libnuma, leaving placement to first touch
+    static bool bindToNode(void* data, size_t bytes, int node) {
+#if HAVE_NUMA
+        if (!libnumaAvailable() || node < 0) return false;
+        uintptr_t page = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+        uintptr_t begin = (reinterpret_cast<uintptr_t>(data) + page - 1) & ~(page - 1);
+        uintptr_t end = (reinterpret_cast<uintptr_t>(data) + bytes) & ~(page - 1);
+        if (end <= begin) return false;
+        numa_tonode_memory(reinterpret_cast<void*>(begin), end - begin, node);
+        return true;
+#else
+        (void)data;
+        (void)bytes;
+        (void)node;
+        return false;
+#endif
+    }
+
+    // bindToNode() for the node of the calling thread; called by each
+    // worker on its own block just before it fills the block
+    static bool bindToCurrentNode(void* data, size_t bytes) {
+        if (instance().nodeCount() < 2) return false;
+        return bindToNode(data, bytes, instance().currentNode());
+    }
+
+private:
+    std::vector<int> nodeIds;
+    std::vector<std::vector<int>> nodeCpus;
+    std::vector<int> order;
+    std::vector<int> cpuNode;       // by CPU number
+
+    NumaTopology() {
+        std::vector<int> allowed;
+#if defined(__linux__)
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+            for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+                if (CPU_ISSET(cpu, &set)) allowed.push_back(cpu);
+            }
+        }
+#endif
+        if (allowed.empty()) allowed.push_back(0);
+        cpuNode.assign(allowed.back() + 1, -1);
+
+        for (int node : parseList(readLine("/sys/devices/system/node/online"))) {
+            std::vector<int> cpus;
+            for (int cpu : parseList(readLine("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist"))) {
+                if (std::binary_search(allowed.begin(), allowed.end(), cpu)) cpus.push_back(cpu);
+            }
+            if (cpus.empty()) continue;
+            for (int cpu : cpus) cpuNode[cpu] = node;
+            nodeIds.push_back(node);
+            nodeCpus.push_back(cpus);
+        }
+
+        // No sysfs node information (or CPUs it does not list): one node
+        std::vector<int> unplaced;
+        for (int cpu : allowed) {
+            if (cpuNode[cpu] < 0) unplaced.push_back(cpu);
+        }
+        if (!unplaced.empty()) {
+            int node = nodeIds.empty() ? 0 : nodeIds[0];
+            if (nodeIds.empty()) {
+                nodeIds.push_back(node);
+                nodeCpus.emplace_back();
+            }
+            for (int cpu : unplaced) {
+                cpuNode[cpu] = node;
+                nodeCpus[0].push_back(cpu);
+            }
+            std::sort(nodeCpus[0].begin(), nodeCpus[0].end());
+        }
+        for (const std::vector<int>& cpus : nodeCpus) {
+            order.insert(order.end(), cpus.begin(), cpus.end());
+        }
+    }
+
+    static std::string readLine(const std::string& path) {
+        std::ifstream file(path);
+        std::string line;
+        std::getline(file, line);
+        return line;
+    }
+
+    // "0-3,8,10-11" -> 0 1 2 3 8 10 11
+    static std::vector<int> parseList(const std::string& text) {
+        std::vector<int> values;
+        std::istringstream in(text);
+        std::string range;
+        while (std::getline(in, range, ',')) {
+            if (range.empty()) continue;
+            size_t dash = range.find('-');
+            try {
+                int first = std::stoi(range.substr(0, dash));
+                int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+                for (int v = first; v <= last; ++v) values.push_back(v);
+            } catch (const std::exception&) {
+                return std::vector<int>();
+            }
+        }
+        return values;
+    }
+};
+
+// Allocator for arrays that are filled in parallel. resize() leaves
+// trivially constructible elements uninitialised instead of zeroing them
+// on the calling thread, and arrays of 1 MB or more come straight from
+// mmap, never from pages the heap has already touched. Each page is then
+// placed on the node of the first thread to write it. Arrays of 2 MB or
+// more are mapped in whole 2 MB units through HugePages, in its current
+// mode.
+template <typename T>
+struct FirstTouchAllocator {
+    typedef T value_type;
+
+    static constexpr size_t kMapBytes = size_t(1) << 20;
+
+    FirstTouchAllocator() = default;
+    template <typename U>
+    FirstTouchAllocator(const FirstTouchAllocator<U>&) {}
+
+    T* allocate(size_t n) {
+        size_t bytes = n * sizeof(T);
+        if (bytes < kMapBytes) return static_cast<T*>(::operator new(bytes));
+        void* p = nullptr;
+        if (bytes >= HugePages::kPageBytes) {
+            p = HugePages::map(HugePages::roundUp(bytes));
+        } else {
+            p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (p == MAP_FAILED) p = nullptr;
+        }
+        if (p == nullptr) throw std::bad_alloc();
+        return static_cast<T*>(p);
+    }
+
+    void deallocate(T* p, size_t n) {
+        size_t bytes = n * sizeof(T);
+        if (bytes < kMapBytes) {
+            ::operator delete(p);
+        } else if (bytes >= HugePages::kPageBytes) {
+            HugePages::unmap(p, HugePages::roundUp(bytes));
+        } else {
+            munmap(p, bytes);
+        }
+    }
+
+    template <typename U>
+    void construct(U* p) {
+        ::new (static_cast<void*>(p)) U;
+    }
+
+    template <typename U, typename... Args>
+    void construct(U* p, Args&&... args) {
+        ::new (static_cast<void*>(p)) U(std::forward<Args>(args)...);
+    }
+
+    template <typename U>
+    bool operator==(const FirstTouchAllocator<U>&) const { return true; }
+    template <typename U>
+    bool operator!=(const FirstTouchAllocator<U>&) const { return false; }
+};
+
+#endif // NUMA_TOPOLOGY_H
@@ -0,0 +1,214 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Hardware counters via perf_event_open(2), read around benchmarked phases.
+//
+// open() counts the calling thread and, through inheritance, every thread
+// it creates afterwards (a pthread's counts are added when it exits).
+// Threads that already exist, such as an OpenMP pool, call
+// attachCurrentThread() once so their counts are included too.
+//
+// Each event is opened on its own, so a missing PMU (virtual machines,
+// containers) or a paranoid kernel only drops the events it affects; the
+// software task-clock and page-fault counts are available almost
+// everywhere. Counts are scaled when the kernel multiplexes events.
+class PerfCounters {
+public:
+    enum Event {
+        CYCLES = 0,
+        INSTRUCTIONS,
+        LLC_MISSES,
+        BRANCH_MISSES,
+        DTLB_MISSES,
+        TASK_CLOCK_NS,
+        PAGE_FAULTS,
+        EVENT_COUNT
+    };
+
+    struct Sample {
+        double values[EVENT_COUNT];
+        bool valid[EVENT_COUNT];
+
+        Sample() {
+            for (int e = 0; e < EVENT_COUNT; ++e) {
+                values[e] = 0.0;
+                valid[e] = false;
+            }
+        }
+
+        // after - before, per repetition
+        static Sample delta(const Sample& before, const Sample& after, double repetitions = 1.0) {
+            Sample d;
+            for (int e = 0; e < EVENT_COUNT; ++e) {
+                d.valid[e] = before.valid[e] && after.valid[e];
+                d.values[e] = d.valid[e] ? (after.values[e] - before.values[e]) / repetitions : 0.0;
+            }
+            return d;
+        }
+
+        bool has(Event e) const { return valid[e]; }
+        double get(Event e) const { return values[e]; }
+
+        // Instructions per cycle, 0 without both counters
+        double ipc() const {
+            return valid[CYCLES] && valid[INSTRUCTIONS] && values[CYCLES] > 0
+                ? values[INSTRUCTIONS] / values[CYCLES] : 0.0;
+        }
+    };
+
+    static const char* eventName(int e) {
+        static const char* names[EVENT_COUNT] = {
+            "cycles", "instructions", "llc_misses", "branch_misses", "dtlb_misses",
+            "task_clock_ns", "page_faults"
+        };
+        return names[e];
+    }
+
+    PerfCounters() {}
+    ~PerfCounters() { close(); }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    // Open the counters on the calling thread. False if no event could be
+    // opened; unavailableReason() then says why.
+    bool open() {
+        close();
+        return attach(true);
+    }
+
+    // Add counters for the calling thread; no-op if it is already counted.
+    // Safe to call from every thread of a parallel region.
+    bool attachCurrentThread() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (threads.empty()) {
+            return false;
+        }
+#if defined(__linux__)
+        long tid = syscall(SYS_gettid);
+        for (const ThreadCounters& t : threads) {
+            if (t.tid == tid) return true;
+        }
+#endif
+        return attach(false);
+    }
+
+    bool isOpen() const { return !threads.empty(); }
+
+    bool available(Event e) const {
+        return !threads.empty() && threads.front().fds[e] >= 0;
+    }
+
+    const std::string& unavailableReason() const { return reason; }
+
+    // Current totals over every attached thread
+    Sample read() const {
+        Sample sample;
+#if defined(__linux__)
+        for (const ThreadCounters& t : threads) {
+            for (int e = 0; e < EVENT_COUNT; ++e) {
+                if (t.fds[e] < 0) continue;
+                uint64_t data[3]; // value, time enabled, time running
+                if (::read(t.fds[e], data, sizeof(data)) != static_cast<ssize_t>(sizeof(data))) continue;
+                double value = static_cast<double>(data[0]);
+                if (data[2] > 0 && data[2] < data[1]) {
+                    value *= static_cast<double>(data[1]) / data[2]; // multiplexed
+                }
+                sample.values[e] += value;
+                sample.valid[e] = true;
+            }
+        }
+#endif
+        return sample;
+    }
+
+    void close() {
+#if defined(__linux__)
+        for (ThreadCounters& t : threads) {
+            for (int e = 0; e < EVENT_COUNT; ++e) {
+                if (t.fds[e] >= 0) ::close(t.fds[e]);
+            }
+        }
+#endif
+        threads.clear();
+    }
+
+private:
+    struct ThreadCounters {
+        long tid;
+        int fds[EVENT_COUNT];
+    };
+
+    std::vector<ThreadCounters> threads;
+    std::string reason;
+    std::mutex mutex;
+
+    bool attach(bool inherit) {
+#if defined(__linux__)
+        static const uint32_t types[EVENT_COUNT] = {
+            PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE, PERF_TYPE_HARDWARE,
+            PERF_TYPE_HW_CACHE, PERF_TYPE_SOFTWARE, PERF_TYPE_SOFTWARE
+        };
+        static const uint64_t configs[EVENT_COUNT] = {
+            PERF_COUNT_HW_CPU_CYCLES,
+            PERF_COUNT_HW_INSTRUCTIONS,
+            PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+            PERF_COUNT_HW_BRANCH_MISSES,
+            PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+            PERF_COUNT_SW_TASK_CLOCK,
+            PERF_COUNT_SW_PAGE_FAULTS
+        };
+
+        ThreadCounters t;
+        t.tid = syscall(SYS_gettid);
+        bool any = false;
+        std::string missing;
+        for (int e = 0; e < EVENT_COUNT; ++e) {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = types[e];
+            attr.config = configs[e];
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            attr.inherit = inherit ? 1 : 0;
+            attr.exclude_kernel = 1; // allowed at perf_event_paranoid <= 2
+            attr.exclude_hv = 1;
+
+            t.fds[e] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+            if (t.fds[e] >= 0) {
+                any = true;
+            } else {
+                missing += std::string(missing.empty() ? "" : ", ") + eventName(e) + " (" + std::strerror(errno) + ")";
+            }
+        }
+        if (!any) {
+            reason = "perf_event_open failed: " + missing;
+            return false;
+        }
+        if (threads.empty()) {
+            reason = missing.empty() ? "" : "unavailable: " + missing;
+        }
+        threads.push_back(t);
+        return true;
+#else
+        (void)inherit;
+        reason = "perf_event_open is Linux-only";
+        return false;
+#endif
+    }
+};
+
+#endif // PERF_COUNTERS_H
@@ -0,0 +1,722 @@
+#ifndef QUERY_SERVER_H
+#define QUERY_SERVER_H
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+// Local query server: load once, then answer requests over a Unix domain
+// socket or 127.0.0.1 TCP.
+//
+// Wire format (all integers little-endian):
+//   request:  u32 bodyLength | u32 requestId | u16 opcode | body
+//   response: u32 bodyLength | u32 requestId | u16 status | body
+// Bodies are built with WireWriter / read with WireReader: fixed-width
+// integers, f64, and strings as u32 length + bytes. A connection may
+// pipeline requests; responses carry the request id and can come back in
+// any order. Status is one of QueryServer::Status; for FAILED and
+// BAD_REQUEST the body is a message string.
+//
+// One epoll thread accepts connections, reads and frames requests and
+// writes responses; handlers run on a pool of worker threads, which hand
+// finished responses back to the loop through an eventfd. A connection
+// stops being read while it has too many requests in flight or too much
+// unsent output, so a client that pipelines without reading cannot grow
+// the server's memory. Requests sent before a client half-closes are
+// still answered. On platforms without epoll the listen calls fail with
+// a message.
+//
+//   QueryServer server([&](uint16_t op, WireReader& in, WireWriter& out) { ... });
+//   server.listenUnix("/tmp/fire.sock");
+//   server.run();     // until stop(), which is safe from a signal handler
+
+class WireWriter {
+public:
+    void u8(uint8_t v) { data.push_back(static_cast<char>(v)); }
+    void u16(uint16_t v) { put(v, 2); }
+    void u32(uint32_t v) { put(v, 4); }
+    void u64(uint64_t v) { put(v, 8); }
+    void i32(int32_t v) { put(static_cast<uint32_t>(v), 4); }
+    void i64(int64_t v) { put(static_cast<uint64_t>(v), 8); }
+
+    void f64(double v) {
+        uint64_t bits;
+        std::memcpy(&bits, &v, sizeof(bits));
+        put(bits, 8);
+    }
+
+    void str(const std::string& s) {
+        u32(static_cast<uint32_t>(s.size()));
+        data.append(s);
+    }
+
+    const std::string& bytes() const { return data; }
+    std::string& bytes() { return data; }
+    void clear() { data.clear(); }
+
+private:
+    std::string data;
+
+    void put(uint64_t v, int width) {
+        for (int i = 0; i < width; ++i) {
+            data.push_back(static_cast<char>((v >> (8 * i)) & 0xFF));
+        }
+    }
+};
+
+// Reads a body; throws std::out_of_range when it runs past the end, which
+// the server answers with BAD_REQUEST
+class WireReader {
+public:
+    WireReader(const char* bytes, size_t length) : data(bytes), size(length) {}
+    explicit WireReader(const std::string& bytes) : data(bytes.data()), size(bytes.size()) {}
+
+    uint8_t u8() { return static_cast<uint8_t>(get(1)); }
+    uint16_t u16() { return static_cast<uint16_t>(get(2)); }
+    uint32_t u32() { return static_cast<uint32_t>(get(4)); }
+    uint64_t u64() { return get(8); }
+    int32_t i32() { return static_cast<int32_t>(get(4)); }
+    int64_t i64() { return static_cast<int64_t>(get(8)); }
+
+    double f64() {
+        uint64_t bits = get(8);
+        double v;
+        std::memcpy(&v, &bits, sizeof(v));
+        return v;
+    }
+
+    std::string str() {
+        uint32_t length = u32();
+        need(length);
+        std::string s(data + offset, length);
+        offset += length;
+        return s;
+    }
+
+    bool atEnd() const { return offset == size; }
+
+private:
+    const char* data;
+    size_t size;
+    size_t offset = 0;
+
+    void need(size_t n) const {
+        if (size - offset < n) {
+            throw std::out_of_range("truncated request body");
+        }
+    }
+
+    uint64_t get(int width) {
+        need(width);
+        uint64_t v = 0;
+        for (int i = 0; i < width; ++i) {
+            v |= static_cast<uint64_t>(static_cast<uint8_t>(data[offset + i])) << (8 * i);
+        }
+        offset += width;
+        return v;
+    }
+};
+
+namespace wire {
+
+const size_t kHeaderSize = 10;
+const uint32_t kMaxBody = 64u << 20;
+const size_t kMaxInFlight = 128;            // requests queued or running, per connection
+const size_t kMaxPendingOutput = 16u << 20; // unsent response bytes, per connection
+
+inline void header(std::string& out, uint32_t bodyLength, uint32_t id, uint16_t code) {
+    WireWriter w;
+    w.u32(bodyLength);
+    w.u32(id);
+    w.u16(code);
+    out.append(w.bytes());
+}
+
+inline void parseHeader(const char* p, uint32_t& bodyLength, uint32_t& id, uint16_t& code) {
+    WireReader r(p, kHeaderSize);
+    bodyLength = r.u32();
+    id = r.u32();
+    code = r.u16();
+}
+
+}  // namespace wire
+
+#if defined(__linux__)
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <deque>
+#include <fcntl.h>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+class QueryServer {
+public:
+    enum Status : uint16_t {
+        OK = 0,
+        BAD_REQUEST = 1,    // malformed body or wrong operand types
+        UNKNOWN_OP = 2,
+        FAILED = 3          // the handler threw
+    };
+
+    // Fills the response body for one request; may throw (FAILED, or
+    // BAD_REQUEST for std::out_of_range / std::invalid_argument)
+    typedef std::function<void(uint16_t opcode, WireReader& request, WireWriter& response)> Handler;
+
+    // Thrown by handlers for opcodes they do not know
+    struct UnknownOpcode : std::runtime_error {
+        UnknownOpcode() : std::runtime_error("unknown opcode") {}
+    };
+
+    explicit QueryServer(Handler h, int workers = 0)
+        : handler(std::move(h)),
+          workerCount(workers > 0 ? workers : std::max(1u, std::thread::hardware_concurrency())) {
+        epollFd = epoll_create1(EPOLL_CLOEXEC);
+        wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        addWatch(wakeFd, EPOLLIN);
+    }
+
+    ~QueryServer() {
+        stop();
+        for (auto& entry : connections) ::close(entry.second->fd);
+        for (int fd : listenFds) ::close(fd);
+        if (!unixPath.empty()) ::unlink(unixPath.c_str());
+        ::close(wakeFd);
+        ::close(epollFd);
+    }
+
+    QueryServer(const QueryServer&) = delete;
+    QueryServer& operator=(const QueryServer&) = delete;
+
+    // Replaces a stale socket file at path
+    bool listenUnix(const std::string& path) {
+        sockaddr_un addr;
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(addr.sun_path)) {
+            error = "socket path too long: " + path;
+            return false;
+        }
+        std::strcpy(addr.sun_path, path.c_str());
+        int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        ::unlink(path.c_str());
+        if (fd < 0 || bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || listen(fd, 512) != 0) {
+            error = "cannot listen on " + path + ": " + std::strerror(errno);
+            if (fd >= 0) ::close(fd);
+            return false;
+        }
+        unixPath = path;
+        listenFds.push_back(fd);
+        addWatch(fd, EPOLLIN);
+        return true;
+    }
+
+    // Loopback only; port 0 picks a free port (see getTcpPort)
+    bool listenTcp(int port) {
+        sockaddr_in addr;
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<uint16_t>(port));
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        int one = 1;
+        if (fd >= 0) setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        if (fd < 0 || bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || listen(fd, 512) != 0) {
+            error = "cannot listen on 127.0.0.1:" + std::to_string(port) + ": " + std::strerror(errno);
+            if (fd >= 0) ::close(fd);
+            return false;
+        }
+        socklen_t length = sizeof(addr);
+        getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &length);
+        tcpPort = ntohs(addr.sin_port);
+        listenFds.push_back(fd);
+        addWatch(fd, EPOLLIN);
+        return true;
+    }
+
+    const std::string& lastError() const { return error; }
+    int getTcpPort() const { return tcpPort; }
+    uint64_t getRequestCount() const { return served.load(std::memory_order_relaxed); }
+
+    // Serve until stop(); starts the workers and runs the event loop on the
+    // calling thread
+    void run() {
+        for (int i = 0; i < workerCount; ++i) {
+            workers.emplace_back(&QueryServer::workerLoop, this);
+        }
+
+        std::vector<epoll_event> events(256);
+        while (!stopping.load()) {
+            int n = epoll_wait(epollFd, events.data(), static_cast<int>(events.size()), -1);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                break;
+            }
+            for (int i = 0; i < n; ++i) {
+                int fd = events[i].data.fd;
+                if (fd == wakeFd) {
+                    uint64_t count;
+                    while (read(wakeFd, &count, sizeof(count)) > 0) {
+                    }
+                    deliverCompletions();
+                } else if (isListener(fd)) {
+                    acceptAll(fd);
+                } else {
+                    auto it = connections.find(fd);
+                    if (it == connections.end()) continue;
+                    Connection& c = *it->second;
+                    if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                        if (!(events[i].events & EPOLLIN)) {
+                            closeConnection(c);
+                            continue;
+                        }
+                    }
+                    if ((events[i].events & EPOLLIN) && !readRequests(c)) {
+                        closeConnection(c);
+                        continue;
+                    }
+                    if (!service(c)) {
+                        closeConnection(c);
+                    }
+                }
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(jobMutex);
+            stopping.store(true);
+        }
+        jobReady.notify_all();
+        for (std::thread& worker : workers) worker.join();
+        workers.clear();
+    }
+
+    // Async-signal-safe: only an atomic store and a write(2)
+    void stop() {
+        stopping.store(true);
+        uint64_t one = 1;
+        ssize_t ignored = write(wakeFd, &one, sizeof(one));
+        (void)ignored;
+    }
+
+private:
+    struct Connection {
+        int fd;
+        uint64_t id;
+        std::string in;
+        std::string out;
+        size_t outOffset = 0;
+        size_t inFlight = 0;        // dispatched requests not yet answered
+        bool readClosed = false;    // the client half-closed (or closed)
+        uint32_t watched = EPOLLIN;
+    };
+
+    struct Job {
+        uint64_t connection;
+        uint32_t requestId;
+        uint16_t opcode;
+        std::string body;
+    };
+
+    struct Completion {
+        uint64_t connection;
+        std::string frame;
+    };
+
+    Handler handler;
+    int workerCount;
+    int epollFd = -1;
+    int wakeFd = -1;
+    int tcpPort = 0;
+    std::string unixPath;
+    std::string error;
+    std::vector<int> listenFds;
+    std::atomic<bool> stopping{false};
+    std::atomic<uint64_t> served{0};
+
+    std::unordered_map<int, std::unique_ptr<Connection>> connections;   // by fd
+    std::unordered_map<uint64_t, int> connectionFds;                    // id -> fd
+    uint64_t nextConnectionId = 1;
+
+    std::vector<std::thread> workers;
+    std::mutex jobMutex;
+    std::condition_variable jobReady;
+    std::deque<Job> jobs;
+
+    std::mutex completionMutex;
+    std::vector<Completion> completions;
+
+    void addWatch(int fd, uint32_t events) {
+        epoll_event ev;
+        std::memset(&ev, 0, sizeof(ev));
+        ev.events = events;
+        ev.data.fd = fd;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev);
+    }
+
+    // Too much work outstanding to accept more requests from c
+    static bool saturated(const Connection& c) {
+        return c.inFlight >= wire::kMaxInFlight || c.out.size() - c.outOffset >= wire::kMaxPendingOutput;
+    }
+
+    // Nothing more will be read and every answer has been sent
+    static bool finished(const Connection& c) {
+        return c.readClosed && c.inFlight == 0 && c.outOffset == c.out.size();
+    }
+
+    // Watch for input while c may take more requests, for output while
+    // some is unsent
+    void updateWatch(Connection& c) {
+        uint32_t events = (c.readClosed || saturated(c) ? 0u : uint32_t(EPOLLIN)) |
+                          (c.outOffset < c.out.size() ? uint32_t(EPOLLOUT) : 0u);
+        if (events == c.watched) return;
+        epoll_event ev;
+        std::memset(&ev, 0, sizeof(ev));
+        ev.events = events;
+        ev.data.fd = c.fd;
+        epoll_ctl(epollFd, EPOLL_CTL_MOD, c.fd, &ev);
+        c.watched = events;
+    }
+
+    // Send what can be sent, dispatch requests buffered while c was
+    // saturated, and adjust the watch; false to close
+    bool service(Connection& c) {
+        if (!flush(c) || !dispatch(c)) return false;
+        updateWatch(c);
+        return !finished(c);
+    }
+
+    bool isListener(int fd) const {
+        for (int l : listenFds) {
+            if (l == fd) return true;
+        }
+        return false;
+    }
+
+    void acceptAll(int listenFd) {
+        while (true) {
+            int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) return;
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));     // fails harmlessly on AF_UNIX
+            std::unique_ptr<Connection> c(new Connection());
+            c->fd = fd;
+            c->id = nextConnectionId++;
+            connectionFds[c->id] = fd;
+            connections[fd] = std::move(c);
+            addWatch(fd, EPOLLIN);
+        }
+    }
+
+    void closeConnection(Connection& c) {
+        int fd = c.fd;
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+        connectionFds.erase(c.id);
+        connections.erase(fd);      // destroys c
+        ::close(fd);
+    }
+
+    // Read what is available, queueing complete frames as they arrive, until
+    // the socket is drained or c is saturated; false to close
+    bool readRequests(Connection& c) {
+        char buffer[64 * 1024];
+        while (!c.readClosed && !saturated(c)) {
+            ssize_t n = read(c.fd, buffer, sizeof(buffer));
+            if (n > 0) {
+                c.in.append(buffer, static_cast<size_t>(n));
+                if (!dispatch(c)) return false;
+                continue;
+            }
+            if (n == 0) {
+                // Half-close: the frames already read are still answered
+                c.readClosed = true;
+                break;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            if (errno == EINTR) continue;
+            return false;
+        }
+        return true;
+    }
+
+    // Queue complete frames from the input buffer while c is not
+    // saturated; false for an oversized frame
+    bool dispatch(Connection& c) {
+        size_t offset = 0;
+        std::vector<Job> ready;
+        while (c.inFlight + ready.size() < wire::kMaxInFlight && c.in.size() - offset >= wire::kHeaderSize) {
+            uint32_t length, id;
+            uint16_t opcode;
+            wire::parseHeader(c.in.data() + offset, length, id, opcode);
+            if (length > wire::kMaxBody) return false;
+            if (c.in.size() - offset < wire::kHeaderSize + length) break;
+            ready.push_back(Job{c.id, id, opcode, c.in.substr(offset + wire::kHeaderSize, length)});
+            offset += wire::kHeaderSize + length;
+        }
+        c.in.erase(0, offset);
+        c.inFlight += ready.size();
+
+        if (!ready.empty()) {
+            {
+                std::lock_guard<std::mutex> lock(jobMutex);
+                for (Job& job : ready) jobs.push_back(std::move(job));
+            }
+            if (ready.size() == 1) {
+                jobReady.notify_one();
+            } else {
+                jobReady.notify_all();
+            }
+        }
+        return true;
+    }
+
+    // Write as much of the output buffer as the socket takes; false to close
+    bool flush(Connection& c) {
+        while (c.outOffset < c.out.size()) {
+            ssize_t n = send(c.fd, c.out.data() + c.outOffset, c.out.size() - c.outOffset, MSG_NOSIGNAL);
+            if (n > 0) {
+                c.outOffset += static_cast<size_t>(n);
+                continue;
+            }
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return true;
+            return false;
+        }
+        c.out.clear();
+        c.outOffset = 0;
+        return true;
+    }
+
+    void deliverCompletions() {
+        std::vector<Completion> done;
+        {
+            std::lock_guard<std::mutex> lock(completionMutex);
+            done.swap(completions);
+        }
+        std::vector<int> touched;
+        for (Completion& completion : done) {
+            auto it = connectionFds.find(completion.connection);
+            if (it == connectionFds.end()) continue;    // client went away
+            Connection& c = *connections[it->second];
+            touched.push_back(c.fd);
+            c.out.append(completion.frame);
+            c.inFlight--;
+        }
+        std::sort(touched.begin(), touched.end());
+        touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+        for (int fd : touched) {
+            auto it = connections.find(fd);
+            if (it != connections.end() && !service(*it->second)) closeConnection(*it->second);
+        }
+    }
+
+    void workerLoop() {
+        WireWriter response;
+        while (true) {
+            Job job;
+            {
+                std::unique_lock<std::mutex> lock(jobMutex);
+                jobReady.wait(lock, [this] { return stopping.load() || !jobs.empty(); });
+                if (jobs.empty()) return;
+                job = std::move(jobs.front());
+                jobs.pop_front();
+            }
+
+            Status status = OK;
+            response.clear();
+            try {
+                WireReader request(job.body);
+                handler(job.opcode, request, response);
+            } catch (const UnknownOpcode&) {
+                status = UNKNOWN_OP;
+                response.clear();
+            } catch (const std::out_of_range& e) {
+                status = BAD_REQUEST;
+                response.clear();
+                response.str(e.what());
+            } catch (const std::invalid_argument& e) {
+                status = BAD_REQUEST;
+                response.clear();
+                response.str(e.what());
+            } catch (const std::exception& e) {
+                status = FAILED;
+                response.clear();
+                response.str(e.what());
+            }
+
+            Completion completion;
+            completion.connection = job.connection;
+            completion.frame.reserve(wire::kHeaderSize + response.bytes().size());
+            wire::header(completion.frame, static_cast<uint32_t>(response.bytes().size()), job.requestId, status);
+            completion.frame.append(response.bytes());
+            served.fetch_add(1, std::memory_order_relaxed);
+
+            bool wasEmpty;
+            {
+                std::lock_guard<std::mutex> lock(completionMutex);
+                wasEmpty = completions.empty();
+                completions.push_back(std::move(completion));
+            }
+            if (wasEmpty) {
+                uint64_t one = 1;
+                ssize_t ignored = write(wakeFd, &one, sizeof(one));
+                (void)ignored;
+            }
+        }
+    }
+};
+
+// Blocking client for tools and benchmarks. send() / receive() allow
+// pipelining; call() is one round trip.
+class QueryClient {
+public:
+    QueryClient() = default;
+    ~QueryClient() { close(); }
+
+    QueryClient(const QueryClient&) = delete;
+    QueryClient& operator=(const QueryClient&) = delete;
+
+    bool connectUnix(const std::string& path) {
+        sockaddr_un addr;
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(addr.sun_path)) return false;
+        std::strcpy(addr.sun_path, path.c_str());
+        fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        return fd >= 0 && ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0;
+    }
+
+    bool connectTcp(int port) {
+        sockaddr_in addr;
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<uint16_t>(port));
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        int one = 1;
+        if (fd >= 0) setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        return fd >= 0 && ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0;
+    }
+
+    void close() {
+        if (fd >= 0) ::close(fd);
+        fd = -1;
+    }
+
+    // Half-close: no more requests, but the responses still arrive
+    void shutdownWrite() {
+        if (fd >= 0) ::shutdown(fd, SHUT_WR);
+    }
+
+    // Returns the request id
+    uint32_t send(uint16_t opcode, const std::string& body) {
+        uint32_t id = nextId++;
+        std::string frame;
+        wire::header(frame, static_cast<uint32_t>(body.size()), id, opcode);
+        frame.append(body);
+        if (!writeAll(frame.data(), frame.size())) throw std::runtime_error("query server connection lost");
+        return id;
+    }
+
+    // Next response on this connection
+    void receive(uint32_t& id, uint16_t& status, std::string& body) {
+        char header[wire::kHeaderSize];
+        uint32_t length;
+        if (!readAll(header, sizeof(header))) throw std::runtime_error("query server connection lost");
+        wire::parseHeader(header, length, id, status);
+        body.resize(length);
+        if (length > 0 && !readAll(&body[0], length)) throw std::runtime_error("query server connection lost");
+    }
+
+    // One round trip; the status is QueryServer::Status
+    uint16_t call(uint16_t opcode, const std::string& request, std::string& response) {
+        uint32_t sent = send(opcode, request);
+        uint32_t id;
+        uint16_t status;
+        do {
+            receive(id, status, response);
+        } while (id != sent);
+        return status;
+    }
+
+private:
+    int fd = -1;
+    uint32_t nextId = 1;
+
+    bool writeAll(const char* p, size_t n) {
+        while (n > 0) {
+            ssize_t w = ::send(fd, p, n, MSG_NOSIGNAL);
+            if (w < 0 && errno == EINTR) continue;
+            if (w <= 0) return false;
+            p += w;
+            n -= static_cast<size_t>(w);
+        }
+        return true;
+    }
+
+    bool readAll(char* p, size_t n) {
+        while (n > 0) {
+            ssize_t r = ::read(fd, p, n);
+            if (r < 0 && errno == EINTR) continue;
+            if (r <= 0) return false;
+            p += r;
+            n -= static_cast<size_t>(r);
+        }
+        return true;
+    }
+};
+
+#else  // !__linux__
+
+#include <functional>
+
+class QueryServer {
+public:
+    enum Status : uint16_t { OK = 0, BAD_REQUEST = 1, UNKNOWN_OP = 2, FAILED = 3 };
+    typedef std::function<void(uint16_t, WireReader&, WireWriter&)> Handler;
+    struct UnknownOpcode : std::runtime_error {
+        UnknownOpcode() : std::runtime_error("unknown opcode") {}
+    };
+
+    explicit QueryServer(Handler, int = 0) {}
+    bool listenUnix(const std::string&) { return false; }
+    bool listenTcp(int) { return false; }
+    const std::string& lastError() const { return error; }
+    int getTcpPort() const { return 0; }
+    uint64_t getRequestCount() const { return 0; }
+    void run() {}
+    void stop() {}
+
+private:
+    std::string error = "server mode needs Linux (epoll)";
+};
+
+class QueryClient {
+public:
+    bool connectUnix(const std::string&) { return false; }
+    bool connectTcp(int) { return false; }
+    void close() {}
+    void shutdownWrite() {}
+    uint32_t send(uint16_t, const std::string&) { throw std::runtime_error("query client needs Linux"); }
+    void receive(uint32_t&, uint16_t&, std::string&) { throw std::runtime_error("query client needs Linux"); }
+    uint16_t call(uint16_t, const std::string&, std::string&) { throw std::runtime_error("query client needs Linux"); }
+};
+
+#endif  // __linux__
+
+#endif  // QUERY_SERVER_H
@@ -0,0 +1,59 @@
+#ifndef THREAD_AFFINITY_H
+#define THREAD_AFFINITY_H
+
+#include <pthread.h>
+#include <sched.h>
+#include <vector>
+
+#include "NumaTopology.h"
+
+// Pins worker threads to CPUs for scaling runs. Worker i goes to the i-th
+// CPU the process may run on (wrapping around), taken node by node
+// (NumaTopology::cpuOrder), so a sweep over 1, 2, 4, ... threads fills
+// cores in a fixed order, one socket before the next, instead of wherever
+// the scheduler puts them. No-ops on platforms without
+// pthread_setaffinity_np.
+class ThreadAffinity {
+public:
+    // CPUs in the process affinity mask, in ascending order
+    static const std::vector<int>& allowedCpus() {
+        static const std::vector<int> cpus = [] {
+            std::vector<int> list;
+#if defined(__linux__)
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+                for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+                    if (CPU_ISSET(cpu, &set)) list.push_back(cpu);
+                }
+            }
+#endif
+            return list;
+        }();
+        return cpus;
+    }
+
+    // Pin a thread to the CPU for worker index; false if unsupported or refused
+    static bool pin(pthread_t thread, int workerIndex) {
+#if defined(__linux__)
+        const std::vector<int>& cpus = NumaTopology::instance().cpuOrder();
+        if (cpus.empty() || workerIndex < 0) {
+            return false;
+        }
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpus[workerIndex % cpus.size()], &set);
+        return pthread_setaffinity_np(thread, sizeof(set), &set) == 0;
+#else
+        (void)thread;
+        (void)workerIndex;
+        return false;
+#endif
+    }
+
+    static bool pinCurrent(int workerIndex) {
+        return pin(pthread_self(), workerIndex);
+    }
+};
+
+#endif // THREAD_AFFINITY_H
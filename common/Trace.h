@@ -0,0 +1,243 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <cstdint>
+#include <string>
+
+// Scoped timeline events exported as Chrome trace JSON (chrome://tracing,
+// ui.perfetto.dev).
+//
+// Each thread records into its own fixed-size ring buffer: the owner
+// writes the slot and then publishes the new head with a release store, so
+// recording takes no locks and never allocates. When a ring is full the
+// oldest events are overwritten. Buffers outlive their threads, so events
+// from finished pthread / OpenMP workers are still exported.
+//
+//   TraceRecorder::instance().start();
+//   {
+//       TraceScope scope("loadCSVFile", "load");
+//       ...
+//       scope.setArg("rows", rows);
+//   }
+//   TraceRecorder::instance().writeFile("trace.json");
+//
+// Recording is off until start(). Build with ENABLE_TRACING=0 (CMake
+// option ENABLE_TRACING=OFF) and TraceScope becomes an empty object.
+
+#ifndef ENABLE_TRACING
+#define ENABLE_TRACING 1
+#endif
+
+#if ENABLE_TRACING
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <unistd.h>
+
+class TraceRecorder {
+public:
+    // Events kept per thread (power of two)
+    static const size_t kRingCapacity = 1 << 16;
+
+    struct Event {
+        const char* name;       // string literals only, not copied
+        const char* category;
+        const char* argName;    // nullptr if the event has no argument
+        int64_t argValue;
+        uint64_t startNs;
+        uint64_t durationNs;
+    };
+
+    struct Ring {
+        int tid;
+        std::string threadName;
+        std::atomic<uint64_t> head;   // events ever written
+        std::unique_ptr<Event[]> events;
+
+        explicit Ring(int id) : tid(id), head(0), events(new Event[kRingCapacity]) {}
+    };
+
+    static TraceRecorder& instance() {
+        // Never destroyed: worker threads may still hold their rings
+        static TraceRecorder* recorder = new TraceRecorder();
+        return *recorder;
+    }
+
+    static uint64_t now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // Starting drops everything recorded so far
+    void start() {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto& ring : rings) ring->head.store(0, std::memory_order_relaxed);
+        origin = now();
+        enabled.store(true, std::memory_order_release);
+    }
+
+    void stop() { enabled.store(false, std::memory_order_release); }
+
+    bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+
+    // Called by the owning thread only
+    void record(const Event& event) {
+        Ring& ring = localRing();
+        uint64_t head = ring.head.load(std::memory_order_relaxed);
+        ring.events[head & (kRingCapacity - 1)] = event;
+        ring.head.store(head + 1, std::memory_order_release);
+    }
+
+    // Label the calling thread's track, e.g. "omp worker 3"
+    void setThreadName(const std::string& name) {
+        Ring& ring = localRing();
+        std::lock_guard<std::mutex> lock(mutex);
+        ring.threadName = name;
+    }
+
+    // Chrome trace JSON: one complete ("X") event per scope plus thread names.
+    // Call after the traced work has finished.
+    bool writeFile(const std::string& path) {
+        std::ofstream out(path);
+        if (!out.is_open()) {
+            std::cerr << "Error: could not write " << path << std::endl;
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        long pid = static_cast<long>(getpid());
+        out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+        bool first = true;
+        char buffer[64];
+        for (const auto& ring : rings) {
+            std::string name = ring->threadName.empty() ? "thread " + std::to_string(ring->tid) : ring->threadName;
+            out << (first ? "" : ",") << "\n{\"ph\": \"M\", \"name\": \"thread_name\", \"pid\": " << pid
+                << ", \"tid\": " << ring->tid << ", \"args\": {\"name\": \"" << jsonEscape(name) << "\"}}";
+            first = false;
+
+            uint64_t head = ring->head.load(std::memory_order_acquire);
+            uint64_t begin = head > kRingCapacity ? head - kRingCapacity : 0;
+            for (uint64_t i = begin; i < head; ++i) {
+                const Event& e = ring->events[i & (kRingCapacity - 1)];
+                if (e.startNs < origin) continue;
+                // Chrome traces use microseconds
+                std::snprintf(buffer, sizeof(buffer), "%.3f, \"dur\": %.3f",
+                              (e.startNs - origin) / 1000.0, e.durationNs / 1000.0);
+                out << ",\n{\"ph\": \"X\", \"name\": \"" << jsonEscape(e.name) << "\", \"cat\": \"" << jsonEscape(e.category)
+                    << "\", \"pid\": " << pid << ", \"tid\": " << ring->tid << ", \"ts\": " << buffer;
+                if (e.argName != nullptr) {
+                    out << ", \"args\": {\"" << jsonEscape(e.argName) << "\": " << e.argValue << "}";
+                }
+                out << "}";
+            }
+        }
+        out << "\n]}\n";
+        return true;
+    }
+
+private:
+    std::mutex mutex;
+    std::vector<std::unique_ptr<Ring>> rings;
+    std::atomic<bool> enabled{false};
+    uint64_t origin = 0;
+
+    // Quotes, backslashes and control characters would break the JSON
+    static std::string jsonEscape(const std::string& text) {
+        std::string out;
+        for (char c : text) {
+            if (c == '"' || c == '\\') {
+                out += '\\';
+                out += c;
+            } else if (static_cast<unsigned char>(c) < 0x20) {
+                char code[8];
+                std::snprintf(code, sizeof(code), "\\u%04x", static_cast<unsigned>(c));
+                out += code;
+            } else {
+                out += c;
+            }
+        }
+        return out;
+    }
+
+    Ring& localRing() {
+        static thread_local Ring* ring = nullptr;
+        if (ring == nullptr) {
+            std::lock_guard<std::mutex> lock(mutex);
+            rings.emplace_back(new Ring(static_cast<int>(rings.size())));
+            ring = rings.back().get();
+        }
+        return *ring;
+    }
+};
+
+// Records one event covering its lifetime while the recorder is started
+class TraceScope {
+private:
+    TraceRecorder::Event event;
+    bool active;
+
+public:
+    TraceScope(const char* name, const char* category)
+        : active(TraceRecorder::instance().isEnabled()) {
+        if (active) {
+            event.name = name;
+            event.category = category;
+            event.argName = nullptr;
+            event.argValue = 0;
+            event.startNs = TraceRecorder::now();
+        }
+    }
+
+    ~TraceScope() { end(); }
+
+    // Close the event before the end of the enclosing scope
+    void end() {
+        if (active) {
+            event.durationNs = TraceRecorder::now() - event.startNs;
+            TraceRecorder::instance().record(event);
+            active = false;
+        }
+    }
+
+    void setArg(const char* name, int64_t value) {
+        event.argName = name;
+        event.argValue = value;
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+};
+
+#else // !ENABLE_TRACING
+
+// Compiled out: empty objects the optimiser removes entirely
+class TraceRecorder {
+public:
+    static TraceRecorder& instance() {
+        static TraceRecorder recorder;
+        return recorder;
+    }
+
+    void start() {}
+    void stop() {}
+    bool isEnabled() const { return false; }
+    void setThreadName(const std::string&) {}
+    bool writeFile(const std::string&) { return false; }
+};
+
+class TraceScope {
+public:
+    TraceScope(const char*, const char*) {}
+    void end() {}
+    void setArg(const char*, int64_t) {}
+};
+
+#endif // ENABLE_TRACING
+
+#endif // TRACE_H
@@ -0,0 +1,30 @@
+#ifndef AIR_QUALITY_RECORD_H
+#define AIR_QUALITY_RECORD_H
+
+#include <string>
+
+// Structure to represent a single air quality record
+struct AirQualityRecord
+{
+    double latitude;
+    double longitude;
+    std::string datetime;
+    std::string parameter;
+    double value;
+    std::string unit;
+    double rawConcentration;
+    int aqi;
+    int aqiCategory;
+    std::string siteName;
+    std::string agencyName;
+    std::string siteId;
+    std::string fullSiteId;
+
+    std::string getDate() const
+    {
+        return datetime.substr(0, 10);
+    }
+
+};
+
+#endif // AIR_QUALITY_RECORD_H
@@ -0,0 +1,733 @@
+#ifndef FIRE_COLUMNAR_H
+#define FIRE_COLUMNAR_H
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+#include "AirQualityRecord.h"
+#include "FireQuery.h"
+#include "TaskScheduler.h"
+
+// Self-describing columnar file for the fire records, laid out like a
+// small Parquet file:
+//
+//   "FCOL0001"
+//   row group 0: one chunk per column
+//   row group 1: ...
+//   footer: schema, then per row group its date, row count and, per column,
+//           chunk offset / size, null count, min / max and dictionary size
+//   u32 footer length, "FCOL0001"
+//
+// There is one row group per date, matching the data/YYYYMMDD directories.
+// Double and int columns are stored as plain little-endian arrays. String
+// columns get a dictionary page (the distinct values) followed by a data
+// page of indexes, 1, 2 or 4 bytes wide depending on the dictionary size.
+// Nulls are empty strings and NaN doubles; min / max cover the other values.
+//
+// A reader needs the footer and then only the chunks it asks for:
+// ColumnarReader::prune() keeps the row groups whose statistics may satisfy
+// a query's predicates, and read() decodes the requested columns of one
+// group, so one day's records cost one row group's pages.
+//
+// The same row-group encoding is the spill format of the analyzer's
+// memory budget (ScratchFile below).
+namespace FireColumnar
+{
+const char kMagic[8] = {'F', 'C', 'O', 'L', '0', '0', '0', '1'};
+
+enum PhysicalType : uint8_t
+{
+    F64,
+    I32,
+    DICTIONARY
+};
+
+// Every field of AirQualityRecord; DATE is derived from DATETIME
+inline const std::vector<Column> &storedColumns()
+{
+    static const std::vector<Column> columns = {
+        Column::LATITUDE, Column::LONGITUDE, Column::DATETIME, Column::PARAMETER, Column::VALUE,
+        Column::UNIT, Column::RAW_CONCENTRATION, Column::AQI, Column::AQI_CATEGORY,
+        Column::SITE_NAME, Column::AGENCY, Column::SITE_ID, Column::FULL_SITE_ID};
+    return columns;
+}
+
+inline PhysicalType physicalType(Column column)
+{
+    if (column == Column::AQI || column == Column::AQI_CATEGORY)
+        return I32;
+    return isNumeric(column) ? F64 : DICTIONARY;
+}
+
+struct ChunkInfo
+{
+    uint64_t offset = 0;
+    uint64_t bytes = 0;
+    uint64_t nullCount = 0;
+    uint32_t dictionarySize = 0;
+    double min = 0.0;               // numeric columns
+    double max = 0.0;
+    std::string textMin;            // string columns
+    std::string textMax;
+};
+
+struct RowGroupInfo
+{
+    std::string date;               // YYYY-MM-DD
+    uint64_t rows = 0;
+    std::vector<ChunkInfo> chunks;  // in storedColumns() order
+};
+
+// Little-endian encoding of the pages and footer
+class Encoder
+{
+public:
+    std::string bytes;
+
+    void u8(uint8_t v) { bytes.push_back(static_cast<char>(v)); }
+    void u32(uint32_t v) { put(v, 4); }
+    void u64(uint64_t v) { put(v, 8); }
+
+    void f64(double v)
+    {
+        uint64_t bits;
+        std::memcpy(&bits, &v, sizeof(bits));
+        put(bits, 8);
+    }
+
+    void str(const std::string &s)
+    {
+        u32(static_cast<uint32_t>(s.size()));
+        bytes.append(s);
+    }
+
+    void put(uint64_t v, int width)
+    {
+        for (int i = 0; i < width; i++)
+            bytes.push_back(static_cast<char>((v >> (8 * i)) & 0xFF));
+    }
+};
+
+// Throws std::runtime_error past the end, so a corrupt file fails the
+// read instead of running off the buffer
+class Decoder
+{
+public:
+    Decoder(const char *data, size_t size) : data(data), size(size) {}
+
+    uint8_t u8() { return static_cast<uint8_t>(get(1)); }
+    uint32_t u32() { return static_cast<uint32_t>(get(4)); }
+    uint64_t u64() { return get(8); }
+
+    double f64()
+    {
+        uint64_t bits = get(8);
+        double v;
+        std::memcpy(&v, &bits, sizeof(v));
+        return v;
+    }
+
+    std::string str()
+    {
+        uint32_t length = u32();
+        need(length);
+        std::string s(data + offset, length);
+        offset += length;
+        return s;
+    }
+
+    uint64_t get(int width)
+    {
+        need(width);
+        uint64_t v = 0;
+        for (int i = 0; i < width; i++)
+            v |= static_cast<uint64_t>(static_cast<uint8_t>(data[offset + i])) << (8 * i);
+        offset += width;
+        return v;
+    }
+
+    void need(size_t n) const
+    {
+        if (size - offset < n)
+            throw std::runtime_error("truncated columnar page");
+    }
+
+private:
+    const char *data;
+    size_t size;
+    size_t offset = 0;
+};
+
+// Could any value in [min, max] satisfy p?
+template <typename T>
+bool rangeMayMatch(Predicate::Op op, const T &min, const T &max, const T &low, const T &high,
+                   const std::vector<T> &in)
+{
+    switch (op)
+    {
+    case Predicate::EQ: return low >= min && low <= max;
+    case Predicate::NE: return !(min == max && min == low);
+    case Predicate::LT: return min < low;
+    case Predicate::LE: return min <= low;
+    case Predicate::GT: return max > low;
+    case Predicate::GE: return max >= low;
+    case Predicate::BETWEEN: return max >= low && min <= high;
+    case Predicate::IN:
+        return std::any_of(in.begin(), in.end(), [&](const T &v) { return v >= min && v <= max; });
+    }
+    return true;
+}
+
+// False only when no row of the group can satisfy p
+inline bool mayMatch(const RowGroupInfo &group, const Predicate &p)
+{
+    if (p.column == Column::DATE)
+        return p.matchesText(group.date);
+
+    const std::vector<Column> &columns = storedColumns();
+    size_t c = std::find(columns.begin(), columns.end(), p.column) - columns.begin();
+    if (c == columns.size())
+        return true;
+    const ChunkInfo &chunk = group.chunks[c];
+    bool numeric = physicalType(p.column) != DICTIONARY;
+    if (chunk.nullCount > 0 &&
+        (numeric ? p.matchesNumber(std::nan("")) : p.matchesText(std::string_view())))
+        return true;
+    if (chunk.nullCount == group.rows)
+        return false;
+    if (numeric)
+        return rangeMayMatch(p.op, chunk.min, chunk.max, p.low, p.high, p.numbers);
+    return rangeMayMatch(p.op, chunk.textMin, chunk.textMax, p.textLow, p.textHigh, p.texts);
+}
+
+inline void setNumber(AirQualityRecord &record, Column column, double v)
+{
+    switch (column)
+    {
+    case Column::LATITUDE: record.latitude = v; break;
+    case Column::LONGITUDE: record.longitude = v; break;
+    case Column::VALUE: record.value = v; break;
+    case Column::RAW_CONCENTRATION: record.rawConcentration = v; break;
+    case Column::AQI: record.aqi = static_cast<int>(v); break;
+    case Column::AQI_CATEGORY: record.aqiCategory = static_cast<int>(v); break;
+    default: break;
+    }
+}
+
+inline std::string *textField(AirQualityRecord &record, Column column)
+{
+    switch (column)
+    {
+    case Column::DATETIME: return &record.datetime;
+    case Column::PARAMETER: return &record.parameter;
+    case Column::UNIT: return &record.unit;
+    case Column::SITE_NAME: return &record.siteName;
+    case Column::AGENCY: return &record.agencyName;
+    case Column::SITE_ID: return &record.siteId;
+    case Column::FULL_SITE_ID: return &record.fullSiteId;
+    default: return nullptr;
+    }
+}
+
+// Encode one column of a row group's rows and fill in its statistics
+inline void encodeChunk(const std::vector<AirQualityRecord> &records, const std::vector<size_t> &rows,
+                        Column column, Encoder &out, ChunkInfo &info)
+{
+    PhysicalType type = physicalType(column);
+    if (type != DICTIONARY)
+    {
+        bool first = true;
+        for (size_t row : rows)
+        {
+            double v = QueryEngine::numberOf(records[row], column);
+            if (type == I32)
+                out.put(static_cast<uint32_t>(static_cast<int32_t>(v)), 4);
+            else
+                out.f64(v);
+            if (std::isnan(v))
+            {
+                info.nullCount++;
+                continue;
+            }
+            info.min = first ? v : std::min(info.min, v);
+            info.max = first ? v : std::max(info.max, v);
+            first = false;
+        }
+        return;
+    }
+
+    std::unordered_map<std::string_view, uint32_t> codes;
+    std::vector<std::string_view> dictionary;
+    std::vector<uint32_t> indexes;
+    indexes.reserve(rows.size());
+    for (size_t row : rows)
+    {
+        std::string_view v = QueryEngine::textOf(records[row], column);
+        auto inserted = codes.emplace(v, static_cast<uint32_t>(dictionary.size()));
+        if (inserted.second)
+            dictionary.push_back(v);
+        indexes.push_back(inserted.first->second);
+        if (v.empty())
+            info.nullCount++;
+    }
+
+    bool first = true;
+    out.u32(static_cast<uint32_t>(dictionary.size()));
+    for (std::string_view v : dictionary)
+    {
+        out.u32(static_cast<uint32_t>(v.size()));
+        out.bytes.append(v.data(), v.size());
+        if (v.empty())
+            continue;
+        if (first || v < info.textMin)
+            info.textMin = std::string(v);
+        if (first || v > info.textMax)
+            info.textMax = std::string(v);
+        first = false;
+    }
+    info.dictionarySize = static_cast<uint32_t>(dictionary.size());
+
+    int width = dictionary.size() <= 0x100 ? 1 : dictionary.size() <= 0x10000 ? 2 : 4;
+    out.u8(static_cast<uint8_t>(width));
+    for (uint32_t index : indexes)
+        out.put(index, width);
+}
+
+// Decode one chunk into rows consecutive records
+inline void decodeChunk(const char *data, size_t size, Column column, size_t rows,
+                        AirQualityRecord *records)
+{
+    Decoder in(data, size);
+    PhysicalType type = physicalType(column);
+    if (type == F64)
+    {
+        for (size_t i = 0; i < rows; i++)
+            setNumber(records[i], column, in.f64());
+        return;
+    }
+    if (type == I32)
+    {
+        for (size_t i = 0; i < rows; i++)
+            setNumber(records[i], column, static_cast<int32_t>(in.u32()));
+        return;
+    }
+
+    std::vector<std::string> dictionary(in.u32());
+    for (std::string &v : dictionary)
+        v = in.str();
+    int width = in.u8();
+    if (width != 1 && width != 2 && width != 4)
+        throw std::runtime_error("bad columnar index width");
+    for (size_t i = 0; i < rows; i++)
+    {
+        uint32_t index = static_cast<uint32_t>(in.get(width));
+        if (index >= dictionary.size())
+            throw std::runtime_error("columnar dictionary index out of range");
+        *textField(records[i], column) = dictionary[index];
+    }
+}
+
+// Encode rows as one row group: group gets the row count and, per column,
+// its statistics and chunk offset / size relative to the start of out
+inline void encodeRowGroup(const std::vector<AirQualityRecord> &records, const std::vector<size_t> &rows,
+                           RowGroupInfo &group, Encoder &out)
+{
+    const std::vector<Column> &columns = storedColumns();
+    group.rows = rows.size();
+    group.chunks.assign(columns.size(), ChunkInfo());
+    size_t base = out.bytes.size();
+    for (size_t c = 0; c < columns.size(); c++)
+    {
+        size_t start = out.bytes.size();
+        encodeChunk(records, rows, columns[c], out, group.chunks[c]);
+        group.chunks[c].offset = start - base;
+        group.chunks[c].bytes = out.bytes.size() - start;
+    }
+}
+
+// size bytes at offset of fd; throws std::runtime_error on a short read
+inline std::string readAt(int fd, uint64_t offset, uint64_t size)
+{
+    std::string buffer(size, '\0');
+    size_t done = 0;
+    while (done < size)
+    {
+        ssize_t n = ::pread(fd, &buffer[done], size - done, static_cast<off_t>(offset + done));
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            throw std::runtime_error(n == 0 ? "unexpected end of file" : std::strerror(errno));
+        done += static_cast<size_t>(n);
+    }
+    return buffer;
+}
+
+// Append the rows of group (chunk offsets absolute in fd) to out; fields of
+// columns not asked for are left zero / empty. Returns the page bytes read.
+inline uint64_t readRowGroup(int fd, const RowGroupInfo &group, const std::vector<Column> &columns,
+                             std::vector<AirQualityRecord> &out)
+{
+    const std::vector<Column> &stored = storedColumns();
+    size_t first = out.size();
+    uint64_t bytesRead = 0;
+    out.resize(first + group.rows);
+    for (Column column : columns)
+    {
+        if (column == Column::DATE)
+            column = Column::DATETIME;
+        size_t c = std::find(stored.begin(), stored.end(), column) - stored.begin();
+        if (c == stored.size())
+            continue;
+        const ChunkInfo &chunk = group.chunks[c];
+        std::string page = readAt(fd, chunk.offset, chunk.bytes);
+        bytesRead += chunk.bytes;
+        decodeChunk(page.data(), page.size(), column, group.rows, out.data() + first);
+    }
+    return bytesRead;
+}
+
+inline bool writeAll(int fd, const char *data, size_t size, uint64_t &offset)
+{
+    while (size > 0)
+    {
+        ssize_t n = ::write(fd, data, size);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        data += n;
+        size -= static_cast<size_t>(n);
+        offset += static_cast<uint64_t>(n);
+    }
+    return true;
+}
+
+class ColumnarWriter
+{
+public:
+    // Rows keep their relative order within each date
+    static bool write(const std::string &path, const std::vector<AirQualityRecord> &records,
+                      std::string &error, uint64_t *fileBytes = nullptr)
+    {
+        std::map<std::string, std::vector<size_t>> byDate;
+        for (size_t i = 0; i < records.size(); i++)
+            byDate[records[i].getDate()].push_back(i);
+
+        std::vector<RowGroupInfo> groups;
+        std::vector<const std::vector<size_t> *> groupRows;
+        for (const auto &entry : byDate)
+        {
+            RowGroupInfo group;
+            group.date = entry.first;
+            groups.push_back(group);
+            groupRows.push_back(&entry.second);
+        }
+
+        // Row groups encode independently; they are written in date order
+        std::vector<Encoder> encoded(groups.size());
+        TaskScheduler::instance().parallelFor(groups.size(), 1, [&](size_t lo, size_t hi)
+        {
+            for (size_t g = lo; g < hi; g++)
+                encodeRowGroup(records, *groupRows[g], groups[g], encoded[g]);
+        });
+
+        int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0)
+        {
+            error = "Could not create " + path + ": " + std::strerror(errno);
+            return false;
+        }
+        uint64_t offset = 0;
+        bool ok = writeAll(fd, kMagic, sizeof(kMagic), offset);
+        for (size_t g = 0; ok && g < groups.size(); g++)
+        {
+            for (ChunkInfo &chunk : groups[g].chunks)
+                chunk.offset += offset;
+            ok = writeAll(fd, encoded[g].bytes.data(), encoded[g].bytes.size(), offset);
+            std::string().swap(encoded[g].bytes);
+        }
+
+        Encoder footer;
+        encodeFooter(groups, footer);
+        footer.u32(static_cast<uint32_t>(footer.bytes.size()));
+        footer.bytes.append(kMagic, sizeof(kMagic));
+        ok = ok && writeAll(fd, footer.bytes.data(), footer.bytes.size(), offset);
+        if (::close(fd) != 0)
+            ok = false;
+        if (!ok)
+        {
+            error = "Write to " + path + " failed: " + std::strerror(errno);
+            return false;
+        }
+        if (fileBytes)
+            *fileBytes = offset;
+        return true;
+    }
+
+private:
+    static void encodeFooter(const std::vector<RowGroupInfo> &groups, Encoder &out)
+    {
+        const std::vector<Column> &columns = storedColumns();
+        out.u32(static_cast<uint32_t>(columns.size()));
+        for (Column column : columns)
+        {
+            out.u8(static_cast<uint8_t>(column));
+            out.u8(physicalType(column));
+            out.str(columnName(column));
+        }
+        out.u32(static_cast<uint32_t>(groups.size()));
+        for (const RowGroupInfo &group : groups)
+        {
+            out.str(group.date);
+            out.u64(group.rows);
+            for (size_t c = 0; c < columns.size(); c++)
+            {
+                const ChunkInfo &chunk = group.chunks[c];
+                out.u64(chunk.offset);
+                out.u64(chunk.bytes);
+                out.u64(chunk.nullCount);
+                out.u32(chunk.dictionarySize);
+                if (physicalType(columns[c]) == DICTIONARY)
+                {
+                    out.str(chunk.textMin);
+                    out.str(chunk.textMax);
+                }
+                else
+                {
+                    out.f64(chunk.min);
+                    out.f64(chunk.max);
+                }
+            }
+        }
+    }
+};
+
+// Reads are pread()s on one descriptor, so several threads may read
+// row groups of the same open file
+class ColumnarReader
+{
+public:
+    ColumnarReader() = default;
+    ColumnarReader(const ColumnarReader &) = delete;
+    ColumnarReader &operator=(const ColumnarReader &) = delete;
+
+    ~ColumnarReader()
+    {
+        if (fd >= 0)
+            ::close(fd);
+    }
+
+    // Reads the footer only
+    bool open(const std::string &path, std::string &error)
+    {
+        fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+        {
+            error = "Could not open " + path + ": " + std::strerror(errno);
+            return false;
+        }
+        try
+        {
+            off_t size = ::lseek(fd, 0, SEEK_END);
+            const size_t trailer = 4 + sizeof(kMagic);
+            if (size < static_cast<off_t>(sizeof(kMagic) + trailer))
+                throw std::runtime_error("too short");
+            std::string tail = readAt(fd, size - trailer, trailer);
+            if (std::memcmp(tail.data() + 4, kMagic, sizeof(kMagic)) != 0)
+                throw std::runtime_error("bad magic");
+            uint32_t footerBytes = static_cast<uint32_t>(Decoder(tail.data(), 4).u32());
+            if (footerBytes > static_cast<uint64_t>(size) - sizeof(kMagic) - trailer)
+                throw std::runtime_error("bad footer length");
+            std::string footer = readAt(fd, size - trailer - footerBytes, footerBytes);
+            decodeFooter(footer);
+        }
+        catch (const std::exception &e)
+        {
+            error = path + " is not a columnar fire file (" + e.what() + ")";
+            return false;
+        }
+        return true;
+    }
+
+    const std::vector<RowGroupInfo> &rowGroups() const { return groups; }
+
+    uint64_t totalRows() const
+    {
+        uint64_t rows = 0;
+        for (const RowGroupInfo &group : groups)
+            rows += group.rows;
+        return rows;
+    }
+
+    // Bytes of pages read so far (the footer is not counted)
+    uint64_t getBytesRead() const { return bytesRead.load(); }
+
+    // Row groups whose statistics may satisfy every predicate of query
+    std::vector<size_t> prune(const Query &query) const
+    {
+        std::vector<size_t> kept;
+        for (size_t g = 0; g < groups.size(); g++)
+        {
+            bool keep = true;
+            for (const Predicate &p : query.predicates)
+                keep = keep && mayMatch(groups[g], p);
+            if (keep)
+                kept.push_back(g);
+        }
+        return kept;
+    }
+
+    // Columns a query reads: predicates, group keys and aggregates
+    static std::vector<Column> columnsFor(const Query &query)
+    {
+        std::vector<Column> columns;
+        auto add = [&columns](Column column)
+        {
+            if (column == Column::DATE)
+                column = Column::DATETIME;
+            if (std::find(columns.begin(), columns.end(), column) == columns.end())
+                columns.push_back(column);
+        };
+        for (const Predicate &p : query.predicates)
+            add(p.column);
+        for (Column column : query.groupColumns)
+            add(column);
+        for (const Aggregate &aggregate : query.aggregates)
+            if (aggregate.function != Aggregate::COUNT)
+                add(aggregate.column);
+        return columns;
+    }
+
+    // Append the rows of row group g to out; fields of columns not asked
+    // for are left zero / empty
+    void read(size_t g, const std::vector<Column> &columns, std::vector<AirQualityRecord> &out)
+    {
+        bytesRead += readRowGroup(fd, groups.at(g), columns, out);
+    }
+
+    void read(size_t g, std::vector<AirQualityRecord> &out) { read(g, storedColumns(), out); }
+
+private:
+    int fd = -1;
+    std::vector<RowGroupInfo> groups;
+    std::atomic<uint64_t> bytesRead{0};
+
+    void decodeFooter(const std::string &footer)
+    {
+        Decoder in(footer.data(), footer.size());
+        const std::vector<Column> &columns = storedColumns();
+        uint32_t columnCount = in.u32();
+        if (columnCount != columns.size())
+            throw std::runtime_error("unexpected column count");
+        for (Column column : columns)
+        {
+            uint8_t id = in.u8();
+            uint8_t type = in.u8();
+            in.str();
+            if (id != static_cast<uint8_t>(column) || type != physicalType(column))
+                throw std::runtime_error("unexpected schema");
+        }
+        groups.resize(in.u32());
+        for (RowGroupInfo &group : groups)
+        {
+            group.date = in.str();
+            group.rows = in.u64();
+            group.chunks.resize(columns.size());
+            for (size_t c = 0; c < columns.size(); c++)
+            {
+                ChunkInfo &chunk = group.chunks[c];
+                chunk.offset = in.u64();
+                chunk.bytes = in.u64();
+                chunk.nullCount = in.u64();
+                chunk.dictionarySize = in.u32();
+                if (physicalType(columns[c]) == DICTIONARY)
+                {
+                    chunk.textMin = in.str();
+                    chunk.textMax = in.str();
+                }
+                else
+                {
+                    chunk.min = in.f64();
+                    chunk.max = in.f64();
+                }
+            }
+        }
+    }
+};
+
+// Scratch space for spilled row groups (FireDataAnalyzer memory budget):
+// an unlinked temporary file, so its blocks go back to the filesystem when
+// the process exits however it exits. Segments are row groups in the page
+// encoding above, appended and never rewritten; only the footer-level
+// RowGroupInfo stays in memory.
+class ScratchFile
+{
+public:
+    ScratchFile() = default;
+    ScratchFile(const ScratchFile &) = delete;
+    ScratchFile &operator=(const ScratchFile &) = delete;
+
+    ~ScratchFile()
+    {
+        if (fd >= 0)
+            ::close(fd);
+    }
+
+    bool open(const std::string &dir, std::string &error)
+    {
+        std::string path = dir + "/fire-spill-XXXXXX";
+        fd = ::mkstemp(&path[0]);
+        if (fd < 0)
+        {
+            error = "Could not create a scratch file in " + dir + ": " + std::strerror(errno);
+            return false;
+        }
+        ::unlink(path.c_str());
+        return true;
+    }
+
+    // Write segment (a row group encoded by encodeRowGroup()) at the end
+    // of the file and make group's chunk offsets absolute
+    bool append(const std::string &segment, RowGroupInfo &group, std::string &error)
+    {
+        uint64_t offset = size;
+        if (::lseek(fd, static_cast<off_t>(offset), SEEK_SET) < 0 ||
+            !writeAll(fd, segment.data(), segment.size(), size))
+        {
+            error = std::string("Write to scratch file failed: ") + std::strerror(errno);
+            size = offset;
+            return false;
+        }
+        for (ChunkInfo &chunk : group.chunks)
+            chunk.offset += offset;
+        return true;
+    }
+
+    // Append every column of a spilled group to out; pread()s, so several
+    // groups may be read at once
+    uint64_t read(const RowGroupInfo &group, std::vector<AirQualityRecord> &out) const
+    {
+        return readRowGroup(fd, group, storedColumns(), out);
+    }
+
+    uint64_t bytes() const { return size; }
+
+private:
+    int fd = -1;
+    uint64_t size = 0;
+};
+} // namespace FireColumnar
+
+#endif // FIRE_COLUMNAR_H
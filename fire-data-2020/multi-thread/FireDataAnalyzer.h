@@ -0,0 +1,1484 @@
+#ifndef FIRE_DATA_ANALYZER_H
+#define FIRE_DATA_ANALYZER_H
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <unordered_map>
+#include <atomic>
+#include <mutex>
+#include <variant>
+
+#include "omp.h"
+#include "AirQualityRecord.h"
+#include "AsyncFileReader.h"
+#include "Decompress.h"
+#include "FireColumnar.h"
+#include "FireQuery.h"
+#include "Metrics.h"
+#include "ResultCache.h"
+#include "TaskScheduler.h"
+#include "ThreadAffinity.h"
+#include "Trace.h"
+
+// Anything the analyzer caches: records for a date, an average, or a
+// composed query's result
+typedef std::variant<std::vector<AirQualityRecord>, double, QueryResult> CachedResult;
+
+class FireDataAnalyzer
+{
+private:
+    std::vector<AirQualityRecord> records;
+
+    // Print per-call timing / result lines (off for benchmarks)
+    bool verbose = true;
+
+    // A data/YYYYMMDD directory in partitioned mode
+    struct Partition
+    {
+        std::string dir;
+        bool resident = false;
+        size_t rows = 0;            // kept after eviction, to plan batches
+        size_t bytes = 0;           // records plus their string heap bytes
+        uint64_t lastUse = 0;
+        bool spilled = false;       // spill holds the day's rows in the scratch file
+        FireColumnar::RowGroupInfo spill;
+    };
+
+    // Partitioned mode (openLazy, or loadData under a memory budget): date
+    // partitions by YYYY-MM-DD, loaded on first access and evicted least
+    // recently used past memoryBudget bytes (0: no limit). Evicted days
+    // are spilled to a scratch file under spillDir and paged back from it.
+    bool partitioned = false;
+    std::map<std::string, Partition> partitions;
+    size_t memoryBudget = 0;
+    std::string spillDir = std::filesystem::temp_directory_path().string();
+    std::unique_ptr<FireColumnar::ScratchFile> scratch;
+    uint64_t partitionClock = 0;
+    uint64_t partitionLoads = 0;
+    uint64_t partitionPageIns = 0;
+    uint64_t partitionSpills = 0;
+    uint64_t partitionEvictions = 0;
+    std::mutex partitionMutex;
+
+    // Read files through io_uring when the kernel allows it
+    bool asyncIO = true;
+    std::string loadIOMode = "blocking";
+
+    // Guards records and the bitmap indexes while file tasks merge rows
+    std::mutex mergeMutex;
+
+    // Ad-hoc queries over records; bitmap indexes grow with each merged row,
+    // kernel columns are rebuilt after each load
+    QueryEngine engine{records};
+
+    // Repeated queries are answered from here; ingest drops the entries
+    // whose dates it adds rows to
+    ResultCache<CachedResult> resultCache{kDefaultCacheBytes};
+
+    // Heap bytes of a string, none while it fits the inline buffer
+    static size_t heapBytes(const std::string &s)
+    {
+        const char *inline_ = reinterpret_cast<const char *>(&s);
+        bool small = s.data() >= inline_ && s.data() < inline_ + sizeof(s);
+        return small ? 0 : s.capacity() + 1;
+    }
+
+    static size_t recordBytes(const AirQualityRecord &r)
+    {
+        return sizeof(AirQualityRecord) + heapBytes(r.datetime) + heapBytes(r.parameter) + heapBytes(r.unit) +
+               heapBytes(r.siteName) + heapBytes(r.agencyName) + heapBytes(r.siteId) + heapBytes(r.fullSiteId);
+    }
+
+    static size_t resultBytes(const std::vector<AirQualityRecord> &rows)
+    {
+        size_t bytes = (rows.capacity() - rows.size()) * sizeof(AirQualityRecord);
+        for (const AirQualityRecord &r : rows)
+            bytes += recordBytes(r);
+        return bytes;
+    }
+
+    static size_t resultBytes(double) { return sizeof(double); }
+
+    static size_t resultBytes(const QueryResult &result)
+    {
+        size_t bytes = sizeof(QueryResult) + heapBytes(result.plan) + result.rows.capacity() * sizeof(QueryResult::Row);
+        for (const std::string &column : result.columns)
+            bytes += sizeof(std::string) + heapBytes(column);
+        for (const QueryResult::Row &row : result.rows)
+        {
+            bytes += row.values.capacity() * sizeof(double);
+            for (const std::string &key : row.key)
+                bytes += sizeof(std::string) + heapBytes(key);
+        }
+        return bytes;
+    }
+
+    // compute() on a miss; the result is cached against the dates it read.
+    // The pointer shares the cache entry, so a hit copies nothing.
+    template <typename T, typename Compute>
+    std::shared_ptr<const T> cached(const std::string &key, const DateSpan &dates, Compute compute)
+    {
+        if (!resultCache.enabled())
+            return std::make_shared<const T>(compute());
+        if (std::shared_ptr<const CachedResult> hit = resultCache.find(key))
+        {
+            METRICS_COUNTER_ADD("fire_result_cache_hits_total", 1);
+            return std::shared_ptr<const T>(hit, &std::get<T>(*hit));
+        }
+        METRICS_COUNTER_ADD("fire_result_cache_misses_total", 1);
+        uint64_t generation = resultCache.generation();
+        auto value = std::make_shared<const CachedResult>(compute());
+        resultCache.insert(key, value, resultBytes(std::get<T>(*value)), dates, generation);
+        return std::shared_ptr<const T>(value, &std::get<T>(*value));
+    }
+
+    std::vector<AirQualityRecord> scanAQIDataForDate(const std::string &targetDate)
+    {
+        std::vector<AirQualityRecord> results;
+
+        // One result vector per chunk, concatenated in chunk order
+        const size_t grain = 16384;
+        std::vector<std::vector<AirQualityRecord>> chunkResults((records.size() + grain - 1) / grain);
+
+        TaskScheduler::instance().parallelFor(records.size(), grain, [&](size_t lo, size_t hi)
+        {
+            TraceScope scanTrace("scan", "query");
+            auto &local = chunkResults[lo / grain];
+            for (size_t i = lo; i < hi; i++)
+            {
+                if (records[i].getDate() == targetDate)
+                {
+                    local.push_back(records[i]);
+                }
+            }
+        });
+
+        for (auto &local : chunkResults)
+        {
+            results.insert(results.end(),
+                           std::make_move_iterator(local.begin()),
+                           std::make_move_iterator(local.end()));
+        }
+        return results;
+    }
+
+    double scanAverageAQIForDate(const std::string &targetDate)
+    {
+        double totalAQI = 0.0;
+        int count = 0;
+
+        const size_t grain = 16384;
+        std::vector<std::pair<double, int>> chunkSums((records.size() + grain - 1) / grain);
+
+        TaskScheduler::instance().parallelFor(records.size(), grain, [&](size_t lo, size_t hi)
+        {
+            std::pair<double, int> &sum = chunkSums[lo / grain];
+            for (size_t i = lo; i < hi; i++)
+            {
+                if (records[i].getDate() == targetDate)
+                {
+                    sum.first += records[i].aqi;
+                    sum.second++;
+                }
+            }
+        });
+        for (const auto &sum : chunkSums)
+        {
+            totalAQI += sum.first;
+            count += sum.second;
+        }
+        return count > 0 ? totalAQI / count : 0.0;
+    }
+
+    // Helper function to remove quotes and clean string
+    std::string cleanString(const std::string &str)
+    {
+        std::string cleaned = str;
+        if (!cleaned.empty() && cleaned.front() == '"')
+        {
+            cleaned.erase(0, 1);
+        }
+        if (!cleaned.empty() && cleaned.back() == '"')
+        {
+            cleaned.pop_back();
+        }
+        return cleaned;
+    }
+
+    // Parse a single CSV line
+    std::vector<std::string> parseCSVLine(const std::string &line)
+    {
+        std::vector<std::string> fields;
+        std::stringstream ss(line);
+        std::string field;
+        bool inQuotes = false;
+        std::string currentField;
+
+        for (char c : line)
+        {
+            if (c == '"')
+            {
+                inQuotes = !inQuotes;
+                currentField += c;
+            }
+            else if (c == ',' && !inQuotes)
+            {
+                fields.push_back(cleanString(currentField));
+                currentField.clear();
+            }
+            else
+            {
+                currentField += c;
+            }
+        }
+        fields.push_back(cleanString(currentField));
+
+        return fields;
+    }
+
+    // One file's lines on their way from the reader to the merge
+    struct ParsedFile
+    {
+        std::vector<std::string> lines;
+        std::vector<AirQualityRecord> rows;
+        size_t bytesRead = 0;          // from disk, compressed for .gz / .zst
+        size_t bytesDecompressed = 0;
+        uint64_t ioNs = 0;
+        uint64_t decompressNs = 0;
+        std::string partial;           // line cut off at the end of a piece
+
+        // Lines as std::getline would return them, from input arriving in
+        // pieces; finishLines() after the last piece
+        void appendLines(const char *data, size_t size)
+        {
+            const char *end = data + size;
+            while (data < end)
+            {
+                const char *newline = static_cast<const char *>(std::memchr(data, '\n', end - data));
+                if (newline == nullptr)
+                {
+                    partial.append(data, end);
+                    return;
+                }
+                if (partial.empty())
+                {
+                    lines.emplace_back(data, newline);
+                }
+                else
+                {
+                    partial.append(data, newline);
+                    lines.push_back(std::move(partial));
+                    partial.clear();
+                }
+                data = newline + 1;
+            }
+        }
+
+        void finishLines()
+        {
+            if (!partial.empty())
+                lines.push_back(std::move(partial));
+            partial.clear();
+        }
+
+        // Decompress a whole .gz / .zst file, splitting lines as chunks arrive
+        bool decompressLines(Decompressor::Format format, const char *data, size_t size, std::string &error)
+        {
+            uint64_t start = MetricsRegistry::now();
+            Decompressor decompressor(format);
+            bool ok = decompressor.decompress(data, size, [this](const char *p, size_t n) { appendLines(p, n); });
+            finishLines();
+            bytesDecompressed = decompressor.getBytesOut();
+            decompressNs = MetricsRegistry::now() - start;
+            if (!ok)
+            {
+                // A truncated row may still parse; load nothing from the file
+                error = decompressor.getError();
+                lines.clear();
+            }
+            return ok;
+        }
+    };
+
+    // Plain .csv, or .csv.gz / .csv.zst when the build can decompress it
+    static bool isCSVInput(const std::string &path, bool &unsupported)
+    {
+        Decompressor::Format format = Decompressor::formatOf(path);
+        std::string stem = format == Decompressor::NONE ? path : path.substr(0, path.rfind('.'));
+        if (stem.size() < 4 || stem.compare(stem.size() - 4, 4, ".csv") != 0)
+            return false;
+        unsupported = !Decompressor::supported(format);
+        return !unsupported;
+    }
+
+    // Convert parsed.lines into parsed.rows; rows that fail to convert are
+    // left default-constructed (empty datetime) and counted as errors
+    void parseLines(ParsedFile &parsed)
+    {
+        const std::vector<std::string> &lines = parsed.lines;
+        std::vector<AirQualityRecord> &localRecords = parsed.rows;
+        localRecords.resize(lines.size());
+
+        // Tokenize / convert times are summed over the chunks of the loop
+        std::atomic<uint64_t> tokenizeNs{0};
+        std::atomic<uint64_t> convertNs{0};
+        std::atomic<size_t> parseErrors{0};
+        TraceScope parseTrace("parse", "load");
+        parseTrace.setArg("lines", lines.size());
+
+        TaskScheduler::instance().parallelFor(lines.size(), 1024, [&](size_t lo, size_t hi)
+        {
+            uint64_t chunkTokenizeNs = 0;
+            uint64_t chunkConvertNs = 0;
+            size_t chunkErrors = 0;
+            for (size_t i = lo; i < hi; i++)
+            {
+                uint64_t tokenizeStart = MetricsRegistry::now();
+                std::vector<std::string> fields = parseCSVLine(lines[i]);
+                uint64_t convertStart = MetricsRegistry::now();
+                chunkTokenizeNs += convertStart - tokenizeStart;
+
+                if (fields.size() >= 13)
+                {
+                    try
+                    {
+                        AirQualityRecord record;
+                        record.latitude = std::stod(fields[0]);
+                        record.longitude = std::stod(fields[1]);
+                        record.datetime = fields[2];
+                        record.parameter = fields[3];
+                        record.value = std::stod(fields[4]);
+                        record.unit = fields[5];
+                        record.rawConcentration = std::stod(fields[6]);
+                        record.aqi = std::stoi(fields[7]);
+                        record.aqiCategory = std::stoi(fields[8]);
+                        record.siteName = fields[9];
+                        record.agencyName = fields[10];
+                        record.siteId = fields[11];
+                        record.fullSiteId = fields[12];
+
+                        localRecords[i] = record;
+                    }
+                    catch (const std::exception &)
+                    {
+                        // Non-numeric field: skip the row instead of aborting the load
+                        chunkErrors++;
+                    }
+                }
+                else if (!lines[i].empty())
+                {
+                    chunkErrors++;
+                }
+                chunkConvertNs += MetricsRegistry::now() - convertStart;
+            }
+            tokenizeNs += chunkTokenizeNs;
+            convertNs += chunkConvertNs;
+            parseErrors += chunkErrors;
+        });
+        parseTrace.end();
+
+        METRICS_COUNTER_ADD("fire_parse_errors_total", parseErrors.load());
+        METRICS_TIME_OBSERVE("fire_load_phase_seconds{phase=\"tokenize\"}", tokenizeNs.load());
+        METRICS_TIME_OBSERVE("fire_load_phase_seconds{phase=\"convert\"}", convertNs.load());
+    }
+
+    // Append a parsed file's rows; returns how many it added
+    size_t mergeParsed(const ParsedFile &parsed)
+    {
+        uint64_t mergeStart = MetricsRegistry::now();
+        size_t rowCount = 0;
+        std::vector<std::string> touchedDates;
+        {
+            // Every row takes the merge lock, so waits on other files'
+            // merges show up as a longer span here
+            TraceScope mergeTrace("merge (locked)", "load");
+            for (const auto &rec : parsed.rows)
+            {
+                if (!rec.datetime.empty())
+                {
+                    rowCount++;
+                    if (touchedDates.empty() || rec.datetime.compare(0, 10, touchedDates.back()) != 0)
+                        touchedDates.push_back(rec.getDate());
+                    std::lock_guard<std::mutex> lock(mergeMutex);
+                    records.push_back(rec);
+                    engine.indexNewRows();
+                }
+            }
+            mergeTrace.setArg("rows", rowCount);
+        }
+
+        // New rows: the kernel columns are stale, and so are cached results
+        // on the dates they belong to
+        if (rowCount > 0)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mergeMutex);
+                engine.dropIndexes();
+            }
+            resultCache.invalidateDates(touchedDates);
+        }
+
+        METRICS_COUNTER_ADD("fire_files_loaded_total", 1);
+        METRICS_COUNTER_ADD("fire_bytes_read_total", parsed.bytesRead);
+        METRICS_COUNTER_ADD("fire_lines_parsed_total", parsed.lines.size());
+        METRICS_COUNTER_ADD("fire_bytes_decompressed_total", parsed.bytesDecompressed);
+        METRICS_HISTOGRAM_OBSERVE("fire_rows_per_file", rowCount);
+        METRICS_TIME_OBSERVE("fire_load_phase_seconds{phase=\"io\"}", parsed.ioNs);
+        if (parsed.bytesDecompressed > 0)
+            METRICS_TIME_OBSERVE("fire_load_phase_seconds{phase=\"decompress\"}", parsed.decompressNs);
+        METRICS_TIME_OBSERVE("fire_load_phase_seconds{phase=\"merge\"}", MetricsRegistry::now() - mergeStart);
+        return rowCount;
+    }
+
+    // Read files through io_uring with up to depth opens / reads in
+    // flight; each completed file is parsed and merged by a task while the
+    // reader keeps the next ones coming. Files the ring did not read
+    // because it failed part way are read with blocking I/O. Returns
+    // false, having read nothing, when io_uring is unavailable or failed
+    // before reading any file.
+    bool loadCSVFilesAsync(const std::vector<std::string> &files)
+    {
+        AsyncFileReader reader;
+        if (!reader.available())
+        {
+            if (verbose)
+                std::cout << "io_uring unavailable (" << reader.unavailableReason()
+                          << "), reading files with blocking I/O" << std::endl;
+            return false;
+        }
+
+        TaskScheduler &scheduler = TaskScheduler::instance();
+        TaskGroup parsers;
+        // With every buffer held by a parser, run parsers rather than block
+        reader.setWaitHook([&scheduler](const std::function<bool()> &ready) { scheduler.helpUntil(ready); });
+
+        bool complete = reader.readAll(files, [&](const AsyncFileReader::File &file)
+        {
+            if (file.error != 0)
+            {
+                std::cerr << "Error opening file: " << files[file.index] << std::endl;
+                reader.release(file.slot);
+                return;
+            }
+            parsers.run([this, &reader, &files, file]()
+            {
+                TraceScope trace("loadCSVFile", "load");
+                ParsedFile parsed;
+                parsed.bytesRead = file.size;
+                parsed.ioNs = file.ioNanos;
+                Decompressor::Format format = Decompressor::formatOf(files[file.index]);
+                std::string error;
+                if (format == Decompressor::NONE)
+                {
+                    parsed.appendLines(file.data, file.size);
+                    parsed.finishLines();
+                }
+                else if (!parsed.decompressLines(format, file.data, file.size, error))
+                {
+                    std::cerr << "Error reading file: " << files[file.index] << ": " << error << std::endl;
+                }
+                // Lines are copied out, so the buffer can take the next file
+                reader.release(file.slot);
+
+                parseLines(parsed);
+                trace.setArg("rows", mergeParsed(parsed));
+            });
+        });
+        parsers.wait();
+        if (complete)
+            return true;
+
+        const std::vector<size_t> &unread = reader.unreadFiles();
+        if (verbose)
+            std::cout << "io_uring failed (" << reader.unavailableReason() << "), reading " << unread.size()
+                      << " files with blocking I/O" << std::endl;
+        if (unread.size() == files.size())
+            return false;
+        TaskScheduler::instance().parallelFor(unread.size(), 1, [&](size_t lo, size_t hi)
+        {
+            for (size_t i = lo; i < hi; i++)
+                loadCSVFile(files[unread[i]]);
+        });
+        return true;
+    }
+
+    // CSV inputs under dir (recursively or not); compressed files this
+    // build cannot read are counted and reported once
+    static std::vector<std::string> listCSVInputs(const std::string &dir, bool recursive)
+    {
+        std::vector<std::string> files;
+        size_t unsupported = 0;
+        auto add = [&](const std::filesystem::directory_entry &entry)
+        {
+            bool skipped = false;
+            if (isCSVInput(entry.path().string(), skipped))
+                files.push_back(entry.path().string());
+            unsupported += skipped;
+        };
+        if (recursive)
+        {
+            for (const auto &entry : std::filesystem::recursive_directory_iterator(dir))
+                add(entry);
+        }
+        else
+        {
+            for (const auto &entry : std::filesystem::directory_iterator(dir))
+                add(entry);
+        }
+        if (unsupported > 0)
+            std::cerr << "Skipped " << unsupported
+                      << " compressed files this build cannot decompress (see README)" << std::endl;
+        return files;
+    }
+
+    // Parse and merge files into records, through io_uring when possible
+    void loadFiles(const std::vector<std::string> &files)
+    {
+        engine.dropIndexes();
+        if (asyncIO && loadCSVFilesAsync(files))
+        {
+            loadIOMode = "io_uring";
+            return;
+        }
+        // One task per file; each file splits its lines into further
+        // tasks on the same workers, so small and large files balance
+        loadIOMode = "blocking";
+        TaskScheduler::instance().parallelFor(files.size(), 1, [&](size_t lo, size_t hi)
+        {
+            for (size_t i = lo; i < hi; i++)
+                loadCSVFile(files[i]);
+        });
+    }
+
+    // Make the partitions for dates [first, last] resident, then evict the
+    // least recently used others until the resident bytes fit the budget.
+    // The requested range is never evicted, so a call spanning more days
+    // than the budget holds still sees them all (query() splits such
+    // ranges into batches first). Spilled days are paged in from the
+    // scratch file; the others are parsed from their CSV files.
+    void ensureDates(const std::string &first, const std::string &last)
+    {
+        if (!partitioned)
+            return;
+        std::lock_guard<std::mutex> lock(partitionMutex);
+        auto begin = partitions.lower_bound(first);
+        auto end = partitions.upper_bound(last);
+
+        std::vector<std::map<std::string, Partition>::iterator> spilled;
+        std::vector<std::map<std::string, Partition>::iterator> unread;
+        for (auto it = begin; it != end; ++it)
+        {
+            it->second.lastUse = ++partitionClock;
+            if (it->second.resident)
+                continue;
+            (it->second.spilled ? spilled : unread).push_back(it);
+            it->second.resident = true;
+        }
+
+        if (!spilled.empty())
+            pageIn(spilled, unread);
+
+        if (!unread.empty())
+        {
+            TraceScope trace("loadPartitions", "load");
+            trace.setArg("partitions", unread.size());
+            auto start = std::chrono::high_resolution_clock::now();
+            std::vector<std::string> files;
+            for (auto it : unread)
+            {
+                std::vector<std::string> dayFiles = listCSVInputs(it->second.dir, false);
+                files.insert(files.end(), dayFiles.begin(), dayFiles.end());
+                it->second.rows = 0;
+                it->second.bytes = 0;
+            }
+            size_t firstNew = records.size();
+            loadFiles(files);
+
+            // Size the new days from their rows
+            for (size_t i = firstNew; i < records.size(); i++)
+            {
+                auto it = partitions.find(records[i].getDate());
+                if (it == partitions.end())
+                    continue;
+                it->second.rows++;
+                it->second.bytes += recordBytes(records[i]);
+            }
+            partitionLoads += unread.size();
+            METRICS_COUNTER_ADD("fire_partition_loads_total", unread.size());
+
+            auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::high_resolution_clock::now() - start);
+            if (verbose)
+                std::cout << "Loaded " << unread.size() << " date partition(s), " << records.size() - firstNew
+                          << " records in " << duration.count() << " milliseconds (" << loadIOMode << ")"
+                          << std::endl;
+        }
+
+        evictPartitions(first, last);
+    }
+
+    // Decode spilled days back into records. A day whose segment cannot be
+    // read is dropped from the scratch file and left in unread, to be
+    // parsed from its CSV files again. Caller holds partitionMutex.
+    void pageIn(const std::vector<std::map<std::string, Partition>::iterator> &spilled,
+                std::vector<std::map<std::string, Partition>::iterator> &unread)
+    {
+        TraceScope trace("pageInPartitions", "load");
+        trace.setArg("partitions", spilled.size());
+        auto start = std::chrono::high_resolution_clock::now();
+
+        std::vector<std::vector<AirQualityRecord>> decoded(spilled.size());
+        std::vector<char> failed(spilled.size(), 0);
+        uint64_t bytesRead = 0;
+        std::mutex readMutex;
+        TaskScheduler::instance().parallelFor(spilled.size(), 1, [&](size_t lo, size_t hi)
+        {
+            for (size_t i = lo; i < hi; i++)
+            {
+                try
+                {
+                    uint64_t n = scratch->read(spilled[i]->second.spill, decoded[i]);
+                    std::lock_guard<std::mutex> lock(readMutex);
+                    bytesRead += n;
+                }
+                catch (const std::exception &e)
+                {
+                    std::lock_guard<std::mutex> lock(readMutex);
+                    std::cerr << "Scratch read for " << spilled[i]->first << " failed: " << e.what() << std::endl;
+                    std::vector<AirQualityRecord>().swap(decoded[i]);
+                    failed[i] = 1;
+                }
+            }
+        });
+
+        size_t rows = 0;
+        {
+            // No cached result changes, since these are the rows that were
+            // evicted. The bitmaps catch up on the next buildIndexes(), so
+            // a date scan after a page-in does not pay for indexing every
+            // resident row again.
+            std::lock_guard<std::mutex> lock(mergeMutex);
+            for (size_t i = 0; i < spilled.size(); i++)
+            {
+                Partition &partition = spilled[i]->second;
+                if (failed[i])
+                {
+                    partition.spilled = false;
+                    unread.push_back(spilled[i]);
+                    continue;
+                }
+                partition.rows = decoded[i].size();
+                partition.bytes = 0;
+                for (const AirQualityRecord &record : decoded[i])
+                    partition.bytes += recordBytes(record);
+                records.insert(records.end(), std::make_move_iterator(decoded[i].begin()),
+                               std::make_move_iterator(decoded[i].end()));
+                rows += partition.rows;
+            }
+            engine.dropIndexes();
+        }
+
+        size_t pagedIn = spilled.size() - std::count(failed.begin(), failed.end(), 1);
+        partitionPageIns += pagedIn;
+        METRICS_COUNTER_ADD("fire_partition_page_ins_total", pagedIn);
+        METRICS_COUNTER_ADD("fire_spill_bytes_read_total", bytesRead);
+        trace.setArg("rows", rows);
+
+        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::high_resolution_clock::now() - start);
+        if (verbose && pagedIn > 0)
+            std::cout << "Paged in " << pagedIn << " spilled date partition(s), " << rows << " records ("
+                      << bytesRead / (1 << 20) << " MB read) in " << duration.count() << " milliseconds"
+                      << std::endl;
+    }
+
+    // Write the rows of the days about to be evicted to the scratch file,
+    // unless an earlier spill already holds all of them. Caller holds
+    // partitionMutex.
+    void spillPartitions(const std::vector<std::string> &evicted)
+    {
+        if (spillDir.empty())
+            return;
+        if (!scratch)
+        {
+            std::string error;
+            scratch.reset(new FireColumnar::ScratchFile());
+            if (!scratch->open(spillDir, error))
+            {
+                std::cerr << error << "; evicted days will be re-read from their CSV files" << std::endl;
+                scratch.reset();
+                spillDir.clear();
+                return;
+            }
+        }
+
+        // Rows only ever get appended to a day, so a spill with as many
+        // rows as the day has now is still current
+        std::map<std::string, std::vector<size_t>> rowsByDate;
+        for (const std::string &date : evicted)
+        {
+            const Partition &partition = partitions[date];
+            if (!partition.spilled || partition.spill.rows != partition.rows)
+                rowsByDate[date];
+        }
+        if (rowsByDate.empty())
+            return;
+        for (size_t i = 0; i < records.size(); i++)
+        {
+            auto it = rowsByDate.find(records[i].getDate());
+            if (it != rowsByDate.end())
+                it->second.push_back(i);
+        }
+
+        TraceScope trace("spillPartitions", "load");
+        trace.setArg("partitions", rowsByDate.size());
+        std::vector<std::map<std::string, std::vector<size_t>>::iterator> days;
+        for (auto it = rowsByDate.begin(); it != rowsByDate.end(); ++it)
+            days.push_back(it);
+        std::vector<FireColumnar::RowGroupInfo> groups(days.size());
+        std::vector<FireColumnar::Encoder> encoded(days.size());
+        TaskScheduler::instance().parallelFor(days.size(), 1, [&](size_t lo, size_t hi)
+        {
+            for (size_t i = lo; i < hi; i++)
+            {
+                groups[i].date = days[i]->first;
+                FireColumnar::encodeRowGroup(records, days[i]->second, groups[i], encoded[i]);
+            }
+        });
+
+        uint64_t written = 0;
+        for (size_t i = 0; i < days.size(); i++)
+        {
+            Partition &partition = partitions[days[i]->first];
+            std::string error;
+            partition.spilled = scratch->append(encoded[i].bytes, groups[i], error);
+            if (!partition.spilled)
+            {
+                std::cerr << error << std::endl;
+                continue;
+            }
+            partition.spill = std::move(groups[i]);
+            written += encoded[i].bytes.size();
+            partitionSpills++;
+            METRICS_COUNTER_ADD("fire_partition_spills_total", 1);
+        }
+        METRICS_COUNTER_ADD("fire_spill_bytes_written_total", written);
+        trace.setArg("bytes", written);
+    }
+
+    // Caller holds partitionMutex
+    void evictPartitions(const std::string &first, const std::string &last)
+    {
+        if (memoryBudget == 0)
+            return;
+        size_t residentBytes = 0;
+        std::vector<std::map<std::string, Partition>::iterator> candidates;
+        for (auto it = partitions.begin(); it != partitions.end(); ++it)
+        {
+            if (!it->second.resident)
+                continue;
+            residentBytes += it->second.bytes;
+            if (it->first < first || it->first > last)
+                candidates.push_back(it);
+        }
+        if (residentBytes <= memoryBudget)
+            return;
+
+        std::sort(candidates.begin(), candidates.end(),
+                  [](const auto &a, const auto &b) { return a->second.lastUse < b->second.lastUse; });
+        std::vector<std::string> evicted;
+        for (auto it : candidates)
+        {
+            if (residentBytes <= memoryBudget)
+                break;
+            residentBytes -= it->second.bytes;
+            it->second.resident = false;
+            evicted.push_back(it->first);
+        }
+        if (evicted.empty())
+            return;
+
+        TraceScope trace("evictPartitions", "load");
+        trace.setArg("partitions", evicted.size());
+        spillPartitions(evicted);
+        {
+            // Rows are removed from the middle, so the bitmaps start over.
+            // Cached results stay: the data they were computed from is
+            // unchanged, only no longer resident.
+            std::lock_guard<std::mutex> lock(mergeMutex);
+            std::vector<std::string> sorted = evicted;
+            std::sort(sorted.begin(), sorted.end());
+            records.erase(std::remove_if(records.begin(), records.end(), [&sorted](const AirQualityRecord &r)
+            {
+                return std::binary_search(sorted.begin(), sorted.end(), r.getDate());
+            }), records.end());
+            engine.resetIndexes();
+        }
+        partitionEvictions += evicted.size();
+        METRICS_COUNTER_ADD("fire_partition_evictions_total", evicted.size());
+        if (verbose)
+            std::cout << "Evicted " << evicted.size() << " cold date partition(s)" << std::endl;
+    }
+
+    // The days from the first partition at or after next that are expected
+    // to fit the memory budget together, as [first, last]; false past the
+    // last partition up to last. Days not read yet are estimated at the
+    // average size of those that have been (one day at a time until then).
+    bool nextBatch(const std::string &next, const std::string &last, std::string &batchFirst,
+                   std::string &batchLast)
+    {
+        std::lock_guard<std::mutex> lock(partitionMutex);
+        auto it = partitions.lower_bound(next);
+        if (it == partitions.end() || it->first > last)
+            return false;
+        size_t knownBytes = 0;
+        size_t knownDays = 0;
+        for (const auto &entry : partitions)
+        {
+            if (entry.second.rows == 0)
+                continue;
+            knownBytes += entry.second.bytes;
+            knownDays++;
+        }
+
+        batchFirst = batchLast = it->first;
+        size_t batchBytes = 0;
+        for (; it != partitions.end() && it->first <= last; ++it)
+        {
+            bool known = it->second.rows > 0;
+            if (!known && knownDays == 0 && batchBytes > 0)
+                break;
+            size_t bytes = known ? it->second.bytes : knownDays > 0 ? knownBytes / knownDays : 1;
+            if (batchBytes > 0 && batchBytes + bytes > memoryBudget)
+                break;
+            batchBytes += bytes;
+            batchLast = it->first;
+        }
+        return true;
+    }
+
+    // q over dates [first, last] one budget-sized batch of days at a time,
+    // each batch a partial result (QueryEngine::partialQuery) restricted to
+    // its days; the partials are merged at the end
+    QueryResult queryInBatches(const Query &q, const std::string &first, const std::string &last)
+    {
+        TraceScope trace("queryInBatches", "query");
+        auto start = std::chrono::high_resolution_clock::now();
+        bool wasVerbose = verbose;
+        verbose = false;
+        std::vector<QueryResult> partials;
+        std::string next = first;
+        std::string batchFirst;
+        std::string batchLast;
+        while (nextBatch(next, last, batchFirst, batchLast))
+        {
+            ensureDates(batchFirst, batchLast);
+            if (!engine.hasIndexes())
+                engine.buildIndexes();
+            Query partial = QueryEngine::partialQuery(q);
+            partial.where(Predicate::between(Column::DATE, batchFirst, batchLast));
+            partials.push_back(engine.execute(partial));
+            next = batchLast + '\x01';
+        }
+        verbose = wasVerbose;
+        trace.setArg("batches", partials.size());
+        if (verbose)
+        {
+            PartitionStats stats = getPartitionStats();
+            auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::high_resolution_clock::now() - start);
+            std::cout << "Ran " << partials.size() << " batches under the memory budget in " << duration.count()
+                      << " milliseconds; " << stats.resident << " days resident, " << stats.spilled
+                      << " spilled" << std::endl;
+        }
+        QueryResult result = QueryEngine::mergePartials(q, partials);
+        result.plan += ", " + std::to_string(partials.size()) + " batches under the memory budget";
+        return result;
+    }
+
+    // data/YYYYMMDD directories of dataDir, by YYYY-MM-DD
+    static std::map<std::string, Partition> listPartitions(const std::string &dataDir)
+    {
+        std::map<std::string, Partition> found;
+        for (const auto &entry : std::filesystem::directory_iterator(dataDir))
+        {
+            std::string name = entry.path().filename().string();
+            if (!entry.is_directory() || name.size() != 8 ||
+                !std::all_of(name.begin(), name.end(), [](char c) { return c >= '0' && c <= '9'; }))
+                continue;
+            std::string date = name.substr(0, 4) + "-" + name.substr(4, 2) + "-" + name.substr(6, 2);
+            found[date].dir = entry.path().string();
+        }
+        return found;
+    }
+
+    // Forget the partitions and their spills; the records are left to the caller
+    void resetPartitions()
+    {
+        std::lock_guard<std::mutex> lock(partitionMutex);
+        partitioned = false;
+        partitions.clear();
+        scratch.reset();
+    }
+
+    // Start partitioned mode over dataDir's data/YYYYMMDD directories,
+    // with no rows resident
+    bool cataloguePartitions(const std::string &dataDir)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mergeMutex);
+            records.clear();
+            engine.resetIndexes();
+        }
+        resultCache.clear();
+        try
+        {
+            std::map<std::string, Partition> found = listPartitions(dataDir);
+            std::lock_guard<std::mutex> lock(partitionMutex);
+            partitions = std::move(found);
+            partitioned = true;
+        }
+        catch (const std::filesystem::filesystem_error &e)
+        {
+            std::cerr << "Filesystem error: " << e.what() << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    // Read every partition, a budget's worth of days at a time
+    void loadPartitionsInBatches()
+    {
+        std::string next;
+        std::string batchFirst;
+        std::string batchLast;
+        // One summary line from loadData rather than one per batch
+        bool wasVerbose = verbose;
+        verbose = false;
+        while (nextBatch(next, "\xff", batchFirst, batchLast))
+        {
+            ensureDates(batchFirst, batchLast);
+            next = batchLast + '\x01';
+        }
+        verbose = wasVerbose;
+    }
+
+public:
+    void setVerbose(bool enabled) { verbose = enabled; }
+
+    // Pin OpenMP thread / task worker i to the i-th CPU in node order
+    // (ThreadAffinity), so the team fills one NUMA node before the next.
+    // Call before loading: KernelColumns places each thread's block of
+    // rows on the node of the thread that scans it. Pin again after
+    // changing the team size.
+    static void pinWorkers()
+    {
+        // The runtime keeps its thread pool between regions, so pinning
+        // the team once holds for the parallel regions that follow
+#pragma omp parallel
+        ThreadAffinity::pinCurrent(omp_get_thread_num());
+        TaskScheduler::instance().runOnEachWorker([](int worker) { ThreadAffinity::pinCurrent(worker); });
+    }
+
+    size_t getRecordCount() const { return records.size(); }
+
+    // Load all CSV files from the data directory. Under a memory budget
+    // (setMemoryBudget) a data/YYYYMMDD tree is read a budget's worth of
+    // days at a time, spilling the earlier days as it goes, and stays in
+    // partitioned mode (see openLazy).
+    void loadData(const std::string &dataDir)
+    {
+        METRICS_SCOPED_TIMER("fire_load_seconds");
+        TraceScope trace("loadData", "load");
+        auto start = std::chrono::high_resolution_clock::now();
+
+        if (verbose)
+            std::cout << "Loading fire data from: " << dataDir << std::endl;
+
+        engine.dropIndexes();
+
+        // Eager loads replace any partition catalogue (openLazy)
+        resetPartitions();
+
+        if (memoryBudget > 0)
+        {
+            if (!cataloguePartitions(dataDir))
+                return;
+            if (!partitions.empty())
+            {
+                loadPartitionsInBatches();
+                PartitionStats stats = getPartitionStats();
+                trace.setArg("records", stats.rows);
+                auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::high_resolution_clock::now() - start);
+                if (verbose)
+                    std::cout << "Loaded " << stats.rows << " records in " << duration.count() << " milliseconds ("
+                              << loadIOMode << "); " << stats.resident << " of " << stats.partitions
+                              << " days resident (" << stats.residentBytes / (1 << 20) << " MB), "
+                              << stats.spilled << " spilled (" << stats.scratchBytes / (1 << 20) << " MB)"
+                              << std::endl;
+                return;
+            }
+            resetPartitions();
+            std::cerr << "No data/YYYYMMDD directories in " << dataDir
+                      << "; loading without the memory budget" << std::endl;
+        }
+
+        try
+        {
+            loadFiles(listCSVInputs(dataDir, true));
+        }
+        catch (const std::filesystem::filesystem_error &e)
+        {
+            std::cerr << "Filesystem error: " << e.what() << std::endl;
+            return;
+        }
+
+        trace.setArg("records", records.size());
+        trace.setArg("io_uring", loadIOMode == "io_uring");
+
+        auto end = std::chrono::high_resolution_clock::now();
+        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+
+        if (verbose)
+            std::cout << "Loaded " << records.size() << " records in "
+                      << duration.count() << " milliseconds (" << loadIOMode << ")" << std::endl;
+    }
+
+    // Lazy mode: catalogue the data/YYYYMMDD directories without reading
+    // them. A query loads the date partitions it needs on first access;
+    // past the memory budget the least recently used days are spilled and
+    // paged back in when asked for again. Not for server mode, where
+    // queries run concurrently.
+    void openLazy(const std::string &dataDir)
+    {
+        TraceScope trace("openLazy", "load");
+        auto start = std::chrono::high_resolution_clock::now();
+        resetPartitions();
+        if (!cataloguePartitions(dataDir))
+            return;
+        trace.setArg("partitions", partitions.size());
+
+        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::high_resolution_clock::now() - start);
+        if (verbose)
+        {
+            std::cout << "Catalogued " << partitions.size() << " date partitions in " << dataDir;
+            if (!partitions.empty())
+                std::cout << " (" << partitions.begin()->first << " to " << partitions.rbegin()->first << ")";
+            std::cout << " in " << duration.count() << " microseconds; days load on first access" << std::endl;
+        }
+    }
+
+    // Resident record bytes allowed in partitioned mode before cold days
+    // are spilled; 0 (the default) is no limit. Set before loadData /
+    // openLazy.
+    void setMemoryBudget(size_t bytes) { memoryBudget = bytes; }
+
+    // Where the scratch file for spilled days goes (default: the system
+    // temp directory); empty turns spilling off, so evicted days are
+    // parsed from their CSV files again
+    void setSpillDirectory(const std::string &dir) { spillDir = dir; }
+
+    struct PartitionStats
+    {
+        size_t partitions = 0;
+        size_t rows = 0;            // of the days read so far, resident or not
+        size_t resident = 0;
+        size_t residentBytes = 0;
+        size_t spilled = 0;         // days not resident with a current spill
+        uint64_t scratchBytes = 0;
+        uint64_t loads = 0;
+        uint64_t pageIns = 0;
+        uint64_t spills = 0;
+        uint64_t evictions = 0;
+    };
+
+    PartitionStats getPartitionStats()
+    {
+        std::lock_guard<std::mutex> lock(partitionMutex);
+        PartitionStats stats;
+        stats.partitions = partitions.size();
+        for (const auto &entry : partitions)
+        {
+            stats.rows += entry.second.rows;
+            stats.resident += entry.second.resident;
+            stats.residentBytes += entry.second.resident ? entry.second.bytes : 0;
+            stats.spilled += !entry.second.resident && entry.second.spilled;
+        }
+        stats.scratchBytes = scratch ? scratch->bytes() : 0;
+        stats.loads = partitionLoads;
+        stats.pageIns = partitionPageIns;
+        stats.spills = partitionSpills;
+        stats.evictions = partitionEvictions;
+        return stats;
+    }
+
+    bool isPartitioned() const { return partitioned; }
+
+    // Load a single CSV file
+    void loadCSVFile(const std::string &filename)
+    {
+        TraceScope trace("loadCSVFile", "load");
+        Decompressor::Format format = Decompressor::formatOf(filename);
+        std::ifstream file(filename, format == Decompressor::NONE ? std::ios::in : std::ios::binary);
+        if (!file.is_open())
+        {
+            std::cerr << "Error opening file: " << filename << std::endl;
+            return;
+        }
+        ParsedFile parsed;
+        std::string line;
+        std::string compressed;
+
+        uint64_t ioStart = MetricsRegistry::now();
+        {
+            TraceScope readTrace("read", "load");
+            if (format == Decompressor::NONE)
+            {
+                while (std::getline(file, line))
+                {
+                    parsed.bytesRead += line.size() + 1;
+                    parsed.lines.push_back(line);
+                }
+            }
+            else
+            {
+                // Compressed files are a fraction of the size; read whole,
+                // then decompressed in chunks below
+                compressed.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+                parsed.bytesRead = compressed.size();
+            }
+            readTrace.setArg("bytes", parsed.bytesRead);
+        }
+        parsed.ioNs = MetricsRegistry::now() - ioStart;
+
+        std::string error;
+        if (format != Decompressor::NONE && !parsed.decompressLines(format, compressed.data(), compressed.size(), error))
+            std::cerr << "Error reading file: " << filename << ": " << error << std::endl;
+
+        parseLines(parsed);
+        trace.setArg("rows", mergeParsed(parsed));
+
+        file.close();
+    }
+
+    // Off: files are read with blocking ifstream calls even where
+    // io_uring is available
+    void setAsyncIO(bool enabled) { asyncIO = enabled; }
+
+    // "io_uring" or "blocking": how the last loadData() read its files
+    const std::string &getLoadIOMode() const { return loadIOMode; }
+
+    // Write the records to a columnar file (FireColumnar.h), one row group
+    // per date with per-column statistics
+    bool exportColumnar(const std::string &path)
+    {
+        TraceScope trace("exportColumnar", "load");
+        auto start = std::chrono::high_resolution_clock::now();
+        std::string error;
+        uint64_t fileBytes = 0;
+        if (!FireColumnar::ColumnarWriter::write(path, records, error, &fileBytes))
+        {
+            std::cerr << error << std::endl;
+            return false;
+        }
+        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::high_resolution_clock::now() - start);
+        if (verbose)
+            std::cout << "Exported " << records.size() << " records to " << path << " ("
+                      << fileBytes / (1 << 20) << " MB) in " << duration.count() << " milliseconds" << std::endl;
+        return true;
+    }
+
+    // Replace the records with those of a columnar file. With a filter,
+    // only the row groups whose statistics may satisfy its predicates are
+    // read, so a one-date filter reads one day's pages; the other rows are
+    // not loaded and queries will not see them.
+    bool loadColumnar(const std::string &path, const Query *filter = nullptr)
+    {
+        METRICS_SCOPED_TIMER("fire_load_seconds");
+        TraceScope trace("loadColumnar", "load");
+        auto start = std::chrono::high_resolution_clock::now();
+
+        resetPartitions();
+
+        FireColumnar::ColumnarReader reader;
+        std::string error;
+        if (!reader.open(path, error))
+        {
+            std::cerr << error << std::endl;
+            return false;
+        }
+        std::vector<size_t> groups;
+        if (filter)
+        {
+            groups = reader.prune(*filter);
+        }
+        else
+        {
+            for (size_t g = 0; g < reader.rowGroups().size(); g++)
+                groups.push_back(g);
+        }
+
+        // Row groups decode in parallel and are appended in file (date) order
+        std::vector<std::vector<AirQualityRecord>> decoded(groups.size());
+        std::atomic<bool> failed{false};
+        TaskScheduler::instance().parallelFor(groups.size(), 1, [&](size_t lo, size_t hi)
+        {
+            for (size_t i = lo; i < hi; i++)
+            {
+                try
+                {
+                    reader.read(groups[i], decoded[i]);
+                }
+                catch (const std::exception &e)
+                {
+                    std::lock_guard<std::mutex> lock(mergeMutex);
+                    if (!failed.exchange(true))
+                        error = path + ": " + e.what();
+                }
+            }
+        });
+        if (failed)
+        {
+            std::cerr << error << std::endl;
+            return false;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mergeMutex);
+            engine.resetIndexes();
+            records.clear();
+            for (auto &group : decoded)
+            {
+                records.insert(records.end(), std::make_move_iterator(group.begin()),
+                               std::make_move_iterator(group.end()));
+                std::vector<AirQualityRecord>().swap(group);
+            }
+        }
+        resultCache.clear();
+        METRICS_COUNTER_ADD("fire_bytes_read_total", reader.getBytesRead());
+        trace.setArg("row_groups", groups.size());
+        trace.setArg("records", records.size());
+
+        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::high_resolution_clock::now() - start);
+        if (verbose)
+            std::cout << "Loaded " << records.size() << " records from " << groups.size() << " of "
+                      << reader.rowGroups().size() << " row groups (" << reader.getBytesRead() / (1 << 20)
+                      << " MB read) in " << duration.count() << " milliseconds" << std::endl;
+        return true;
+    }
+
+    // Off: composed queries always use the interpreted scan. Cached
+    // results are dropped, since their plans name the other path.
+    void setQueryKernels(bool enabled)
+    {
+        engine.setKernelsEnabled(enabled);
+        resultCache.clear();
+    }
+
+    // Byte budget of the result cache, split over its 16 shards; 0 turns
+    // it off. A day of records is ~9 MB, so smaller budgets skip them.
+    static constexpr size_t kDefaultCacheBytes = 256 << 20;
+    void setResultCacheBytes(size_t bytes) { resultCache.setCapacity(bytes); }
+    ResultCache<CachedResult>::Stats getResultCacheStats() const { return resultCache.getStats(); }
+
+    // Page size for the kernel column arrays (HugePages.h): 4 KB,
+    // transparent or explicit 2 MB pages. The mode is process-wide; the
+    // columns are dropped and mapped again by the next query.
+    void setHugePages(HugePages::Mode mode)
+    {
+        HugePages::setMode(mode);
+        engine.dropIndexes();
+    }
+
+    // Column array bytes, and how many of them the kernel put on huge pages
+    KernelColumns::PageStats getColumnPageStats() const { return engine.getColumns().pageStats(); }
+
+    // Build the query indexes now rather than on the first query; needed
+    // before queries run concurrently (server mode)
+    void buildIndexes()
+    {
+        if (!engine.hasIndexes())
+            engine.buildIndexes();
+    }
+
+    // Run a composed filter / group-by / aggregate query (see FireQuery.h).
+    // Under a memory budget, a date range wider than the budget runs in
+    // batches of days that fit, so it never holds more than a batch.
+    QueryResult query(const Query &q)
+    {
+        DateSpan dates;
+        q.dateBounds(dates.first, dates.last);
+        std::string batchFirst;
+        std::string batchLast;
+        if (partitioned && memoryBudget > 0 && nextBatch(dates.first, dates.last, batchFirst, batchLast) &&
+            nextBatch(batchLast + '\x01', dates.last, batchFirst, batchLast))
+        {
+            return *cached<QueryResult>("query " + q.normalizedKey(), dates,
+                                        [&]() { return queryInBatches(q, dates.first, dates.last); });
+        }
+        return *cached<QueryResult>("query " + q.normalizedKey(), dates, [&]()
+        {
+            ensureDates(dates.first, dates.last);
+            if (!engine.hasIndexes())
+                engine.buildIndexes();
+            return engine.execute(q);
+        });
+    }
+
+    // Get AQI data for a specific date
+    std::vector<AirQualityRecord> getAQIDataForDate(const std::string &targetDate)
+    {
+        return *getAQIDataForDateShared(targetDate);
+    }
+
+    // getAQIDataForDate without the copy: the records are shared with the
+    // result cache, so a hit costs a reference count
+    std::shared_ptr<const std::vector<AirQualityRecord>> getAQIDataForDateShared(const std::string &targetDate)
+    {
+        METRICS_SCOPED_TIMER("fire_query_seconds{query=\"aqi_data_for_date\"}");
+        TraceScope trace("getAQIDataForDate", "query");
+        auto start = std::chrono::high_resolution_clock::now();
+
+        std::shared_ptr<const std::vector<AirQualityRecord>> results = cached<std::vector<AirQualityRecord>>(
+            "aqi_data_for_date " + targetDate, DateSpan::day(targetDate), [&]()
+        {
+            ensureDates(targetDate, targetDate);
+            return scanAQIDataForDate(targetDate);
+        });
+
+        auto end = std::chrono::high_resolution_clock::now();
+        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+
+        if (verbose)
+        {
+            std::cout << "Query completed in " << duration.count() << " microseconds" << std::endl;
+            std::cout << "Found " << results->size() << " records for date: " << targetDate << std::endl;
+        }
+
+        return results;
+    }
+
+    // Get dates where AQI was above a threshold
+    std::vector<std::string> getDaysWithAQIAbove(int threshold)
+    {
+        METRICS_SCOPED_TIMER("fire_query_seconds{query=\"days_with_aqi_above\"}");
+        TraceScope trace("getDaysWithAQIAbove", "query");
+        auto start = std::chrono::high_resolution_clock::now();
+
+        // A date qualifies if any of its rows is above the threshold; the
+        // engine runs this as a parallel group-by on date codes
+        Query days;
+        days.where(Predicate::gt(Column::AQI, threshold)).groupBy(Column::DATE).aggregate(Aggregate::COUNT);
+        QueryResult grouped = query(days);
+
+        std::vector<std::string> results;
+        results.reserve(grouped.rows.size());
+        for (const QueryResult::Row &row : grouped.rows)
+            results.push_back(row.key[0]);
+
+        std::sort(results.begin(), results.end());
+
+        auto end = std::chrono::high_resolution_clock::now();
+        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+
+        if (verbose)
+        {
+            std::cout << "Query completed in " << duration.count() << " microseconds" << std::endl;
+            std::cout << "Found " << results.size() << " days with AQI above " << threshold << std::endl;
+        }
+
+        return results;
+    }
+
+    // Get average AQI for a date
+    double getAverageAQIForDate(const std::string &targetDate)
+    {
+        METRICS_SCOPED_TIMER("fire_query_seconds{query=\"average_aqi_for_date\"}");
+        TraceScope trace("getAverageAQIForDate", "query");
+        auto start = std::chrono::high_resolution_clock::now();
+
+        double average = *cached<double>("average_aqi_for_date " + targetDate, DateSpan::day(targetDate), [&]()
+        {
+            ensureDates(targetDate, targetDate);
+            return scanAverageAQIForDate(targetDate);
+        });
+
+        auto end = std::chrono::high_resolution_clock::now();
+        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+
+        if (verbose)
+            std::cout << "Average AQI query completed in " << duration.count() << " microseconds" << std::endl;
+
+        return average;
+    }
+
+    // Get statistics about the loaded data
+    // done by AI
+    void printDataStatistics()
+    {
+        // One parallel group-by on (date, parameter) gives every figure
+        // below, so only query() needs the rows (in batches under a budget)
+        Query perDay;
+        perDay.groupBy(Column::DATE)
+            .groupBy(Column::PARAMETER)
+            .aggregate(Aggregate::COUNT)
+            .aggregate(Aggregate::MIN, Column::AQI)
+            .aggregate(Aggregate::MAX, Column::AQI);
+        QueryResult grouped = query(perDay);
+        if (grouped.rows.empty())
+        {
+            std::cout << "No data loaded." << std::endl;
+            return;
+        }
+
+        std::vector<std::string> dates;
+        std::vector<std::pair<std::string, uint64_t>> parameterCounts;
+        uint64_t totalRecords = 0;
+        int minAQI = static_cast<int>(grouped.rows[0].values[1]);
+        int maxAQI = static_cast<int>(grouped.rows[0].values[2]);
+        for (const QueryResult::Row &row : grouped.rows)
+        {
+            totalRecords += row.count;
+            dates.push_back(row.key[0]);
+            auto it = std::find_if(parameterCounts.begin(), parameterCounts.end(),
+                                   [&row](const std::pair<std::string, uint64_t> &p) { return p.first == row.key[1]; });
+            if (it == parameterCounts.end())
+                parameterCounts.emplace_back(row.key[1], row.count);
+            else
+                it->second += row.count;
+            minAQI = std::min(minAQI, static_cast<int>(row.values[1]));
+            maxAQI = std::max(maxAQI, static_cast<int>(row.values[2]));
+        }
+        std::sort(dates.begin(), dates.end());
+        dates.erase(std::unique(dates.begin(), dates.end()), dates.end());
+        std::sort(parameterCounts.begin(), parameterCounts.end());
+
+        std::cout << "\n=== DATA STATISTICS ===" << std::endl;
+        std::cout << "Total records: " << totalRecords << std::endl;
+        std::cout << "Date range: " << dates.front() << " to " << dates.back() << std::endl;
+        std::cout << "AQI range: " << minAQI << " to " << maxAQI << std::endl;
+        std::cout << "Number of unique dates: " << dates.size() << std::endl;
+
+        std::cout << "\nParameter distribution:" << std::endl;
+        for (const auto &pair : parameterCounts)
+        {
+            std::cout << "  " << pair.first << ": " << pair.second << " records" << std::endl;
+        }
+    }
+};
+
+#endif // FIRE_DATA_ANALYZER_H
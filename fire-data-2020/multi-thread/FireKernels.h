@@ -0,0 +1,387 @@
+#ifndef FIRE_KERNELS_H
+#define FIRE_KERNELS_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "omp.h"
+#include "AirQualityRecord.h"
+#include "HugePages.h"
+#include "NumaTopology.h"
+#include "Trace.h"
+
+// Compile-time specialised filter + aggregate kernels for the common query
+// shape: optional date range, parameter, site and AQI / value ranges, then
+// count / sum / min / max of AQI and / or value with no grouping.
+//
+// Kernels read KernelColumns, a compact copy of the filtered / aggregated
+// fields (about 20 bytes per row instead of a ~300-byte AirQualityRecord)
+// with dates, parameters and sites dictionary-encoded. Date codes follow
+// date order, so date ranges become code ranges and every filter is an
+// integer or double comparison.
+//
+// Every combination of filters and aggregated columns is its own template
+// instantiation, so a kernel contains only the comparisons it needs.
+// The filters are and-ed without short-circuiting, and the accumulators are
+// updated with selects instead of branches. QueryKernels::run picks the
+// instantiation from a function table indexed by the filter / stats bits.
+// QueryEngine maps a Query onto KernelParams and falls back to the
+// interpreted scan for any other shape.
+
+// Column copies of the loaded records, rebuilt with the query indexes.
+// The arrays are filled in parallel, thread t writing rows rowBlock(t), the
+// same block it scans in every kernel, so with the team pinned node by node
+// (--numa / --pin) each block's pages sit on the node that reads them.
+// Arrays of 2 MB or more are mapped through HugePages (--huge-pages).
+struct KernelColumns
+{
+    template <typename T>
+    using Array = std::vector<T, FirstTouchAllocator<T>>;
+
+    Array<uint16_t> date;       // code into dates (sorted)
+    Array<uint16_t> parameter;  // code into parameters
+    Array<uint32_t> site;       // code into sites (fullSiteId)
+    Array<int32_t> aqi;
+    Array<double> value;
+
+    std::vector<std::string> dates;
+    std::vector<std::string> parameters;
+    std::vector<std::string> sites;
+    std::unordered_map<std::string, uint32_t> siteCodes;
+    std::unordered_map<std::string, uint16_t> parameterCodes;
+    bool usable = false;    // false if a dictionary outgrew its 16-bit codes
+
+    size_t size() const { return aqi.size(); }
+
+    // Rows [lo, hi) of the calling OpenMP thread: a static split of n rows
+    // into one contiguous block per thread
+    static void rowBlock(size_t n, size_t &lo, size_t &hi)
+    {
+        size_t threads = static_cast<size_t>(omp_get_num_threads());
+        size_t t = static_cast<size_t>(omp_get_thread_num());
+        size_t base = n / threads, extra = n % threads;
+        lo = t * base + std::min(t, extra);
+        hi = lo + base + (t < extra ? 1 : 0);
+    }
+
+    void build(const std::vector<AirQualityRecord> &records)
+    {
+        size_t n = records.size();
+        dates.clear();
+        parameters.clear();
+        sites.clear();
+        siteCodes.clear();
+        parameterCodes.clear();
+
+        // Dictionaries are built serially; the codes go to scratch arrays
+        // so the column arrays are first written by their scanning threads
+        std::vector<uint16_t> dateCode(n), parameterCode(n);
+        std::vector<uint32_t> siteCode(n);
+        std::unordered_map<std::string, uint16_t> dateCodes;
+        for (size_t i = 0; i < n; i++)
+        {
+            const AirQualityRecord &record = records[i];
+            auto d = dateCodes.emplace(record.datetime.substr(0, 10), static_cast<uint16_t>(dates.size()));
+            if (d.second)
+                dates.push_back(d.first->first);
+            dateCode[i] = d.first->second;
+
+            auto p = parameterCodes.emplace(record.parameter, static_cast<uint16_t>(parameters.size()));
+            if (p.second)
+                parameters.push_back(record.parameter);
+            parameterCode[i] = p.first->second;
+
+            auto st = siteCodes.emplace(record.fullSiteId, static_cast<uint32_t>(sites.size()));
+            if (st.second)
+                sites.push_back(record.fullSiteId);
+            siteCode[i] = st.first->second;
+        }
+
+        // Renumber dates in sorted order so ranges map to code ranges
+        std::vector<uint16_t> order(dates.size());
+        for (size_t i = 0; i < order.size(); i++)
+            order[i] = static_cast<uint16_t>(i);
+        std::sort(order.begin(), order.end(), [this](uint16_t a, uint16_t b) { return dates[a] < dates[b]; });
+        std::vector<uint16_t> rank(dates.size());
+        std::vector<std::string> sorted(dates.size());
+        for (size_t i = 0; i < order.size(); i++)
+        {
+            rank[order[i]] = static_cast<uint16_t>(i);
+            sorted[i] = dates[order[i]];
+        }
+        dates.swap(sorted);
+
+        // Fresh arrays with no pages yet (resize() would keep old ones)
+        date = Array<uint16_t>();
+        parameter = Array<uint16_t>();
+        site = Array<uint32_t>();
+        aqi = Array<int32_t>();
+        value = Array<double>();
+        date.resize(n);
+        parameter.resize(n);
+        site.resize(n);
+        aqi.resize(n);
+        value.resize(n);
+#pragma omp parallel
+        {
+            TraceScope trace("place columns", "query");
+            size_t lo, hi;
+            rowBlock(n, lo, hi);
+            if (lo < hi)
+            {
+                NumaTopology::bindToCurrentNode(&date[lo], (hi - lo) * sizeof(uint16_t));
+                NumaTopology::bindToCurrentNode(&parameter[lo], (hi - lo) * sizeof(uint16_t));
+                NumaTopology::bindToCurrentNode(&site[lo], (hi - lo) * sizeof(uint32_t));
+                NumaTopology::bindToCurrentNode(&aqi[lo], (hi - lo) * sizeof(int32_t));
+                NumaTopology::bindToCurrentNode(&value[lo], (hi - lo) * sizeof(double));
+            }
+            for (size_t i = lo; i < hi; i++)
+            {
+                date[i] = rank[dateCode[i]];
+                parameter[i] = parameterCode[i];
+                site[i] = siteCode[i];
+                aqi[i] = records[i].aqi;
+                value[i] = records[i].value;
+            }
+        }
+        usable = dates.size() <= 0xFFFF && parameters.size() <= 0xFFFF;
+    }
+
+    void clear()
+    {
+        *this = KernelColumns();
+    }
+
+    // Bytes in the column arrays, and how many of them are on huge pages
+    struct PageStats
+    {
+        size_t bytes = 0;
+        size_t hugeBytes = 0;
+    };
+
+    PageStats pageStats() const
+    {
+        PageStats stats;
+        auto add = [&stats](const void *data, size_t bytes)
+        {
+            stats.bytes += bytes;
+            if (bytes > 0)
+                stats.hugeBytes += HugePages::hugeBytes(data, bytes);
+        };
+        add(date.data(), date.size() * sizeof(uint16_t));
+        add(parameter.data(), parameter.size() * sizeof(uint16_t));
+        add(site.data(), site.size() * sizeof(uint32_t));
+        add(aqi.data(), aqi.size() * sizeof(int32_t));
+        add(value.data(), value.size() * sizeof(double));
+        return stats;
+    }
+
+    // Codes in [lowerCode(v), upperCode(v)) are the dates equal to v
+    int32_t lowerCode(const std::string &v) const
+    {
+        return static_cast<int32_t>(std::lower_bound(dates.begin(), dates.end(), v) - dates.begin());
+    }
+
+    int32_t upperCode(const std::string &v) const
+    {
+        return static_cast<int32_t>(std::upper_bound(dates.begin(), dates.end(), v) - dates.begin());
+    }
+};
+
+struct KernelParams
+{
+    enum Filter
+    {
+        DATE_RANGE = 1,
+        PARAMETER_EQ = 2,
+        SITE_EQ = 4,        // fullSiteId
+        AQI_RANGE = 8,
+        VALUE_RANGE = 16
+    };
+
+    enum Stats
+    {
+        AQI_STATS = 1,
+        VALUE_STATS = 2
+    };
+
+    unsigned filters = 0;
+    unsigned stats = 0;
+
+    // Inclusive date code range; empty when low > high
+    int32_t dateLow = 0;
+    int32_t dateHigh = std::numeric_limits<int32_t>::max();
+
+    // Dictionary codes; -1 for a value that never occurs
+    int64_t parameter = -1;
+    int64_t site = -1;
+
+    // Inclusive; strict comparisons are moved to the next representable double
+    double aqiLow = -std::numeric_limits<double>::infinity();
+    double aqiHigh = std::numeric_limits<double>::infinity();
+    double valueLow = -std::numeric_limits<double>::infinity();
+    double valueHigh = std::numeric_limits<double>::infinity();
+};
+
+// Index 0 is AQI, 1 is value
+struct KernelStats
+{
+    uint64_t count = 0;
+    double sum[2] = {0.0, 0.0};
+    double min[2] = {std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity()};
+    double max[2] = {-std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity()};
+
+    void merge(const KernelStats &other)
+    {
+        count += other.count;
+        for (int i = 0; i < 2; i++)
+        {
+            sum[i] += other.sum[i];
+            min[i] = std::min(min[i], other.min[i]);
+            max[i] = std::max(max[i], other.max[i]);
+        }
+    }
+};
+
+class QueryKernels
+{
+public:
+    // 5 filter bits x 2 stats bits
+    static const unsigned kVariants = 32 * 4;
+
+    // Scan the given rows (all records if rowIds is null) on the OpenMP team
+    static KernelStats run(const KernelParams &params, const KernelColumns &columns,
+                           const uint32_t *rowIds, size_t count)
+    {
+        static const std::array<Kernel, kVariants> table = makeTable(std::make_index_sequence<kVariants>());
+        Kernel kernel = table[(params.filters & 31) | ((params.stats & 3) << 5)];
+
+        std::vector<KernelStats> local(omp_get_max_threads());
+#pragma omp parallel
+        {
+            TraceScope scanTrace("scan (kernel)", "query");
+            kernel(columns, rowIds, count, params, local[omp_get_thread_num()]);
+        }
+
+        KernelStats total;
+        for (const KernelStats &stats : local)
+            total.merge(stats);
+        return total;
+    }
+
+    // Runtime form of the specialised filters, for the grouped path
+    static bool matches(const KernelParams &p, const KernelColumns &c, size_t i)
+    {
+        if ((p.filters & KernelParams::DATE_RANGE) && (c.date[i] < p.dateLow || c.date[i] > p.dateHigh))
+            return false;
+        if ((p.filters & KernelParams::PARAMETER_EQ) && c.parameter[i] != p.parameter)
+            return false;
+        if ((p.filters & KernelParams::SITE_EQ) && c.site[i] != p.site)
+            return false;
+        if ((p.filters & KernelParams::AQI_RANGE) && (c.aqi[i] < p.aqiLow || c.aqi[i] > p.aqiHigh))
+            return false;
+        if ((p.filters & KernelParams::VALUE_RANGE) && (c.value[i] < p.valueLow || c.value[i] > p.valueHigh))
+            return false;
+        return true;
+    }
+
+    // Short description of a variant, e.g. "date+parameter -> aqi"
+    static std::string describe(const KernelParams &params)
+    {
+        static const char *filterNames[] = {"date", "parameter", "site", "aqi", "value"};
+        std::string text;
+        for (int bit = 0; bit < 5; bit++)
+        {
+            if (params.filters & (1u << bit))
+                text += std::string(text.empty() ? "" : "+") + filterNames[bit];
+        }
+        text += text.empty() ? "all -> " : " -> ";
+        if (params.stats == 0)
+            text += "count";
+        else
+            text += std::string(params.stats & KernelParams::AQI_STATS ? "aqi" : "") +
+                    (params.stats == 3 ? "," : "") + (params.stats & KernelParams::VALUE_STATS ? "value" : "");
+        return text;
+    }
+
+private:
+    typedef void (*Kernel)(const KernelColumns &, const uint32_t *, size_t,
+                           const KernelParams &, KernelStats &);
+
+    template <size_t... Variant>
+    static std::array<Kernel, sizeof...(Variant)> makeTable(std::index_sequence<Variant...>)
+    {
+        return {{&kernel<Variant>...}};
+    }
+
+    template <unsigned Filters>
+    static bool accept(const KernelColumns &c, size_t i, const KernelParams &p)
+    {
+        bool pass = true;
+        if constexpr ((Filters & KernelParams::DATE_RANGE) != 0)
+            pass &= (c.date[i] >= p.dateLow) & (c.date[i] <= p.dateHigh);
+        if constexpr ((Filters & KernelParams::PARAMETER_EQ) != 0)
+            pass &= c.parameter[i] == p.parameter;
+        if constexpr ((Filters & KernelParams::SITE_EQ) != 0)
+            pass &= c.site[i] == p.site;
+        if constexpr ((Filters & KernelParams::AQI_RANGE) != 0)
+        {
+            double aqi = c.aqi[i];
+            pass &= (aqi >= p.aqiLow) & (aqi <= p.aqiHigh);
+        }
+        if constexpr ((Filters & KernelParams::VALUE_RANGE) != 0)
+            pass &= (c.value[i] >= p.valueLow) & (c.value[i] <= p.valueHigh);
+        return pass;
+    }
+
+    static void fold(KernelStats &s, int slot, bool pass, double v)
+    {
+        s.sum[slot] += pass ? v : 0.0;
+        s.min[slot] = std::min(s.min[slot], pass ? v : std::numeric_limits<double>::infinity());
+        s.max[slot] = std::max(s.max[slot], pass ? v : -std::numeric_limits<double>::infinity());
+    }
+
+    template <unsigned Filters, unsigned Stats>
+    static void step(KernelStats &s, const KernelColumns &c, size_t i, const KernelParams &p)
+    {
+        bool pass = accept<Filters>(c, i, p);
+        s.count += pass;
+        if constexpr ((Stats & KernelParams::AQI_STATS) != 0)
+            fold(s, 0, pass, c.aqi[i]);
+        if constexpr ((Stats & KernelParams::VALUE_STATS) != 0)
+            fold(s, 1, pass, c.value[i]);
+    }
+
+    // Called by every thread of the team in run(); each scans its rowBlock,
+    // the rows it placed in KernelColumns::build
+    template <size_t Variant>
+    static void kernel(const KernelColumns &columns, const uint32_t *rowIds, size_t count,
+                       const KernelParams &params, KernelStats &out)
+    {
+        constexpr unsigned Filters = Variant & 31;
+        constexpr unsigned Stats = Variant >> 5;
+        KernelStats s;
+        size_t lo, hi;
+        KernelColumns::rowBlock(count, lo, hi);
+
+        if (rowIds != nullptr)
+        {
+            for (size_t i = lo; i < hi; i++)
+                step<Filters, Stats>(s, columns, rowIds[i], params);
+        }
+        else
+        {
+            for (size_t i = lo; i < hi; i++)
+                step<Filters, Stats>(s, columns, i, params);
+        }
+        out = s;
+    }
+};
+
+#endif // FIRE_KERNELS_H
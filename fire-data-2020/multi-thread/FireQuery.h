@@ -0,0 +1,1206 @@
+#ifndef FIRE_QUERY_H
+#define FIRE_QUERY_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "omp.h"
+#include "AirQualityRecord.h"
+#include "FireKernels.h"
+#include "ParallelGroupBy.h"
+#include "RoaringBitmap.h"
+#include "Metrics.h"
+#include "Trace.h"
+
+// Composable queries over the loaded AirQualityRecord rows: typed
+// predicates on any column, group-by and aggregates, run as one fused
+// parallel filter + aggregate pass.
+//
+//   Query q;
+//   q.where(Predicate::eq(Column::PARAMETER, "PM2.5"))
+//    .where(Predicate::gt(Column::AQI, 150))
+//    .where(Predicate::between(Column::DATE, "2020-09-08", "2020-09-15"))
+//    .groupBy(Column::FULL_SITE_ID)
+//    .aggregate(Aggregate::MAX, Column::AQI)
+//    .orderBy(0)
+//    .limit(10);
+//   QueryResult result = analyzer.query(q);
+//
+// Predicates on DATE, PARAMETER, AQI_CATEGORY and AGENCY are answered
+// from bitmap indexes (AND across predicates, OR across matching values),
+// so only matching rows are gathered and scanned; everything else is
+// checked per row. Ungrouped or single-indexed-column COUNT queries with
+// only indexed predicates come straight from bitmap cardinalities.
+// Ungrouped queries whose remaining predicates and aggregates fit one of
+// the compiled kernels in FireKernels.h skip the interpreter entirely.
+// AQI -999 marks a missing reading and is not filtered implicitly.
+
+enum class Column
+{
+    LATITUDE,
+    LONGITUDE,
+    DATETIME,
+    DATE,           // first 10 characters of datetime (YYYY-MM-DD)
+    PARAMETER,
+    VALUE,
+    UNIT,
+    RAW_CONCENTRATION,
+    AQI,
+    AQI_CATEGORY,
+    SITE_NAME,
+    AGENCY,
+    SITE_ID,
+    FULL_SITE_ID
+};
+
+inline const char *columnName(Column column)
+{
+    static const char *names[] = {
+        "latitude", "longitude", "datetime", "date", "parameter", "value", "unit",
+        "rawConcentration", "aqi", "aqiCategory", "siteName", "agencyName", "siteId", "fullSiteId"};
+    return names[static_cast<int>(column)];
+}
+
+inline bool isNumeric(Column column)
+{
+    switch (column)
+    {
+    case Column::LATITUDE:
+    case Column::LONGITUDE:
+    case Column::VALUE:
+    case Column::RAW_CONCENTRATION:
+    case Column::AQI:
+    case Column::AQI_CATEGORY:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// One comparison against a column. Text columns compare lexicographically,
+// which orders ISO dates and datetimes correctly.
+struct Predicate
+{
+    enum Op
+    {
+        EQ,
+        NE,
+        LT,
+        LE,
+        GT,
+        GE,
+        BETWEEN,    // inclusive on both ends
+        IN
+    };
+
+    Column column;
+    Op op;
+    double low = 0.0;
+    double high = 0.0;
+    std::string textLow;
+    std::string textHigh;
+    std::vector<double> numbers;    // IN operands
+    std::vector<std::string> texts;
+
+    static Predicate eq(Column c, double v) { return number(c, EQ, v, v); }
+    static Predicate ne(Column c, double v) { return number(c, NE, v, v); }
+    static Predicate lt(Column c, double v) { return number(c, LT, v, v); }
+    static Predicate le(Column c, double v) { return number(c, LE, v, v); }
+    static Predicate gt(Column c, double v) { return number(c, GT, v, v); }
+    static Predicate ge(Column c, double v) { return number(c, GE, v, v); }
+    static Predicate between(Column c, double lo, double hi) { return number(c, BETWEEN, lo, hi); }
+    static Predicate in(Column c, const std::vector<double> &values)
+    {
+        Predicate p = number(c, IN, 0.0, 0.0);
+        p.numbers = values;
+        return p;
+    }
+
+    static Predicate eq(Column c, const std::string &v) { return text(c, EQ, v, v); }
+    static Predicate ne(Column c, const std::string &v) { return text(c, NE, v, v); }
+    static Predicate lt(Column c, const std::string &v) { return text(c, LT, v, v); }
+    static Predicate le(Column c, const std::string &v) { return text(c, LE, v, v); }
+    static Predicate gt(Column c, const std::string &v) { return text(c, GT, v, v); }
+    static Predicate ge(Column c, const std::string &v) { return text(c, GE, v, v); }
+    static Predicate between(Column c, const std::string &lo, const std::string &hi) { return text(c, BETWEEN, lo, hi); }
+    static Predicate in(Column c, const std::vector<std::string> &values)
+    {
+        Predicate p = text(c, IN, "", "");
+        p.texts = values;
+        return p;
+    }
+
+    bool matches(const AirQualityRecord &record) const;  // defined after QueryEngine
+
+    bool matchesNumber(double v) const
+    {
+        switch (op)
+        {
+        case EQ: return v == low;
+        case NE: return v != low;
+        case LT: return v < low;
+        case LE: return v <= low;
+        case GT: return v > low;
+        case GE: return v >= low;
+        case BETWEEN: return v >= low && v <= high;
+        case IN: return std::find(numbers.begin(), numbers.end(), v) != numbers.end();
+        }
+        return false;
+    }
+
+    bool matchesText(std::string_view v) const
+    {
+        switch (op)
+        {
+        case EQ: return v == textLow;
+        case NE: return v != textLow;
+        case LT: return v < textLow;
+        case LE: return v <= textLow;
+        case GT: return v > textLow;
+        case GE: return v >= textLow;
+        case BETWEEN: return v >= textLow && v <= textHigh;
+        case IN: return std::find(texts.begin(), texts.end(), v) != texts.end();
+        }
+        return false;
+    }
+
+private:
+    static Predicate number(Column c, Op op, double lo, double hi)
+    {
+        if (!isNumeric(c))
+            throw std::invalid_argument(std::string("numeric predicate on text column ") + columnName(c));
+        Predicate p;
+        p.column = c;
+        p.op = op;
+        p.low = lo;
+        p.high = hi;
+        return p;
+    }
+
+    static Predicate text(Column c, Op op, const std::string &lo, const std::string &hi)
+    {
+        if (isNumeric(c))
+            throw std::invalid_argument(std::string("text predicate on numeric column ") + columnName(c));
+        Predicate p;
+        p.column = c;
+        p.op = op;
+        p.textLow = lo;
+        p.textHigh = hi;
+        return p;
+    }
+};
+
+struct Aggregate
+{
+    enum Function
+    {
+        COUNT,
+        SUM,
+        AVG,
+        MIN,
+        MAX
+    };
+
+    Function function;
+    Column column;
+
+    std::string label() const
+    {
+        static const char *names[] = {"count", "sum", "avg", "min", "max"};
+        if (function == COUNT)
+            return "count";
+        return std::string(names[function]) + "(" + columnName(column) + ")";
+    }
+};
+
+class Query
+{
+public:
+    std::vector<Predicate> predicates;  // all must hold
+    std::vector<Column> groupColumns;
+    std::vector<Aggregate> aggregates;  // COUNT if none are given
+    int orderAggregate = -1;            // -1: order by group key
+    bool descending = true;
+    size_t rowLimit = 0;                // 0: no limit
+
+    Query &where(const Predicate &predicate)
+    {
+        predicates.push_back(predicate);
+        return *this;
+    }
+
+    Query &groupBy(Column column)
+    {
+        groupColumns.push_back(column);
+        return *this;
+    }
+
+    Query &aggregate(Aggregate::Function function, Column column = Column::AQI)
+    {
+        if (function != Aggregate::COUNT && !isNumeric(column))
+            throw std::invalid_argument(std::string("cannot aggregate text column ") + columnName(column));
+        aggregates.push_back(Aggregate{function, column});
+        return *this;
+    }
+
+    // Sort groups by the value of aggregate index (checked against the
+    // aggregates when the query runs; throws std::invalid_argument)
+    Query &orderBy(int aggregateIndex, bool descendingOrder = true)
+    {
+        orderAggregate = aggregateIndex;
+        descending = descendingOrder;
+        return *this;
+    }
+
+    Query &limit(size_t rows)
+    {
+        rowLimit = rows;
+        return *this;
+    }
+
+    // Same text for queries that differ only in predicate order or in the
+    // order / repeats of IN operands; the key of the result cache
+    std::string normalizedKey() const
+    {
+        std::vector<std::string> terms;
+        for (const Predicate &p : predicates)
+        {
+            std::string term = std::string(columnName(p.column)) + " " + std::to_string(p.op);
+            if (p.op == Predicate::IN)
+            {
+                std::vector<std::string> operands(p.texts);
+                for (double v : p.numbers)
+                    operands.push_back(numberText(v));
+                std::sort(operands.begin(), operands.end());
+                operands.erase(std::unique(operands.begin(), operands.end()), operands.end());
+                for (const std::string &operand : operands)
+                    term += " " + std::to_string(operand.size()) + ":" + operand;
+            }
+            else if (isNumeric(p.column))
+            {
+                term += " " + numberText(p.low);
+                if (p.op == Predicate::BETWEEN)
+                    term += " " + numberText(p.high);
+            }
+            else
+            {
+                term += " " + std::to_string(p.textLow.size()) + ":" + p.textLow;
+                if (p.op == Predicate::BETWEEN)
+                    term += " " + std::to_string(p.textHigh.size()) + ":" + p.textHigh;
+            }
+            terms.push_back(term);
+        }
+        std::sort(terms.begin(), terms.end());
+
+        std::string key = "where";
+        for (const std::string &term : terms)
+            key += "(" + term + ")";
+        key += " group";
+        for (Column column : groupColumns)
+            key += " " + std::string(columnName(column));
+        key += " agg";
+        for (const Aggregate &aggregate : aggregates)
+            key += " " + aggregate.label();
+        key += " order " + std::to_string(orderAggregate) + (descending ? " desc" : " asc");
+        key += " limit " + std::to_string(rowLimit);
+        return key;
+    }
+
+    // Inclusive YYYY-MM-DD range that DATE / DATETIME predicates confine
+    // the matching rows to; ("", "\xff") when the query spans all dates
+    void dateBounds(std::string &first, std::string &last) const
+    {
+        first = "";
+        last = "\xff";
+        for (const Predicate &p : predicates)
+        {
+            if (p.column != Column::DATE && p.column != Column::DATETIME)
+                continue;
+            // A datetime bound confines the date to its first 10 characters
+            auto day = [](const std::string &text) { return text.substr(0, 10); };
+            std::string low = day(p.textLow);
+            std::string high = day(p.op == Predicate::BETWEEN ? p.textHigh : p.textLow);
+            if (p.op == Predicate::IN)
+            {
+                if (p.texts.empty())
+                    continue;
+                auto range = std::minmax_element(p.texts.begin(), p.texts.end());
+                low = day(*range.first);
+                high = day(*range.second);
+            }
+            switch (p.op)
+            {
+            case Predicate::EQ:
+            case Predicate::BETWEEN:
+            case Predicate::IN:
+                first = std::max(first, low);
+                last = std::min(last, high);
+                break;
+            case Predicate::LT:
+            case Predicate::LE:
+                last = std::min(last, high);
+                break;
+            case Predicate::GT:
+            case Predicate::GE:
+                first = std::max(first, low);
+                break;
+            default:
+                break;
+            }
+        }
+    }
+
+private:
+    static std::string numberText(double v)
+    {
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), "%.17g", v);
+        return buffer;
+    }
+};
+
+struct QueryResult
+{
+    struct Row
+    {
+        std::vector<std::string> key;   // one entry per group column
+        std::vector<double> values;     // one entry per aggregate
+        uint64_t count = 0;
+    };
+
+    std::vector<std::string> columns;   // group columns then aggregate labels
+    std::vector<Row> rows;
+    size_t rowsScanned = 0;
+    size_t rowsMatched = 0;
+    std::string plan;                   // index used, e.g. "date index (8 keys)"
+
+    void print(std::ostream &out, size_t maxRows = 20) const
+    {
+        for (const std::string &column : columns)
+            out << std::setw(18) << column << " ";
+        out << "\n";
+        for (size_t i = 0; i < rows.size() && i < maxRows; i++)
+        {
+            for (const std::string &key : rows[i].key)
+                out << std::setw(18) << key << " ";
+            for (double value : rows[i].values)
+                out << std::setw(18) << value << " ";
+            out << "\n";
+        }
+        if (rows.size() > maxRows)
+            out << "... " << rows.size() - maxRows << " more groups\n";
+        out << "(" << rowsMatched << " of " << rowsScanned << " scanned rows matched, plan: " << plan << ")"
+            << std::endl;
+    }
+};
+
+// One Roaring bitmap of row ids per distinct value of the low-cardinality
+// columns. Rows are appended as they are ingested, in increasing row id
+// order, so maintaining the index is an append per column.
+class BitmapIndex
+{
+private:
+    struct ColumnBitmaps
+    {
+        std::map<std::string, RoaringBitmap> values;    // ordered: date ranges
+        const std::string *lastKey = nullptr;           // consecutive rows usually repeat
+        RoaringBitmap *last = nullptr;
+
+        void add(uint32_t row, std::string_view key)
+        {
+            if (last == nullptr || key != *lastKey)
+            {
+                auto it = values.find(std::string(key));
+                if (it == values.end())
+                    it = values.emplace(std::string(key), RoaringBitmap()).first;
+                lastKey = &it->first;
+                last = &it->second;
+            }
+            last->add(row);
+        }
+    };
+
+    static const int kColumns = 4;
+    ColumnBitmaps columns[kColumns];
+    size_t rows = 0;
+
+    static int slot(Column column)
+    {
+        switch (column)
+        {
+        case Column::DATE: return 0;
+        case Column::PARAMETER: return 1;
+        case Column::AQI_CATEGORY: return 2;
+        case Column::AGENCY: return 3;
+        default: return -1;
+        }
+    }
+
+    static bool matchesKey(const Predicate &p, const std::string &key)
+    {
+        return isNumeric(p.column) ? p.matchesNumber(std::atof(key.c_str())) : p.matchesText(key);
+    }
+
+public:
+    static bool covers(Column column) { return slot(column) >= 0; }
+
+    size_t indexedRows() const { return rows; }
+
+    void add(uint32_t row, const AirQualityRecord &record)
+    {
+        char category[16];
+        std::snprintf(category, sizeof(category), "%d", record.aqiCategory);
+        columns[0].add(row, std::string_view(record.datetime).substr(0, 10));
+        columns[1].add(row, record.parameter);
+        columns[2].add(row, category);
+        columns[3].add(row, record.agencyName);
+        rows = std::max(rows, static_cast<size_t>(row) + 1);
+    }
+
+    void clear()
+    {
+        for (ColumnBitmaps &c : columns)
+            c = ColumnBitmaps();
+        rows = 0;
+    }
+
+    // Value -> rows map of an indexed column, nullptr otherwise
+    const std::map<std::string, RoaringBitmap> *values(Column column) const
+    {
+        int i = slot(column);
+        return i >= 0 ? &columns[i].values : nullptr;
+    }
+
+    // Rows whose value satisfies the predicate (OR over the matching
+    // values); false if the column is not indexed
+    bool select(const Predicate &p, RoaringBitmap &out) const
+    {
+        const std::map<std::string, RoaringBitmap> *index = values(p.column);
+        if (index == nullptr)
+            return false;
+        out = RoaringBitmap();
+        for (const auto &entry : *index)
+        {
+            if (matchesKey(p, entry.first))
+                out = out.empty() ? entry.second : RoaringBitmap::unite(out, entry.second);
+        }
+        return true;
+    }
+
+    // Number of rows select() would return, from the value cardinalities
+    // without building the union; false if the column is not indexed
+    bool estimate(const Predicate &p, size_t &count) const
+    {
+        const std::map<std::string, RoaringBitmap> *index = values(p.column);
+        if (index == nullptr)
+            return false;
+        count = 0;
+        for (const auto &entry : *index)
+        {
+            if (matchesKey(p, entry.first))
+                count += entry.second.cardinality();
+        }
+        return true;
+    }
+
+    size_t memoryBytes() const
+    {
+        size_t bytes = 0;
+        for (const ColumnBitmaps &c : columns)
+        {
+            for (const auto &entry : c.values)
+                bytes += entry.first.capacity() + entry.second.memoryBytes();
+        }
+        return bytes;
+    }
+};
+
+// Executes queries against a record vector it does not own. Bitmap
+// indexes are appended to as rows arrive (indexNewRows); the kernel
+// columns are rebuilt on the first query after the records change.
+class QueryEngine
+{
+private:
+    struct AggregateState
+    {
+        double sum = 0.0;
+        double min = std::numeric_limits<double>::infinity();
+        double max = -std::numeric_limits<double>::infinity();
+        uint64_t count = 0;
+    };
+
+    struct GroupState
+    {
+        std::vector<std::string> key;
+        std::vector<AggregateState> aggregates;
+        uint64_t count = 0;
+    };
+
+    // Pushdown selectivity limit: a gathered row costs about twice a
+    // row of the sequential kernel scan
+    static const size_t kPushdownDivisor = 2;
+
+    const std::vector<AirQualityRecord> &records;
+    BitmapIndex bitmaps;
+    KernelColumns columns;
+    bool indexed = false;
+    bool kernelsEnabled = true;
+
+public:
+    static double numberOf(const AirQualityRecord &record, Column column)
+    {
+        switch (column)
+        {
+        case Column::LATITUDE: return record.latitude;
+        case Column::LONGITUDE: return record.longitude;
+        case Column::VALUE: return record.value;
+        case Column::RAW_CONCENTRATION: return record.rawConcentration;
+        case Column::AQI: return record.aqi;
+        case Column::AQI_CATEGORY: return record.aqiCategory;
+        default: return 0.0;
+        }
+    }
+
+    static std::string_view textOf(const AirQualityRecord &record, Column column)
+    {
+        switch (column)
+        {
+        case Column::DATETIME: return record.datetime;
+        case Column::DATE: return std::string_view(record.datetime).substr(0, 10);
+        case Column::PARAMETER: return record.parameter;
+        case Column::UNIT: return record.unit;
+        case Column::SITE_NAME: return record.siteName;
+        case Column::AGENCY: return record.agencyName;
+        case Column::SITE_ID: return record.siteId;
+        case Column::FULL_SITE_ID: return record.fullSiteId;
+        default: return std::string_view();
+        }
+    }
+
+private:
+
+    static std::string keyText(const AirQualityRecord &record, Column column)
+    {
+        if (!isNumeric(column))
+            return std::string(textOf(record, column));
+        // Shortest of %.15g/%.17g that reads back as the same double, so
+        // distinct values never share a group and keys stay readable
+        double v = numberOf(record, column);
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), "%.15g", v);
+        if (std::strtod(buffer, nullptr) != v)
+            std::snprintf(buffer, sizeof(buffer), "%.17g", v);
+        return buffer;
+    }
+
+    static bool numericRange(const Predicate &p, double &low, double &high)
+    {
+        switch (p.op)
+        {
+        case Predicate::EQ: low = high = p.low; return true;
+        case Predicate::LT: high = std::nextafter(p.low, -std::numeric_limits<double>::infinity()); return true;
+        case Predicate::LE: high = p.low; return true;
+        case Predicate::GT: low = std::nextafter(p.low, std::numeric_limits<double>::infinity()); return true;
+        case Predicate::GE: low = p.low; return true;
+        case Predicate::BETWEEN: low = p.low; high = p.high; return true;
+        default: return false;
+        }
+    }
+
+    bool dateRange(const Predicate &p, KernelParams &k) const
+    {
+        switch (p.op)
+        {
+        case Predicate::EQ:
+            k.dateLow = columns.lowerCode(p.textLow);
+            k.dateHigh = columns.upperCode(p.textLow) - 1;
+            return true;
+        case Predicate::LT: k.dateHigh = columns.lowerCode(p.textLow) - 1; return true;
+        case Predicate::LE: k.dateHigh = columns.upperCode(p.textLow) - 1; return true;
+        case Predicate::GT: k.dateLow = columns.upperCode(p.textLow); return true;
+        case Predicate::GE: k.dateLow = columns.lowerCode(p.textLow); return true;
+        case Predicate::BETWEEN:
+            k.dateLow = columns.lowerCode(p.textLow);
+            k.dateHigh = columns.upperCode(p.textHigh) - 1;
+            return true;
+        default: return false;
+        }
+    }
+
+    // Map the predicates left after pushdown onto kernel filters; false for
+    // shapes the kernels do not cover (NE / IN, other columns, two
+    // predicates on one column, aggregates of other columns)
+    bool compileKernel(const std::vector<const Predicate *> &residual,
+                       const std::vector<Aggregate> &aggregates, KernelParams &k) const
+    {
+        if (!indexed || !columns.usable)
+            return false;
+        for (const Predicate *p : residual)
+        {
+            unsigned bit = 0;
+            bool ok = false;
+            switch (p->column)
+            {
+            case Column::DATE:
+                bit = KernelParams::DATE_RANGE;
+                ok = dateRange(*p, k);
+                break;
+            case Column::PARAMETER:
+                bit = KernelParams::PARAMETER_EQ;
+                ok = p->op == Predicate::EQ;
+                if (columns.parameterCodes.count(p->textLow))
+                    k.parameter = columns.parameterCodes.at(p->textLow);
+                break;
+            case Column::FULL_SITE_ID:
+                bit = KernelParams::SITE_EQ;
+                ok = p->op == Predicate::EQ;
+                if (columns.siteCodes.count(p->textLow))
+                    k.site = columns.siteCodes.at(p->textLow);
+                break;
+            case Column::AQI:
+                bit = KernelParams::AQI_RANGE;
+                ok = numericRange(*p, k.aqiLow, k.aqiHigh);
+                break;
+            case Column::VALUE:
+                bit = KernelParams::VALUE_RANGE;
+                ok = numericRange(*p, k.valueLow, k.valueHigh);
+                break;
+            default:
+                break;
+            }
+            if (!ok || (k.filters & bit))
+                return false;
+            k.filters |= bit;
+        }
+        for (const Aggregate &aggregate : aggregates)
+        {
+            if (aggregate.function == Aggregate::COUNT)
+                continue;
+            if (aggregate.column == Column::AQI)
+                k.stats |= KernelParams::AQI_STATS;
+            else if (aggregate.column == Column::VALUE)
+                k.stats |= KernelParams::VALUE_STATS;
+            else
+                return false;
+        }
+        return true;
+    }
+
+    // Bit offset of a group column in the packed group-by key, -1 if it has
+    // no dictionary code
+    static int keyShift(Column column)
+    {
+        switch (column)
+        {
+        case Column::DATE: return 48;
+        case Column::PARAMETER: return 32;
+        case Column::FULL_SITE_ID: return 0;
+        default: return -1;
+        }
+    }
+
+    // Group columns that fit the packed key: coded columns, each at most once
+    static bool packableGroups(const std::vector<Column> &groupColumns)
+    {
+        unsigned seen = 0;
+        for (Column column : groupColumns)
+        {
+            int shift = keyShift(column);
+            if (shift < 0 || (seen & (1u << (shift / 16))))
+                return false;
+            seen |= 1u << (shift / 16);
+        }
+        return true;
+    }
+
+    std::string codeText(Column column, uint64_t code) const
+    {
+        switch (column)
+        {
+        case Column::DATE: return columns.dates[code];
+        case Column::PARAMETER: return columns.parameters[code];
+        default: return columns.sites[code];
+        }
+    }
+
+public:
+    explicit QueryEngine(const std::vector<AirQualityRecord> &rows) : records(rows) {}
+
+    // Dictionary-encoded columns; valid after buildIndexes()
+    const KernelColumns &getColumns() const { return columns; }
+
+    bool hasIndexes() const { return indexed; }
+
+    // Off: every query goes through the interpreted scan (for comparisons)
+    void setKernelsEnabled(bool enabled) { kernelsEnabled = enabled; }
+
+    // Append rows added since the last call to the bitmap indexes. Called
+    // for every merged row at ingest; not thread-safe.
+    void indexNewRows()
+    {
+        for (size_t i = bitmaps.indexedRows(); i < records.size(); i++)
+            bitmaps.add(static_cast<uint32_t>(i), records[i]);
+    }
+
+    const BitmapIndex &getBitmapIndex() const { return bitmaps; }
+
+    void buildIndexes()
+    {
+        METRICS_SCOPED_TIMER("fire_index_build_seconds");
+        TraceScope trace("buildIndexes", "query");
+        indexNewRows();
+        columns.build(records);
+        indexed = true;
+    }
+
+    // The records changed: drop the kernel columns (bitmaps stay valid
+    // while records are only appended)
+    void dropIndexes()
+    {
+        columns.clear();
+        indexed = false;
+    }
+
+    // The records were replaced, not appended to: drop the bitmaps as well
+    void resetIndexes()
+    {
+        dropIndexes();
+        bitmaps.clear();
+    }
+
+    QueryResult execute(const Query &query) const
+    {
+        METRICS_SCOPED_TIMER("fire_query_seconds{query=\"engine\"}");
+        TraceScope trace("execute", "query");
+
+        std::vector<Aggregate> aggregates = query.aggregates;
+        if (aggregates.empty())
+            aggregates.push_back(Aggregate{Aggregate::COUNT, Column::AQI});
+
+        bool countOnly = std::all_of(aggregates.begin(), aggregates.end(),
+                                     [](const Aggregate &a) { return a.function == Aggregate::COUNT; });
+        const std::map<std::string, RoaringBitmap> *groupBitmaps =
+            query.groupColumns.size() == 1 ? bitmaps.values(query.groupColumns[0]) : nullptr;
+
+        // Estimated rows per indexed predicate from the bitmap cardinalities
+        std::vector<size_t> estimates(query.predicates.size(), 0);
+        std::vector<size_t> indexedPredicates;
+        for (size_t i = 0; indexed && i < query.predicates.size(); i++)
+        {
+            if (bitmaps.estimate(query.predicates[i], estimates[i]))
+                indexedPredicates.push_back(i);
+        }
+        // Counts can come from cardinalities alone when every predicate
+        // has bitmaps; then all of them are pushed down whatever they select
+        bool bitmapCounts = indexed && indexedPredicates.size() == query.predicates.size() && countOnly &&
+                            (query.groupColumns.empty() || groupBitmaps != nullptr);
+
+        // Predicate pushdown: selective indexed predicates become bitmaps,
+        // and their intersection is the set of rows to scan. Taken from the
+        // most selective, a predicate is pushed if it selects at most
+        // 1 / kPushdownDivisor of the rows, or if the intersection needs it
+        // to get there (estimated as independent). The rest stay residual
+        // for the compiled scan: a union over many values plus a row-id
+        // gather costs more than checking them in a sequential scan.
+        std::vector<bool> push(query.predicates.size(), bitmapCounts);
+        if (!bitmapCounts)
+        {
+            std::sort(indexedPredicates.begin(), indexedPredicates.end(),
+                      [&estimates](size_t a, size_t b) { return estimates[a] < estimates[b]; });
+            double rows = static_cast<double>(std::max<size_t>(1, records.size()));
+            double limit = rows / kPushdownDivisor;
+            double combined = rows;
+            size_t pushCount = 0;
+            for (size_t k = 0; k < indexedPredicates.size(); k++)
+            {
+                bool selective = estimates[indexedPredicates[k]] <= limit;
+                if (!selective && combined <= limit)
+                    break;
+                combined *= estimates[indexedPredicates[k]] / rows;
+                if (selective || combined <= limit)
+                    pushCount = k + 1;
+            }
+            for (size_t k = 0; k < pushCount; k++)
+                push[indexedPredicates[k]] = true;
+        }
+
+        QueryResult result;
+        result.plan = "full scan";
+        std::vector<const Predicate *> residual;
+        RoaringBitmap selection;
+        bool pushed = false;
+        std::string pushedColumns;
+        for (size_t i = 0; i < query.predicates.size(); i++)
+        {
+            const Predicate &p = query.predicates[i];
+            RoaringBitmap rows;
+            if (!push[i] || !bitmaps.select(p, rows))
+            {
+                residual.push_back(&p);
+                continue;
+            }
+            selection = pushed ? RoaringBitmap::intersect(selection, rows) : std::move(rows);
+            pushedColumns += std::string(pushed ? " & " : "") + columnName(p.column);
+            pushed = true;
+        }
+        if (pushed)
+            result.plan = "bitmap " + pushedColumns;
+
+        std::unordered_map<std::string, GroupState> merged;
+        size_t matched = 0;
+
+        // Counts from bitmap cardinalities alone, no rows touched
+        if (bitmapCounts)
+        {
+            result.plan = pushed ? result.plan + ", bitmap counts" : "bitmap counts";
+            if (query.groupColumns.empty())
+            {
+                GroupState state;
+                state.count = pushed ? selection.cardinality() : records.size();
+                state.aggregates.resize(aggregates.size());
+                matched = state.count;
+                merged.emplace("", std::move(state));
+            }
+            else
+            {
+                for (const auto &entry : *groupBitmaps)
+                {
+                    GroupState state;
+                    state.count = pushed ? RoaringBitmap::intersectCount(selection, entry.second)
+                                         : entry.second.cardinality();
+                    if (state.count == 0)
+                        continue;
+                    state.key.push_back(entry.first);
+                    state.aggregates.resize(aggregates.size());
+                    matched += state.count;
+                    merged.emplace(entry.first, std::move(state));
+                }
+            }
+            return finish(query, aggregates, merged, 0, matched, std::move(result));
+        }
+
+        // Gather the selected row ids (ascending) so the scan splits evenly
+        std::vector<uint32_t> rowIds;
+        if (pushed)
+            selection.toVector(rowIds);
+        size_t scanCount = pushed ? rowIds.size() : records.size();
+
+        KernelParams kernelParams;
+        bool compiled = kernelsEnabled && compileKernel(residual, aggregates, kernelParams);
+        if (compiled && !query.groupColumns.empty() && packableGroups(query.groupColumns))
+        {
+            // Group by dictionary codes: radix-partitioned parallel hash
+            // aggregation on a packed 64-bit key
+            const KernelColumns &c = columns;
+            auto grouped = [&query](Column column)
+            { return std::find(query.groupColumns.begin(), query.groupColumns.end(), column) != query.groupColumns.end(); };
+            bool byDate = grouped(Column::DATE);
+            bool byParameter = grouped(Column::PARAMETER);
+            bool bySite = grouped(Column::FULL_SITE_ID);
+            auto groups = ParallelGroupBy<KernelStats>::run(
+                scanCount, pushed ? rowIds.data() : nullptr,
+                [&](size_t i)
+                {
+                    return (byDate ? uint64_t(c.date[i]) << 48 : 0) | (byParameter ? uint64_t(c.parameter[i]) << 32 : 0) |
+                           (bySite ? uint64_t(c.site[i]) : 0);
+                },
+                [&](size_t i) { return QueryKernels::matches(kernelParams, c, i); },
+                [&](KernelStats &s, size_t i)
+                {
+                    s.count++;
+                    double aqi = c.aqi[i];
+                    s.sum[0] += aqi;
+                    s.min[0] = std::min(s.min[0], aqi);
+                    s.max[0] = std::max(s.max[0], aqi);
+                    s.sum[1] += c.value[i];
+                    s.min[1] = std::min(s.min[1], c.value[i]);
+                    s.max[1] = std::max(s.max[1], c.value[i]);
+                });
+            result.plan += ", parallel group-by (" + std::to_string(groups.size()) + " groups)";
+
+            for (auto &group : groups)
+            {
+                GroupState state;
+                std::string key;
+                for (Column column : query.groupColumns)
+                {
+                    int shift = keyShift(column);
+                    uint64_t code = (group.key >> shift) & (shift == 0 ? 0xFFFFFFFFULL : 0xFFFFULL);
+                    state.key.push_back(codeText(column, code));
+                    key += state.key.back();
+                    key += '\x1f';
+                }
+                state.count = group.state.count;
+                for (const Aggregate &aggregate : aggregates)
+                {
+                    int slot = aggregate.column == Column::AQI ? 0 : 1;
+                    AggregateState a;
+                    a.sum = group.state.sum[slot];
+                    a.min = group.state.min[slot];
+                    a.max = group.state.max[slot];
+                    a.count = group.state.count;
+                    state.aggregates.push_back(a);
+                }
+                matched += state.count;
+                merged.emplace(std::move(key), std::move(state));
+            }
+        }
+        else if (compiled && query.groupColumns.empty())
+        {
+            KernelStats stats = QueryKernels::run(kernelParams, columns, pushed ? rowIds.data() : nullptr, scanCount);
+            result.plan += ", kernel " + QueryKernels::describe(kernelParams);
+            matched = stats.count;
+
+            GroupState state;
+            state.count = stats.count;
+            state.aggregates.resize(aggregates.size());
+            for (size_t a = 0; a < aggregates.size(); a++)
+            {
+                int slot = aggregates[a].column == Column::AQI ? 0 : 1;
+                state.aggregates[a].sum = stats.sum[slot];
+                state.aggregates[a].min = stats.min[slot];
+                state.aggregates[a].max = stats.max[slot];
+                state.aggregates[a].count = stats.count;
+            }
+            if (stats.count > 0)
+                merged.emplace("", std::move(state));
+        }
+        else
+        {
+            // Fused filter + aggregate: each thread folds its rows into a
+            // private group table, merged once at the end
+            int nThreads = omp_get_max_threads();
+            std::vector<std::unordered_map<std::string, GroupState>> localGroups(nThreads);
+
+#pragma omp parallel reduction(+:matched)
+            {
+                auto &groups = localGroups[omp_get_thread_num()];
+                TraceScope scanTrace("scan", "query");
+                std::string key;
+
+#pragma omp for nowait
+                for (long long n = 0; n < static_cast<long long>(scanCount); n++)
+                {
+                    const AirQualityRecord &record = records[pushed ? rowIds[n] : n];
+                    bool pass = true;
+                    for (const Predicate *p : residual)
+                    {
+                        if (!p->matches(record))
+                        {
+                            pass = false;
+                            break;
+                        }
+                    }
+                    if (!pass)
+                        continue;
+                    matched++;
+
+                    key.clear();
+                    for (Column column : query.groupColumns)
+                    {
+                        key += keyText(record, column);
+                        key += '\x1f';
+                    }
+                    auto it = groups.find(key);
+                    if (it == groups.end())
+                    {
+                        GroupState state;
+                        for (Column column : query.groupColumns)
+                            state.key.push_back(keyText(record, column));
+                        state.aggregates.resize(aggregates.size());
+                        it = groups.emplace(key, std::move(state)).first;
+                    }
+
+                    GroupState &group = it->second;
+                    group.count++;
+                    for (size_t a = 0; a < aggregates.size(); a++)
+                    {
+                        if (aggregates[a].function == Aggregate::COUNT)
+                            continue;
+                        double v = numberOf(record, aggregates[a].column);
+                        AggregateState &s = group.aggregates[a];
+                        s.sum += v;
+                        s.min = std::min(s.min, v);
+                        s.max = std::max(s.max, v);
+                        s.count++;
+                    }
+                }
+            }
+
+            for (auto &groups : localGroups)
+            {
+                for (auto &entry : groups)
+                {
+                    auto it = merged.find(entry.first);
+                    if (it == merged.end())
+                    {
+                        merged.emplace(entry.first, std::move(entry.second));
+                        continue;
+                    }
+                    GroupState &into = it->second;
+                    into.count += entry.second.count;
+                    for (size_t a = 0; a < aggregates.size(); a++)
+                    {
+                        const AggregateState &from = entry.second.aggregates[a];
+                        into.aggregates[a].sum += from.sum;
+                        into.aggregates[a].min = std::min(into.aggregates[a].min, from.min);
+                        into.aggregates[a].max = std::max(into.aggregates[a].max, from.max);
+                        into.aggregates[a].count += from.count;
+                    }
+                }
+            }
+        }
+
+        trace.setArg("scanned", scanCount);
+        return finish(query, aggregates, merged, scanCount, matched, std::move(result));
+    }
+
+    // query run over a subset of the rows, in a form mergePartials() can
+    // combine: unordered, unlimited, and AVG carried as SUM (divided by
+    // the group's row count once merged)
+    static Query partialQuery(const Query &query)
+    {
+        Query partial = query;
+        partial.orderAggregate = -1;
+        partial.rowLimit = 0;
+        for (Aggregate &aggregate : partial.aggregates)
+            if (aggregate.function == Aggregate::AVG)
+                aggregate.function = Aggregate::SUM;
+        return partial;
+    }
+
+    // Combine the results of partialQuery(query) over disjoint row sets
+    // into the result of query over all of them
+    static QueryResult mergePartials(const Query &query, const std::vector<QueryResult> &partials)
+    {
+        std::vector<Aggregate> aggregates = query.aggregates;
+        if (aggregates.empty())
+            aggregates.push_back(Aggregate{Aggregate::COUNT, Column::AQI});
+
+        std::unordered_map<std::string, GroupState> merged;
+        size_t scanCount = 0;
+        size_t matched = 0;
+        for (const QueryResult &partial : partials)
+        {
+            scanCount += partial.rowsScanned;
+            matched += partial.rowsMatched;
+            for (const QueryResult::Row &row : partial.rows)
+            {
+                if (row.count == 0)
+                    continue;
+                std::string key;
+                for (const std::string &k : row.key)
+                    key += k + '\x1f';
+                GroupState &state = merged[key];
+                if (state.aggregates.empty())
+                {
+                    state.key = row.key;
+                    state.aggregates.resize(aggregates.size());
+                }
+                state.count += row.count;
+                for (size_t a = 0; a < aggregates.size(); a++)
+                {
+                    AggregateState &s = state.aggregates[a];
+                    s.sum += row.values[a];
+                    s.min = std::min(s.min, row.values[a]);
+                    s.max = std::max(s.max, row.values[a]);
+                    s.count += row.count;
+                }
+            }
+        }
+
+        QueryResult result;
+        result.plan = partials.empty() ? "full scan" : partials[0].plan;
+        // The partials already counted their rows in the metrics
+        result = finish(query, aggregates, merged, 0, 0, std::move(result));
+        result.rowsScanned = scanCount;
+        result.rowsMatched = matched;
+        return result;
+    }
+
+private:
+    // Turn the merged group states into ordered, limited result rows
+    static QueryResult finish(const Query &query, const std::vector<Aggregate> &aggregates,
+                              std::unordered_map<std::string, GroupState> &merged, size_t scanCount,
+                              size_t matched, QueryResult result)
+    {
+        // Every execution path ends here, so orderBy() is checked once
+        if (query.orderAggregate < -1 || query.orderAggregate >= static_cast<int>(aggregates.size()))
+            throw std::invalid_argument("order by aggregate " + std::to_string(query.orderAggregate) + " of " +
+                                        std::to_string(aggregates.size()));
+
+        for (Column column : query.groupColumns)
+            result.columns.push_back(columnName(column));
+        for (const Aggregate &aggregate : aggregates)
+            result.columns.push_back(aggregate.label());
+
+        // Without group columns an empty match still reports one row (count 0)
+        if (merged.empty() && query.groupColumns.empty())
+        {
+            GroupState empty;
+            empty.aggregates.resize(aggregates.size());
+            merged.emplace("", std::move(empty));
+        }
+
+        for (auto &entry : merged)
+        {
+            QueryResult::Row row;
+            row.key = std::move(entry.second.key);
+            row.count = entry.second.count;
+            for (size_t a = 0; a < aggregates.size(); a++)
+            {
+                const AggregateState &s = entry.second.aggregates[a];
+                double value = 0.0;
+                switch (aggregates[a].function)
+                {
+                case Aggregate::COUNT: value = static_cast<double>(row.count); break;
+                case Aggregate::SUM: value = s.sum; break;
+                case Aggregate::AVG: value = s.count > 0 ? s.sum / s.count : 0.0; break;
+                case Aggregate::MIN: value = s.count > 0 ? s.min : 0.0; break;
+                case Aggregate::MAX: value = s.count > 0 ? s.max : 0.0; break;
+                }
+                row.values.push_back(value);
+            }
+            result.rows.push_back(std::move(row));
+        }
+
+        int order = query.orderAggregate;
+        bool descending = query.descending;
+        std::sort(result.rows.begin(), result.rows.end(),
+                  [order, descending](const QueryResult::Row &a, const QueryResult::Row &b)
+                  {
+                      if (order >= 0 && a.values[order] != b.values[order])
+                          return descending ? a.values[order] > b.values[order] : a.values[order] < b.values[order];
+                      return a.key < b.key;
+                  });
+        if (query.rowLimit > 0 && result.rows.size() > query.rowLimit)
+            result.rows.resize(query.rowLimit);
+
+        result.rowsScanned = scanCount;
+        result.rowsMatched = matched;
+        METRICS_COUNTER_ADD("fire_query_rows_scanned_total", scanCount);
+        METRICS_COUNTER_ADD("fire_query_rows_matched_total", matched);
+        return result;
+    }
+};
+
+inline bool Predicate::matches(const AirQualityRecord &record) const
+{
+    if (isNumeric(column))
+        return matchesNumber(QueryEngine::numberOf(record, column));
+    return matchesText(QueryEngine::textOf(record, column));
+}
+
+#endif // FIRE_QUERY_H
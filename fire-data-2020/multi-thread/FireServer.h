@@ -0,0 +1,289 @@
+#ifndef FIRE_SERVER_H
+#define FIRE_SERVER_H
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "omp.h"
+#include "FireDataAnalyzer.h"
+#include "QueryServer.h"
+
+// Request / response bodies of the fire data server (framing in
+// common/QueryServer.h). Every opcode's body, in WireWriter terms:
+//
+//   PING              -> (empty)
+//   QUERY             query            -> result
+//   DAYS_ABOVE        i32 threshold    -> u32 n, n x str date
+//   AVERAGE_AQI       str date         -> f64
+//   RECORDS_FOR_DATE  str date, u32 max -> u32 total, u32 n, n x record
+//
+//   query:  u16 n, n x (u8 column, u8 op, operands), u8 n, n x u8 group column,
+//           u8 n, n x (u8 function, u8 column), i32 orderBy, u8 descending,
+//           u32 limit
+//   operands: f64 low, f64 high (numeric column) or str low, str high;
+//           for IN a u32 count then that many f64 / str
+//   result: u16 n, n x str column, u32 n, n x (u8 k, k x str key,
+//           u8 v, v x f64 value, u64 count), u64 scanned, u64 matched, str plan
+//   record: str datetime, str siteName, str parameter, f64 value, str unit, i32 aqi
+namespace FireProtocol
+{
+enum Op : uint16_t
+{
+    PING = 0,
+    QUERY = 1,
+    DAYS_ABOVE = 2,
+    AVERAGE_AQI = 3,
+    RECORDS_FOR_DATE = 4
+};
+
+inline void encodeQuery(const Query &query, WireWriter &out)
+{
+    out.u16(static_cast<uint16_t>(query.predicates.size()));
+    for (const Predicate &p : query.predicates)
+    {
+        out.u8(static_cast<uint8_t>(p.column));
+        out.u8(static_cast<uint8_t>(p.op));
+        bool numeric = isNumeric(p.column);
+        if (p.op == Predicate::IN)
+        {
+            out.u32(static_cast<uint32_t>(numeric ? p.numbers.size() : p.texts.size()));
+            for (double v : p.numbers)
+                out.f64(v);
+            for (const std::string &v : p.texts)
+                out.str(v);
+        }
+        else if (numeric)
+        {
+            out.f64(p.low);
+            out.f64(p.high);
+        }
+        else
+        {
+            out.str(p.textLow);
+            out.str(p.textHigh);
+        }
+    }
+    out.u8(static_cast<uint8_t>(query.groupColumns.size()));
+    for (Column column : query.groupColumns)
+        out.u8(static_cast<uint8_t>(column));
+    out.u8(static_cast<uint8_t>(query.aggregates.size()));
+    for (const Aggregate &aggregate : query.aggregates)
+    {
+        out.u8(static_cast<uint8_t>(aggregate.function));
+        out.u8(static_cast<uint8_t>(aggregate.column));
+    }
+    out.i32(query.orderAggregate);
+    out.u8(query.descending ? 1 : 0);
+    out.u32(static_cast<uint32_t>(query.rowLimit));
+}
+
+inline Column decodeColumn(WireReader &in)
+{
+    uint8_t column = in.u8();
+    if (column > static_cast<uint8_t>(Column::FULL_SITE_ID))
+        throw std::invalid_argument("unknown column " + std::to_string(column));
+    return static_cast<Column>(column);
+}
+
+// Goes through the Predicate / Query builders, so operand types are
+// checked exactly as for local queries
+inline Query decodeQuery(WireReader &in)
+{
+    Query query;
+    uint16_t predicates = in.u16();
+    for (uint16_t i = 0; i < predicates; i++)
+    {
+        Column column = decodeColumn(in);
+        uint8_t op = in.u8();
+        if (op > Predicate::IN)
+            throw std::invalid_argument("unknown operator " + std::to_string(op));
+        bool numeric = isNumeric(column);
+        if (op == Predicate::IN)
+        {
+            uint32_t n = in.u32();
+            if (numeric)
+            {
+                std::vector<double> values;
+                for (uint32_t k = 0; k < n; k++)
+                    values.push_back(in.f64());
+                query.where(Predicate::in(column, values));
+            }
+            else
+            {
+                std::vector<std::string> values;
+                for (uint32_t k = 0; k < n; k++)
+                    values.push_back(in.str());
+                query.where(Predicate::in(column, values));
+            }
+            continue;
+        }
+
+        Predicate p = numeric ? Predicate::between(column, 0.0, 0.0) : Predicate::between(column, "", "");
+        p.op = static_cast<Predicate::Op>(op);
+        if (numeric)
+        {
+            p.low = in.f64();
+            p.high = in.f64();
+        }
+        else
+        {
+            p.textLow = in.str();
+            p.textHigh = in.str();
+        }
+        query.where(p);
+    }
+
+    uint8_t groups = in.u8();
+    for (uint8_t i = 0; i < groups; i++)
+        query.groupBy(decodeColumn(in));
+    uint8_t aggregates = in.u8();
+    for (uint8_t i = 0; i < aggregates; i++)
+    {
+        uint8_t function = in.u8();
+        if (function > Aggregate::MAX)
+            throw std::invalid_argument("unknown aggregate " + std::to_string(function));
+        query.aggregate(static_cast<Aggregate::Function>(function), decodeColumn(in));
+    }
+    // Without aggregates the query counts, so index 0 is still valid
+    int32_t orderBy = in.i32();
+    if (orderBy < -1 || orderBy >= std::max<int32_t>(1, aggregates))
+        throw std::invalid_argument("order by aggregate " + std::to_string(orderBy) + " of " +
+                                    std::to_string(std::max<int32_t>(1, aggregates)));
+    bool descending = in.u8() != 0;
+    query.orderBy(orderBy, descending);
+    query.limit(in.u32());
+    return query;
+}
+
+inline void encodeResult(const QueryResult &result, WireWriter &out)
+{
+    out.u16(static_cast<uint16_t>(result.columns.size()));
+    for (const std::string &column : result.columns)
+        out.str(column);
+    out.u32(static_cast<uint32_t>(result.rows.size()));
+    for (const QueryResult::Row &row : result.rows)
+    {
+        out.u8(static_cast<uint8_t>(row.key.size()));
+        for (const std::string &key : row.key)
+            out.str(key);
+        out.u8(static_cast<uint8_t>(row.values.size()));
+        for (double value : row.values)
+            out.f64(value);
+        out.u64(row.count);
+    }
+    out.u64(result.rowsScanned);
+    out.u64(result.rowsMatched);
+    out.str(result.plan);
+}
+
+inline QueryResult decodeResult(WireReader &in)
+{
+    QueryResult result;
+    uint16_t columns = in.u16();
+    for (uint16_t i = 0; i < columns; i++)
+        result.columns.push_back(in.str());
+    uint32_t rows = in.u32();
+    result.rows.resize(rows);
+    for (QueryResult::Row &row : result.rows)
+    {
+        uint8_t keys = in.u8();
+        for (uint8_t k = 0; k < keys; k++)
+            row.key.push_back(in.str());
+        uint8_t values = in.u8();
+        for (uint8_t v = 0; v < values; v++)
+            row.values.push_back(in.f64());
+        row.count = in.u64();
+    }
+    result.rowsScanned = in.u64();
+    result.rowsMatched = in.u64();
+    result.plan = in.str();
+    return result;
+}
+} // namespace FireProtocol
+
+// Serves an analyzer's data over QueryServer. Queries run concurrently on
+// the server's workers, each with an OpenMP team of cores / workers
+// threads so a busy server does not oversubscribe the machine.
+class FireServer
+{
+private:
+    FireDataAnalyzer &analyzer;
+    int ompThreads;
+    QueryServer server;
+
+    void handle(uint16_t opcode, WireReader &in, WireWriter &out)
+    {
+        static thread_local bool configured = false;
+        if (!configured)
+        {
+            omp_set_num_threads(ompThreads);
+            configured = true;
+        }
+
+        switch (opcode)
+        {
+        case FireProtocol::PING:
+            break;
+        case FireProtocol::QUERY:
+            FireProtocol::encodeResult(analyzer.query(FireProtocol::decodeQuery(in)), out);
+            break;
+        case FireProtocol::DAYS_ABOVE:
+        {
+            std::vector<std::string> days = analyzer.getDaysWithAQIAbove(in.i32());
+            out.u32(static_cast<uint32_t>(days.size()));
+            for (const std::string &day : days)
+                out.str(day);
+            break;
+        }
+        case FireProtocol::AVERAGE_AQI:
+            out.f64(analyzer.getAverageAQIForDate(in.str()));
+            break;
+        case FireProtocol::RECORDS_FOR_DATE:
+        {
+            std::string date = in.str();
+            uint32_t max = in.u32();
+            std::shared_ptr<const std::vector<AirQualityRecord>> shared = analyzer.getAQIDataForDateShared(date);
+            const std::vector<AirQualityRecord> &records = *shared;
+            uint32_t n = std::min<uint32_t>(max, static_cast<uint32_t>(records.size()));
+            out.u32(static_cast<uint32_t>(records.size()));
+            out.u32(n);
+            for (uint32_t i = 0; i < n; i++)
+            {
+                out.str(records[i].datetime);
+                out.str(records[i].siteName);
+                out.str(records[i].parameter);
+                out.f64(records[i].value);
+                out.str(records[i].unit);
+                out.i32(records[i].aqi);
+            }
+            break;
+        }
+        default:
+            throw QueryServer::UnknownOpcode();
+        }
+    }
+
+public:
+    // workers = 0: one per core
+    FireServer(FireDataAnalyzer &a, int workers = 0)
+        : analyzer(a),
+          ompThreads(std::max(1, omp_get_num_procs() / std::max(1, workers > 0 ? workers : omp_get_num_procs()))),
+          server([this](uint16_t opcode, WireReader &in, WireWriter &out) { handle(opcode, in, out); }, workers)
+    {
+        // Queries must not race to build the indexes on first use
+        analyzer.setVerbose(false);
+        analyzer.buildIndexes();
+    }
+
+    bool listenUnix(const std::string &path) { return server.listenUnix(path); }
+    bool listenTcp(int port) { return server.listenTcp(port); }
+    const std::string &lastError() const { return server.lastError(); }
+    int getTcpPort() const { return server.getTcpPort(); }
+    uint64_t getRequestCount() const { return server.getRequestCount(); }
+
+    void run() { server.run(); }
+    void stop() { server.stop(); }
+};
+
+#endif // FIRE_SERVER_H
@@ -0,0 +1,166 @@
+#ifndef PARALLEL_GROUP_BY_H
+#define PARALLEL_GROUP_BY_H
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+#include "omp.h"
+#include "Trace.h"
+
+// Radix-partitioned parallel hash aggregation over integer group keys
+// (dictionary codes of date, site, parameter, ... packed into 64 bits).
+//
+// Phase 1: each thread folds its share of the rows into its own set of
+// kPartitions open-addressing tables; the partition is taken from the top
+// bits of the key's hash, so a thread-local table stays small and cache
+// resident. Phase 2: partitions are merged in parallel, partition p of
+// every thread into one table by a single thread, so no locks are needed.
+//
+//   auto groups = ParallelGroupBy<KernelStats>::run(rows, nullptr,
+//       [&](size_t i) { return uint64_t(dateCode[i]); },     // key
+//       [&](size_t i) { return aqi[i] >= 0; },                // filter
+//       [&](KernelStats &s, size_t i) { s.count++; });        // fold
+//
+// State must be default-constructible and provide merge(const State &).
+// The key ~0 is reserved as the empty-slot marker.
+template <typename State>
+class ParallelGroupBy
+{
+public:
+    static constexpr int kRadixBits = 6;
+    static constexpr size_t kPartitions = size_t(1) << kRadixBits;
+    static constexpr uint64_t kEmpty = ~uint64_t(0);
+
+    struct Group
+    {
+        uint64_t key;
+        State state;
+    };
+
+    // Linear-probing table, grown at 50% load
+    class Table
+    {
+    private:
+        std::vector<uint64_t> keys;
+        std::vector<State> states;
+        size_t used = 0;
+        size_t mask = 0;
+
+        void grow()
+        {
+            std::vector<uint64_t> oldKeys;
+            std::vector<State> oldStates;
+            oldKeys.swap(keys);
+            oldStates.swap(states);
+            size_t capacity = oldKeys.empty() ? 16 : oldKeys.size() * 2;
+            keys.assign(capacity, kEmpty);
+            states.assign(capacity, State());
+            mask = capacity - 1;
+            used = 0;
+            for (size_t i = 0; i < oldKeys.size(); i++)
+            {
+                if (oldKeys[i] != kEmpty)
+                    find(oldKeys[i], hash(oldKeys[i])) = std::move(oldStates[i]);
+            }
+        }
+
+    public:
+        size_t size() const { return used; }
+
+        State &find(uint64_t key, uint64_t h)
+        {
+            if ((used + 1) * 2 > keys.size())
+                grow();
+            size_t slot = h & mask;
+            while (keys[slot] != kEmpty && keys[slot] != key)
+                slot = (slot + 1) & mask;
+            if (keys[slot] == kEmpty)
+            {
+                keys[slot] = key;
+                used++;
+            }
+            return states[slot];
+        }
+
+        template <typename F>
+        void forEach(F f)
+        {
+            for (size_t i = 0; i < keys.size(); i++)
+            {
+                if (keys[i] != kEmpty)
+                    f(keys[i], states[i]);
+            }
+        }
+    };
+
+    // 64-bit finaliser (murmur3 fmix); spreads packed codes over all bits
+    static uint64_t hash(uint64_t key)
+    {
+        key ^= key >> 33;
+        key *= 0xff51afd7ed558ccdULL;
+        key ^= key >> 33;
+        key *= 0xc4ceb9fe1a85ec53ULL;
+        key ^= key >> 33;
+        return key;
+    }
+
+    // Groups of the given rows (row i for i < rows, or rowIds[i] if set),
+    // in no particular order
+    template <typename KeyFn, typename FilterFn, typename FoldFn>
+    static std::vector<Group> run(size_t rows, const uint32_t *rowIds, KeyFn keyOf, FilterFn accept, FoldFn fold)
+    {
+        int nThreads = omp_get_max_threads();
+        std::vector<std::vector<Table>> local(nThreads, std::vector<Table>(kPartitions));
+        long long n = static_cast<long long>(rows);
+
+        // Phase 1: thread-local, partitioned pre-aggregation; a static split,
+        // so each thread reads one contiguous block of the column arrays
+#pragma omp parallel
+        {
+            TraceScope trace("group-by partition", "query");
+            std::vector<Table> &tables = local[omp_get_thread_num()];
+#pragma omp for schedule(static) nowait
+            for (long long j = 0; j < n; j++)
+            {
+                size_t i = rowIds != nullptr ? rowIds[j] : static_cast<size_t>(j);
+                if (!accept(i))
+                    continue;
+                uint64_t key = keyOf(i);
+                uint64_t h = hash(key);
+                fold(tables[h >> (64 - kRadixBits)].find(key, h), i);
+            }
+        }
+
+        // Phase 2: each partition merged by one thread
+        std::vector<std::vector<Group>> merged(kPartitions);
+#pragma omp parallel
+        {
+            TraceScope trace("group-by merge", "query");
+#pragma omp for schedule(dynamic)
+            for (long long p = 0; p < static_cast<long long>(kPartitions); p++)
+            {
+                Table table;
+                for (int t = 0; t < nThreads; t++)
+                {
+                    local[t][p].forEach([&table](uint64_t key, State &state)
+                                        { table.find(key, hash(key)).merge(state); });
+                }
+                std::vector<Group> &out = merged[p];
+                out.reserve(table.size());
+                table.forEach([&out](uint64_t key, State &state) { out.push_back(Group{key, std::move(state)}); });
+            }
+        }
+
+        std::vector<Group> groups;
+        for (std::vector<Group> &partition : merged)
+        {
+            groups.insert(groups.end(), std::make_move_iterator(partition.begin()),
+                          std::make_move_iterator(partition.end()));
+        }
+        return groups;
+    }
+};
+
+#endif // PARALLEL_GROUP_BY_H
@@ -0,0 +1,218 @@
+#ifndef RESULT_CACHE_H
+#define RESULT_CACHE_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Dates a cached result was computed from, as an inclusive YYYY-MM-DD
+// range; ingesting a row whose date falls inside it invalidates the entry
+struct DateSpan
+{
+    std::string first;
+    std::string last;
+
+    static DateSpan all() { return DateSpan{"", "\xff"}; }
+    static DateSpan day(const std::string &date) { return DateSpan{date, date}; }
+
+    bool empty() const { return last < first; }
+
+    // touched is sorted
+    bool overlaps(const std::vector<std::string> &touched) const
+    {
+        auto it = std::lower_bound(touched.begin(), touched.end(), first);
+        return it != touched.end() && *it <= last;
+    }
+};
+
+// Bounded LRU cache of query results keyed by a normalised query string.
+// Keys hash to one of kShards independently locked shards, each holding
+// an LRU list within its share of the byte budget. Values are shared, so
+// a hit copies out without holding the lock for the copy.
+//
+// A result computed while an ingest was running may predate the rows it
+// should include: callers take generation() before computing and pass it
+// to insert(), which drops the result if an invalidation happened since.
+template <typename Value>
+class ResultCache
+{
+public:
+    struct Stats
+    {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t insertions = 0;
+        uint64_t evictions = 0;
+        uint64_t invalidations = 0;
+        size_t entries = 0;
+        size_t bytes = 0;
+    };
+
+    static constexpr size_t kShards = 16;
+
+    explicit ResultCache(size_t capacityBytes = 0) { setCapacity(capacityBytes); }
+
+    ResultCache(const ResultCache &) = delete;
+    ResultCache &operator=(const ResultCache &) = delete;
+
+    // 0 disables the cache; shrinking evicts down to the new budget
+    void setCapacity(size_t capacityBytes)
+    {
+        shardCapacity = capacityBytes / kShards;
+        for (Shard &shard : shards)
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.evictTo(shardCapacity.load());
+        }
+    }
+
+    size_t getCapacity() const { return shardCapacity.load() * kShards; }
+    bool enabled() const { return shardCapacity.load() > 0; }
+
+    uint64_t generation() const { return currentGeneration.load(std::memory_order_acquire); }
+
+    std::shared_ptr<const Value> find(const std::string &key)
+    {
+        Shard &shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.index.find(key);
+        if (it == shard.index.end())
+        {
+            shard.misses++;
+            return nullptr;
+        }
+        shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+        shard.hits++;
+        return it->second->value;
+    }
+
+    // Entries larger than a shard's budget are not cached
+    void insert(const std::string &key, std::shared_ptr<const Value> value, size_t bytes,
+                const DateSpan &span, uint64_t computedAt)
+    {
+        size_t capacity = shardCapacity.load();
+        bytes += key.size() + sizeof(Entry);
+        if (bytes > capacity || span.empty())
+            return;
+
+        Shard &shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (computedAt != currentGeneration.load(std::memory_order_acquire))
+            return;
+        auto it = shard.index.find(key);
+        if (it != shard.index.end())
+            shard.erase(it->second);
+        shard.lru.push_front(Entry{key, std::move(value), bytes, span});
+        shard.index[key] = shard.lru.begin();
+        shard.bytes += bytes;
+        shard.insertions++;
+        shard.evictTo(capacity);
+    }
+
+    // Drop every entry whose date span contains one of the touched dates
+    void invalidateDates(std::vector<std::string> touched)
+    {
+        if (touched.empty())
+            return;
+        std::sort(touched.begin(), touched.end());
+        touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+        invalidateIf([&touched](const Entry &entry) { return entry.span.overlaps(touched); });
+    }
+
+    void clear()
+    {
+        invalidateIf([](const Entry &) { return true; });
+    }
+
+    Stats getStats() const
+    {
+        Stats stats;
+        for (const Shard &shard : shards)
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            stats.hits += shard.hits;
+            stats.misses += shard.misses;
+            stats.insertions += shard.insertions;
+            stats.evictions += shard.evictions;
+            stats.invalidations += shard.invalidations;
+            stats.entries += shard.index.size();
+            stats.bytes += shard.bytes;
+        }
+        return stats;
+    }
+
+private:
+    struct Entry
+    {
+        std::string key;
+        std::shared_ptr<const Value> value;
+        size_t bytes;
+        DateSpan span;
+    };
+
+    struct Shard
+    {
+        mutable std::mutex mutex;
+        std::list<Entry> lru;       // most recently used first
+        std::unordered_map<std::string, typename std::list<Entry>::iterator> index;
+        size_t bytes = 0;
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t insertions = 0;
+        uint64_t evictions = 0;
+        uint64_t invalidations = 0;
+
+        void erase(typename std::list<Entry>::iterator it)
+        {
+            bytes -= it->bytes;
+            index.erase(it->key);
+            lru.erase(it);
+        }
+
+        void evictTo(size_t capacity)
+        {
+            while (bytes > capacity && !lru.empty())
+            {
+                erase(std::prev(lru.end()));
+                evictions++;
+            }
+        }
+    };
+
+    Shard shards[kShards];
+    std::atomic<size_t> shardCapacity{0};
+    std::atomic<uint64_t> currentGeneration{0};
+
+    Shard &shardFor(const std::string &key) { return shards[std::hash<std::string>()(key) % kShards]; }
+
+    template <typename Match>
+    void invalidateIf(Match match)
+    {
+        // Bumped first, so results computed before this point are not
+        // inserted after their entries were dropped
+        currentGeneration.fetch_add(1, std::memory_order_acq_rel);
+        for (Shard &shard : shards)
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            for (auto it = shard.lru.begin(); it != shard.lru.end();)
+            {
+                auto next = std::next(it);
+                if (match(*it))
+                {
+                    shard.erase(it);
+                    shard.invalidations++;
+                }
+                it = next;
+            }
+        }
+    }
+};
+
+#endif // RESULT_CACHE_H
@@ -0,0 +1,338 @@
+#ifndef ROARING_BITMAP_H
+#define ROARING_BITMAP_H
+
+#include <algorithm>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <vector>
+
+// Compressed set of 32-bit row ids in the Roaring layout: ids are split by
+// their high 16 bits into chunks of 65536, and each chunk is stored as a
+// sorted uint16 array while it has at most 4096 members, or as a 1024-word
+// bitmap (8 KB) once it is denser. AND / OR work chunk by chunk and pick
+// the cheaper representation for the result.
+//
+// Row ids arrive in increasing order at ingest, so add() appends in O(1);
+// out-of-order ids are inserted with a binary search.
+class RoaringBitmap
+{
+private:
+    static const uint32_t kArrayMax = 4096;
+    static const uint32_t kWords = 1024;
+
+    struct Container
+    {
+        std::vector<uint16_t> array;    // sorted members while sparse
+        std::vector<uint64_t> bits;     // kWords words once dense
+        uint32_t cardinality = 0;
+
+        bool isBitmap() const { return !bits.empty(); }
+
+        bool contains(uint16_t v) const
+        {
+            if (isBitmap())
+                return (bits[v >> 6] >> (v & 63)) & 1;
+            return std::binary_search(array.begin(), array.end(), v);
+        }
+
+        void add(uint16_t v)
+        {
+            if (isBitmap())
+            {
+                uint64_t mask = uint64_t(1) << (v & 63);
+                cardinality += (bits[v >> 6] & mask) == 0;
+                bits[v >> 6] |= mask;
+                return;
+            }
+            if (array.empty() || v > array.back())
+            {
+                array.push_back(v);
+            }
+            else
+            {
+                auto it = std::lower_bound(array.begin(), array.end(), v);
+                if (*it == v)
+                    return;
+                array.insert(it, v);
+            }
+            cardinality++;
+            if (cardinality > kArrayMax)
+                toBitmap();
+        }
+
+        void toBitmap()
+        {
+            bits.assign(kWords, 0);
+            for (uint16_t v : array)
+                bits[v >> 6] |= uint64_t(1) << (v & 63);
+            array.clear();
+            array.shrink_to_fit();
+        }
+
+        void toArrayIfSparse()
+        {
+            if (!isBitmap() || cardinality > kArrayMax)
+                return;
+            array.clear();
+            array.reserve(cardinality);
+            forEach([this](uint16_t v) { array.push_back(v); });
+            bits.clear();
+            bits.shrink_to_fit();
+        }
+
+        template <typename F>
+        void forEach(F f) const
+        {
+            if (!isBitmap())
+            {
+                for (uint16_t v : array)
+                    f(v);
+                return;
+            }
+            for (uint32_t w = 0; w < kWords; w++)
+            {
+                uint64_t word = bits[w];
+                while (word != 0)
+                {
+                    f(static_cast<uint16_t>(w * 64 + __builtin_ctzll(word)));
+                    word &= word - 1;
+                }
+            }
+        }
+
+        static Container intersect(const Container &a, const Container &b)
+        {
+            Container out;
+            if (a.isBitmap() && b.isBitmap())
+            {
+                out.bits.resize(kWords);
+                for (uint32_t w = 0; w < kWords; w++)
+                {
+                    out.bits[w] = a.bits[w] & b.bits[w];
+                    out.cardinality += __builtin_popcountll(out.bits[w]);
+                }
+                out.toArrayIfSparse();
+            }
+            else if (a.isBitmap() || b.isBitmap())
+            {
+                const Container &sparse = a.isBitmap() ? b : a;
+                const Container &dense = a.isBitmap() ? a : b;
+                for (uint16_t v : sparse.array)
+                {
+                    if (dense.contains(v))
+                        out.array.push_back(v);
+                }
+                out.cardinality = static_cast<uint32_t>(out.array.size());
+            }
+            else
+            {
+                std::set_intersection(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(),
+                                      std::back_inserter(out.array));
+                out.cardinality = static_cast<uint32_t>(out.array.size());
+            }
+            return out;
+        }
+
+        static uint32_t intersectCount(const Container &a, const Container &b)
+        {
+            uint32_t count = 0;
+            if (a.isBitmap() && b.isBitmap())
+            {
+                for (uint32_t w = 0; w < kWords; w++)
+                    count += __builtin_popcountll(a.bits[w] & b.bits[w]);
+            }
+            else if (a.isBitmap() || b.isBitmap())
+            {
+                const Container &sparse = a.isBitmap() ? b : a;
+                const Container &dense = a.isBitmap() ? a : b;
+                for (uint16_t v : sparse.array)
+                    count += dense.contains(v);
+            }
+            else
+            {
+                size_t i = 0, j = 0;
+                while (i < a.array.size() && j < b.array.size())
+                {
+                    if (a.array[i] < b.array[j])
+                        i++;
+                    else if (a.array[i] > b.array[j])
+                        j++;
+                    else
+                    {
+                        count++;
+                        i++;
+                        j++;
+                    }
+                }
+            }
+            return count;
+        }
+
+        static Container unite(const Container &a, const Container &b)
+        {
+            Container out;
+            if (!a.isBitmap() && !b.isBitmap() && a.cardinality + b.cardinality <= kArrayMax)
+            {
+                std::set_union(a.array.begin(), a.array.end(), b.array.begin(), b.array.end(),
+                               std::back_inserter(out.array));
+                out.cardinality = static_cast<uint32_t>(out.array.size());
+                return out;
+            }
+            out.bits.assign(kWords, 0);
+            for (const Container *c : {&a, &b})
+            {
+                if (c->isBitmap())
+                {
+                    for (uint32_t w = 0; w < kWords; w++)
+                        out.bits[w] |= c->bits[w];
+                }
+                else
+                {
+                    for (uint16_t v : c->array)
+                        out.bits[v >> 6] |= uint64_t(1) << (v & 63);
+                }
+            }
+            for (uint32_t w = 0; w < kWords; w++)
+                out.cardinality += __builtin_popcountll(out.bits[w]);
+            out.toArrayIfSparse();
+            return out;
+        }
+    };
+
+    std::vector<uint16_t> keys;         // high 16 bits, ascending
+    std::vector<Container> containers;  // parallel to keys
+
+public:
+    void add(uint32_t id)
+    {
+        uint16_t high = static_cast<uint16_t>(id >> 16);
+        if (keys.empty() || high > keys.back())
+        {
+            keys.push_back(high);
+            containers.emplace_back();
+            containers.back().add(static_cast<uint16_t>(id));
+            return;
+        }
+        size_t i = std::lower_bound(keys.begin(), keys.end(), high) - keys.begin();
+        if (keys[i] != high)
+        {
+            keys.insert(keys.begin() + i, high);
+            containers.insert(containers.begin() + i, Container());
+        }
+        containers[i].add(static_cast<uint16_t>(id));
+    }
+
+    bool contains(uint32_t id) const
+    {
+        uint16_t high = static_cast<uint16_t>(id >> 16);
+        auto it = std::lower_bound(keys.begin(), keys.end(), high);
+        return it != keys.end() && *it == high && containers[it - keys.begin()].contains(static_cast<uint16_t>(id));
+    }
+
+    uint64_t cardinality() const
+    {
+        uint64_t total = 0;
+        for (const Container &c : containers)
+            total += c.cardinality;
+        return total;
+    }
+
+    bool empty() const { return containers.empty(); }
+
+    // Heap bytes held by the containers
+    size_t memoryBytes() const
+    {
+        size_t bytes = keys.capacity() * sizeof(uint16_t) + containers.capacity() * sizeof(Container);
+        for (const Container &c : containers)
+            bytes += c.array.capacity() * sizeof(uint16_t) + c.bits.capacity() * sizeof(uint64_t);
+        return bytes;
+    }
+
+    static RoaringBitmap intersect(const RoaringBitmap &a, const RoaringBitmap &b)
+    {
+        RoaringBitmap out;
+        size_t i = 0, j = 0;
+        while (i < a.keys.size() && j < b.keys.size())
+        {
+            if (a.keys[i] < b.keys[j])
+                i++;
+            else if (a.keys[i] > b.keys[j])
+                j++;
+            else
+            {
+                Container c = Container::intersect(a.containers[i], b.containers[j]);
+                if (c.cardinality > 0)
+                {
+                    out.keys.push_back(a.keys[i]);
+                    out.containers.push_back(std::move(c));
+                }
+                i++;
+                j++;
+            }
+        }
+        return out;
+    }
+
+    // |a AND b| without building the intersection
+    static uint64_t intersectCount(const RoaringBitmap &a, const RoaringBitmap &b)
+    {
+        uint64_t count = 0;
+        size_t i = 0, j = 0;
+        while (i < a.keys.size() && j < b.keys.size())
+        {
+            if (a.keys[i] < b.keys[j])
+                i++;
+            else if (a.keys[i] > b.keys[j])
+                j++;
+            else
+                count += Container::intersectCount(a.containers[i++], b.containers[j++]);
+        }
+        return count;
+    }
+
+    static RoaringBitmap unite(const RoaringBitmap &a, const RoaringBitmap &b)
+    {
+        RoaringBitmap out;
+        size_t i = 0, j = 0;
+        while (i < a.keys.size() || j < b.keys.size())
+        {
+            if (j == b.keys.size() || (i < a.keys.size() && a.keys[i] < b.keys[j]))
+            {
+                out.keys.push_back(a.keys[i]);
+                out.containers.push_back(a.containers[i++]);
+            }
+            else if (i == a.keys.size() || b.keys[j] < a.keys[i])
+            {
+                out.keys.push_back(b.keys[j]);
+                out.containers.push_back(b.containers[j++]);
+            }
+            else
+            {
+                out.keys.push_back(a.keys[i]);
+                out.containers.push_back(Container::unite(a.containers[i++], b.containers[j++]));
+            }
+        }
+        return out;
+    }
+
+    // Members in ascending order
+    template <typename F>
+    void forEach(F f) const
+    {
+        for (size_t i = 0; i < keys.size(); i++)
+        {
+            uint32_t base = static_cast<uint32_t>(keys[i]) << 16;
+            containers[i].forEach([&](uint16_t low) { f(base | low); });
+        }
+    }
+
+    void toVector(std::vector<uint32_t> &out) const
+    {
+        out.clear();
+        out.reserve(cardinality());
+        forEach([&out](uint32_t id) { out.push_back(id); });
+    }
+};
+
+#endif // ROARING_BITMAP_H
@@ -0,0 +1,511 @@
+#ifndef TASK_SCHEDULER_H
+#define TASK_SCHEDULER_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "omp.h"
+#include "Trace.h"
+
+// Work-stealing task runtime shared by the load and query code.
+//
+// One worker thread per core (less one: the thread that waits on a task
+// group runs tasks too). Each worker owns a Chase-Lev deque: it pushes and
+// pops its own tasks at the bottom (LIFO, cache-warm) and idle workers steal
+// from the top of someone else's (FIFO, the largest remaining pieces).
+// Threads outside the pool borrow one of a few spare deques, so a serial
+// run executes parallelFor chunks in index order, as `omp for` would.
+// A task may spawn and wait on further tasks, so per-file and per-line work
+// nest without creating new thread teams.
+//
+//   TaskGroup group;
+//   for (const std::string &path : files)
+//       group.run([&, path]() { loadCSVFile(path); });
+//   group.wait();
+//
+//   TaskScheduler::instance().parallelFor(lines.size(), 1024,
+//       [&](size_t lo, size_t hi) { ... });
+
+// Lock-free single-owner deque (Chase & Lev 2005, with the C11 orderings of
+// Le et al. 2013). push / pop by the owning worker only, steal by anyone.
+// Grown arrays are kept until the deque is destroyed, since a thief may
+// still be reading the old one.
+template <typename T>
+class ChaseLevDeque
+{
+private:
+    struct Array
+    {
+        size_t capacity;
+        std::unique_ptr<std::atomic<T>[]> slots;
+
+        explicit Array(size_t size) : capacity(size), slots(new std::atomic<T>[size]) {}
+
+        // acquire / release on top of the fences: free on x86, and lets
+        // ThreadSanitizer (which ignores fences) see the hand-off
+        T get(int64_t i) const { return slots[i & (capacity - 1)].load(std::memory_order_acquire); }
+        void put(int64_t i, T v) { slots[i & (capacity - 1)].store(v, std::memory_order_release); }
+    };
+
+    alignas(64) std::atomic<int64_t> top{0};
+    alignas(64) std::atomic<int64_t> bottom{0};
+    std::atomic<Array *> array;
+    std::vector<std::unique_ptr<Array>> arrays;     // current and retired
+
+    Array *grow(Array *old, int64_t t, int64_t b)
+    {
+        arrays.emplace_back(new Array(old->capacity * 2));
+        Array *bigger = arrays.back().get();
+        for (int64_t i = t; i < b; i++)
+            bigger->put(i, old->get(i));
+        array.store(bigger, std::memory_order_release);
+        return bigger;
+    }
+
+public:
+    explicit ChaseLevDeque(size_t capacity = 256)
+    {
+        arrays.emplace_back(new Array(capacity));
+        array.store(arrays.back().get(), std::memory_order_relaxed);
+    }
+
+    void push(T item)
+    {
+        int64_t b = bottom.load(std::memory_order_relaxed);
+        int64_t t = top.load(std::memory_order_acquire);
+        Array *a = array.load(std::memory_order_relaxed);
+        if (b - t > static_cast<int64_t>(a->capacity) - 1)
+            a = grow(a, t, b);
+        a->put(b, item);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom.store(b + 1, std::memory_order_relaxed);
+    }
+
+    bool pop(T &out)
+    {
+        int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+        Array *a = array.load(std::memory_order_relaxed);
+        bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = top.load(std::memory_order_relaxed);
+        if (t > b)
+        {
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return false;
+        }
+        out = a->get(b);
+        if (t < b)
+            return true;
+
+        // Last item: race the thieves for it
+        bool won = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+        bottom.store(b + 1, std::memory_order_relaxed);
+        return won;
+    }
+
+    // Owner only
+    bool empty() const
+    {
+        return bottom.load(std::memory_order_relaxed) <= top.load(std::memory_order_relaxed);
+    }
+
+    bool steal(T &out)
+    {
+        int64_t t = top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = bottom.load(std::memory_order_acquire);
+        if (t >= b)
+            return false;
+        Array *a = array.load(std::memory_order_acquire);
+        out = a->get(t);
+        return top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+    }
+};
+
+class TaskGroup;
+
+class TaskScheduler
+{
+private:
+    friend class TaskGroup;
+
+    struct Task
+    {
+        std::function<void()> fn;
+        TaskGroup *group;
+    };
+
+    // Pool workers first, then kExternalSlots deques (no thread) lent to
+    // outside threads that spawn or wait, so their nested tasks stay LIFO.
+    // An outside thread keeps its slot until its outermost wait returns
+    // with the deque empty.
+    struct Worker
+    {
+        ChaseLevDeque<Task *> deque;
+        std::thread thread;
+        std::atomic<std::thread::id> borrower{};
+        int waitDepth = 0;      // borrower only
+    };
+
+    struct PoolThread
+    {
+        const TaskScheduler *scheduler = nullptr;
+        int slot = -1;
+    };
+
+    static const int kExternalSlots = 8;
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    size_t poolSize = 0;
+    std::mutex injectMutex;
+    std::deque<Task *> injected;                // outside threads without a slot
+
+    std::atomic<size_t> queued{0};              // spawned, not yet taken
+    std::atomic<int> sleeping{0};
+    std::atomic<int> activeWorkers{0};          // concurrency - 1
+    std::atomic<bool> stopping{false};
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+
+    // runOnEachWorker() broadcast
+    std::function<void(int)> broadcast;
+    std::atomic<uint64_t> broadcastGeneration{0};
+    size_t broadcastAcks = 0;
+    std::condition_variable broadcastDone;
+
+    static PoolThread &poolThread()
+    {
+        static thread_local PoolThread self;
+        return self;
+    }
+
+    // Deque slot of the calling thread: its worker index, or an external
+    // slot it has borrowed (borrowing a free one if it has none); -1
+    // (injection queue) if every external slot is taken
+    int currentSlot()
+    {
+        const PoolThread &pool = poolThread();
+        if (pool.scheduler == this)
+            return pool.slot;
+        std::thread::id me = std::this_thread::get_id();
+        for (size_t i = poolSize; i < workers.size(); i++)
+        {
+            if (workers[i]->borrower.load() == me)
+                return static_cast<int>(i);
+        }
+        for (size_t i = poolSize; i < workers.size(); i++)
+        {
+            std::thread::id none;
+            if (workers[i]->borrower.compare_exchange_strong(none, me))
+                return static_cast<int>(i);
+        }
+        return -1;
+    }
+
+    inline void execute(Task *task);
+
+    bool take(int self, Task *&task)
+    {
+        if (self >= 0 && workers[self]->deque.pop(task))
+        {
+            queued.fetch_sub(1);
+            return true;
+        }
+        if (queued.load() == 0)
+            return false;
+        {
+            std::lock_guard<std::mutex> lock(injectMutex);
+            if (!injected.empty())
+            {
+                task = injected.front();
+                injected.pop_front();
+                queued.fetch_sub(1);
+                return true;
+            }
+        }
+
+        // Steal from any deque, starting after our own so thieves spread out
+        size_t n = workers.size();
+        for (size_t k = 1; k <= n; k++)
+        {
+            size_t victim = (static_cast<size_t>(self + 1) + k) % n;
+            if (static_cast<int>(victim) != self && workers[victim]->deque.steal(task))
+            {
+                queued.fetch_sub(1);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void workerLoop(int self)
+    {
+        poolThread().scheduler = this;
+        poolThread().slot = self;
+        TraceRecorder::instance().setThreadName("worker " + std::to_string(self + 1));
+        uint64_t seenGeneration = 0;
+
+        while (true)
+        {
+            if (broadcastGeneration.load() != seenGeneration)
+            {
+                std::lock_guard<std::mutex> lock(sleepMutex);
+                seenGeneration = broadcastGeneration.load();
+                broadcast(self + 1);
+                broadcastAcks++;
+                broadcastDone.notify_all();
+            }
+
+            Task *task = nullptr;
+            bool active = self < activeWorkers.load();
+            if (active && take(self, task))
+            {
+                execute(task);
+                continue;
+            }
+
+            // Spin briefly before parking: tasks tend to arrive in bursts
+            bool found = false;
+            for (int spin = 0; active && spin < 64 && !found; spin++)
+            {
+                std::this_thread::yield();
+                found = queued.load() > 0;
+            }
+            if (found)
+                continue;
+
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            sleeping.fetch_add(1);
+            wake.wait(lock, [&]()
+                      {
+                          return stopping.load() || broadcastGeneration.load() != seenGeneration ||
+                                 (self < activeWorkers.load() && queued.load() > 0);
+                      });
+            sleeping.fetch_sub(1);
+            if (stopping.load())
+                return;
+        }
+    }
+
+    // notify_all: a worker parked by setConcurrency() would swallow a
+    // single notification
+    void notifySleepers()
+    {
+        if (sleeping.load() > 0)
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            wake.notify_all();
+        }
+    }
+
+public:
+    explicit TaskScheduler(unsigned threads = std::max(1u, std::thread::hardware_concurrency()))
+    {
+        poolSize = std::max(1u, threads) - 1;
+        activeWorkers.store(static_cast<int>(poolSize));
+        for (size_t i = 0; i < poolSize + kExternalSlots; i++)
+            workers.emplace_back(new Worker());
+        for (size_t i = 0; i < poolSize; i++)
+            workers[i]->thread = std::thread(&TaskScheduler::workerLoop, this, static_cast<int>(i));
+    }
+
+    ~TaskScheduler()
+    {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            stopping.store(true);
+        }
+        wake.notify_all();
+        for (size_t i = 0; i < poolSize; i++)
+            workers[i]->thread.join();
+    }
+
+    TaskScheduler(const TaskScheduler &) = delete;
+    TaskScheduler &operator=(const TaskScheduler &) = delete;
+
+    // Process-wide pool: one thread per core, or OMP_NUM_THREADS
+    static TaskScheduler &instance()
+    {
+        static TaskScheduler scheduler(static_cast<unsigned>(omp_get_max_threads()));
+        return scheduler;
+    }
+
+    // Threads that run tasks, counting the waiting caller
+    int getConcurrency() const { return activeWorkers.load() + 1; }
+
+    // Use only the first threads - 1 workers (for thread-count sweeps);
+    // clamped to the pool size
+    void setConcurrency(int threads)
+    {
+        int count = std::min(std::max(threads, 1) - 1, static_cast<int>(poolSize));
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            activeWorkers.store(count);
+        }
+        wake.notify_all();
+    }
+
+    // Run fn(i) once on every worker thread, i = 1..workers (0 is the
+    // caller), e.g. to pin workers or attach per-thread counters
+    void runOnEachWorker(const std::function<void(int)> &fn)
+    {
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        broadcast = fn;
+        broadcastAcks = 0;
+        broadcastGeneration.fetch_add(1);
+        wake.notify_all();
+        broadcastDone.wait(lock, [&]() { return broadcastAcks == poolSize; });
+        broadcast = nullptr;
+    }
+
+    void spawn(Task *task)
+    {
+        int self = currentSlot();
+        if (self >= 0)
+        {
+            workers[self]->deque.push(task);
+        }
+        else
+        {
+            std::lock_guard<std::mutex> lock(injectMutex);
+            injected.push_back(task);
+        }
+        queued.fetch_add(1);
+        notifySleepers();
+    }
+
+    // Run other tasks until done() holds; the waiting thread is never idle
+    // while there is work, which is what makes nested waits safe
+    template <typename Done>
+    void helpUntil(Done done)
+    {
+        int self = currentSlot();
+        bool borrowed = self >= static_cast<int>(poolSize);
+        if (borrowed)
+            workers[self]->waitDepth++;
+        while (!done())
+        {
+            Task *task = nullptr;
+            if (take(self, task))
+                execute(task);
+            else
+                std::this_thread::yield();
+        }
+        if (borrowed && --workers[self]->waitDepth == 0 && workers[self]->deque.empty())
+            workers[self]->borrower.store(std::thread::id());
+    }
+
+    // body(lo, hi) for every grain-sized chunk of [0, count); chunk k is
+    // [k * grain, min((k + 1) * grain, count)). Ranges are split in halves
+    // so thieves take large pieces.
+    template <typename Body>
+    inline void parallelFor(size_t count, size_t grain, Body body);
+};
+
+// Tasks whose completion is awaited together. The first exception thrown
+// by a task is rethrown from wait().
+class TaskGroup
+{
+private:
+    friend class TaskScheduler;
+
+    TaskScheduler &scheduler;
+    std::atomic<size_t> pending{0};
+    std::mutex errorMutex;
+    std::exception_ptr error;
+
+    void finished(std::exception_ptr e)
+    {
+        if (e)
+        {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            if (!error)
+                error = e;
+        }
+        pending.fetch_sub(1, std::memory_order_acq_rel);
+    }
+
+public:
+    explicit TaskGroup(TaskScheduler &s = TaskScheduler::instance()) : scheduler(s) {}
+
+    ~TaskGroup()
+    {
+        scheduler.helpUntil([this]() { return pending.load(std::memory_order_acquire) == 0; });
+    }
+
+    TaskGroup(const TaskGroup &) = delete;
+    TaskGroup &operator=(const TaskGroup &) = delete;
+
+    void run(std::function<void()> fn)
+    {
+        pending.fetch_add(1, std::memory_order_relaxed);
+        scheduler.spawn(new TaskScheduler::Task{std::move(fn), this});
+    }
+
+    void wait()
+    {
+        scheduler.helpUntil([this]() { return pending.load(std::memory_order_acquire) == 0; });
+        std::lock_guard<std::mutex> lock(errorMutex);
+        if (error)
+        {
+            std::exception_ptr e = error;
+            error = nullptr;
+            std::rethrow_exception(e);
+        }
+    }
+};
+
+inline void TaskScheduler::execute(Task *task)
+{
+    std::exception_ptr e;
+    try
+    {
+        task->fn();
+    }
+    catch (...)
+    {
+        e = std::current_exception();
+    }
+    TaskGroup *group = task->group;
+    delete task;
+    group->finished(e);
+}
+
+template <typename Body>
+inline void TaskScheduler::parallelFor(size_t count, size_t grain, Body body)
+{
+    grain = std::max<size_t>(grain, 1);
+    size_t chunks = (count + grain - 1) / grain;
+    if (chunks <= 1)
+    {
+        if (count > 0)
+            body(0, count);
+        return;
+    }
+
+    TaskGroup group(*this);
+    std::function<void(size_t, size_t)> split = [&](size_t first, size_t last)
+    {
+        while (last - first > 1)
+        {
+            size_t mid = first + (last - first) / 2;
+            group.run([&split, mid, last]() { split(mid, last); });
+            last = mid;
+        }
+        body(first * grain, std::min(last * grain, count));
+    };
+    split(0, chunks);
+    group.wait();
+}
+
+#endif // TASK_SCHEDULER_H
@@ -0,0 +1,231 @@
+#include "FireDataAnalyzer.h"
+#include "BenchHarness.h"
+
+// Benchmarks the load and every query at each thread count (OpenMP team
+// size and task-scheduler concurrency).
+//   fire-data-bench [--data DIR] [--threads 1,2,4] [--reps N] [--json FILE]
+//                   [--csv FILE] [--scaling] [--pin] [--perf]
+// --scaling prints speedup and parallel efficiency against one thread;
+// --pin binds OpenMP thread / task worker i to the i-th allowed CPU, node
+// by node (FireDataAnalyzer::pinWorkers);
+// --perf adds IPC and cache / TLB misses per record from perf_event_open.
+int main(int argc, char *argv[])
+{
+    BenchOptions options = BenchSuite::parseArgs(argc, argv);
+    if (options.dataPath.empty())
+        options.dataPath = "data";
+    if (options.threadCounts.empty())
+        options.threadCounts = BenchSuite::defaultThreadCounts(omp_get_num_procs());
+
+    BenchSuite suite("fire-data-analyzer", options);
+    size_t sink = 0;
+
+    for (int threads : options.threadCounts)
+    {
+        omp_set_num_threads(threads);
+        TaskScheduler::instance().setConcurrency(threads);
+        if (options.pinThreads)
+            FireDataAnalyzer::pinWorkers();
+        if (suite.getPerfCounters().isOpen())
+        {
+            // Pool threads predate the counters, so each one attaches itself
+#pragma omp parallel
+            suite.getPerfCounters().attachCurrentThread();
+            TaskScheduler::instance().runOnEachWorker([&suite](int) { suite.getPerfCounters().attachCurrentThread(); });
+        }
+
+        // Cases time the queries themselves; the cache gets its own below
+        FireDataAnalyzer analyzer;
+        analyzer.setVerbose(false);
+        analyzer.setResultCacheBytes(0);
+        analyzer.loadData(options.dataPath);
+        if (analyzer.getRecordCount() == 0)
+        {
+            std::cerr << "No records loaded from " << options.dataPath << std::endl;
+            return 1;
+        }
+        suite.setRowsPerRun(analyzer.getRecordCount());
+
+        // A full load is seconds long, so it gets fewer repetitions
+        suite.run("load", threads, [&]()
+                  {
+                      FireDataAnalyzer fresh;
+                      fresh.setVerbose(false);
+                      fresh.loadData(options.dataPath);
+                      sink += fresh.getRecordCount();
+                  },
+                  3);
+        suite.run("load/blocking", threads, [&]()
+                  {
+                      FireDataAnalyzer fresh;
+                      fresh.setVerbose(false);
+                      fresh.setAsyncIO(false);
+                      fresh.loadData(options.dataPath);
+                      sink += fresh.getRecordCount();
+                  },
+                  3);
+
+        suite.run("getAQIDataForDate", threads, [&]()
+                  { sink += analyzer.getAQIDataForDate("2020-08-15").size(); });
+        suite.run("getDaysWithAQIAbove", threads, [&]()
+                  { sink += analyzer.getDaysWithAQIAbove(100).size(); });
+        suite.run("getAverageAQIForDate", threads, [&]()
+                  { sink += static_cast<size_t>(analyzer.getAverageAQIForDate("2020-08-20")); });
+
+        // Composed query through the engine (indexes built on first use)
+        Query worstSites;
+        worstSites.where(Predicate::eq(Column::PARAMETER, "PM2.5"))
+            .where(Predicate::gt(Column::AQI, 150))
+            .where(Predicate::between(Column::DATE, "2020-09-08", "2020-09-15"))
+            .where(Predicate::eq(Column::AGENCY, "California Air Resources Board"))
+            .groupBy(Column::FULL_SITE_ID)
+            .aggregate(Aggregate::MAX, Column::AQI);
+        analyzer.query(worstSites);
+        suite.run("query:pm25SiteMax", threads, [&]()
+                  { sink += analyzer.query(worstSites).rows.size() + 1; });
+
+        // Same ungrouped query through a compiled kernel and the interpreter
+        Query pm25Stats;
+        pm25Stats.where(Predicate::between(Column::DATE, "2020-09-08", "2020-09-15"))
+            .where(Predicate::eq(Column::PARAMETER, "PM2.5"))
+            .where(Predicate::ge(Column::AQI, 0))
+            .aggregate(Aggregate::AVG, Column::AQI)
+            .aggregate(Aggregate::MAX, Column::VALUE);
+        suite.run("query:pm25Stats/kernel", threads, [&]()
+                  { sink += analyzer.query(pm25Stats).rowsMatched; });
+        analyzer.setQueryKernels(false);
+        suite.run("query:pm25Stats/interpreted", threads, [&]()
+                  { sink += analyzer.query(pm25Stats).rowsMatched; });
+        analyzer.setQueryKernels(true);
+
+        // Full kernel scan of the AQI and value columns with the column
+        // arrays on 4 KB, transparent and explicit 2 MB pages (rebuilt for
+        // each); how much became huge is printed, --perf adds dTLB misses
+        Query fullScan;
+        fullScan.where(Predicate::ge(Column::AQI, 0))
+            .aggregate(Aggregate::AVG, Column::AQI)
+            .aggregate(Aggregate::MAX, Column::VALUE);
+        for (HugePages::Mode mode : {HugePages::OFF, HugePages::TRANSPARENT, HugePages::EXPLICIT})
+        {
+            analyzer.setHugePages(mode);
+            analyzer.buildIndexes();
+            KernelColumns::PageStats pages = analyzer.getColumnPageStats();
+            std::cout << "hugepages/" << HugePages::modeName(mode) << ": " << pages.hugeBytes / (1 << 20) << " of "
+                      << pages.bytes / (1 << 20) << " MB of columns on 2 MB pages" << std::endl;
+            suite.run(std::string("hugepages:scan/") + HugePages::modeName(mode), threads, [&]()
+                      { sink += analyzer.query(fullScan).rowsMatched; });
+        }
+        analyzer.setHugePages(HugePages::OFF);
+
+        // Answered from bitmap cardinalities without a row scan
+        Query categoryCounts;
+        categoryCounts.where(Predicate::eq(Column::PARAMETER, "PM2.5"))
+            .where(Predicate::eq(Column::AGENCY, "California Air Resources Board"))
+            .groupBy(Column::AQI_CATEGORY);
+        suite.run("query:categoryCounts", threads, [&]()
+                  { sink += analyzer.query(categoryCounts).rowsMatched; });
+
+        // Grouped on dictionary codes by the parallel group-by, and by the
+        // interpreter's string-keyed tables
+        Query dailyAverage;
+        dailyAverage.where(Predicate::ge(Column::AQI, 0))
+            .groupBy(Column::DATE)
+            .groupBy(Column::PARAMETER)
+            .aggregate(Aggregate::AVG, Column::AQI);
+        suite.run("query:dailyParameterAvg/groupby", threads, [&]()
+                  { sink += analyzer.query(dailyAverage).rows.size(); });
+        analyzer.setQueryKernels(false);
+        suite.run("query:dailyParameterAvg/interpreted", threads, [&]()
+                  { sink += analyzer.query(dailyAverage).rows.size(); });
+        analyzer.setQueryKernels(true);
+
+        // The columnar export, a full load from it, and a one-day load
+        // that reads only that date's row group
+        std::string columnarPath = (std::filesystem::temp_directory_path() / "fire-bench.fcol").string();
+        suite.run("columnar:export", threads, [&]()
+                  { sink += analyzer.exportColumnar(columnarPath); },
+                  3);
+        suite.run("columnar:load", threads, [&]()
+                  {
+                      FireDataAnalyzer fresh;
+                      fresh.setVerbose(false);
+                      fresh.loadColumnar(columnarPath);
+                      sink += fresh.getRecordCount();
+                  },
+                  3);
+        Query oneDay;
+        oneDay.where(Predicate::eq(Column::DATE, "2020-08-15"));
+        suite.run("columnar:getAQIDataForDate/cold", threads, [&]()
+                  {
+                      FireDataAnalyzer fresh;
+                      fresh.setVerbose(false);
+                      fresh.loadColumnar(columnarPath, &oneDay);
+                      sink += fresh.getAQIDataForDate("2020-08-15").size();
+                  });
+        std::filesystem::remove(columnarPath);
+
+        // Lazy mode: the startup catalogue, and a first query that loads
+        // only its own day
+        suite.run("lazy:open", threads, [&]()
+                  {
+                      FireDataAnalyzer fresh;
+                      fresh.setVerbose(false);
+                      fresh.openLazy(options.dataPath);
+                      sink += fresh.getPartitionStats().partitions;
+                  });
+        suite.run("lazy:getAQIDataForDate/cold", threads, [&]()
+                  {
+                      FireDataAnalyzer fresh;
+                      fresh.setVerbose(false);
+                      fresh.openLazy(options.dataPath);
+                      sink += fresh.getAQIDataForDate("2020-08-15").size();
+                  });
+
+        // Under a 64 MB memory budget: the load (spilling as it goes), a
+        // day paged back in from the scratch file (each call asks for the
+        // next date, so the day is never resident), and a scan of every
+        // day in budget-sized batches
+        const size_t budget = size_t(64) << 20;
+        suite.run("budget:load", threads, [&]()
+                  {
+                      FireDataAnalyzer fresh;
+                      fresh.setVerbose(false);
+                      fresh.setMemoryBudget(budget);
+                      fresh.loadData(options.dataPath);
+                      sink += fresh.getRecordCount();
+                  },
+                  3);
+        FireDataAnalyzer budgeted;
+        budgeted.setVerbose(false);
+        budgeted.setResultCacheBytes(0);
+        budgeted.setMemoryBudget(budget);
+        budgeted.loadData(options.dataPath);
+        std::vector<std::string> allDates = budgeted.getDaysWithAQIAbove(-1);
+        size_t nextDate = 0;
+        suite.run("budget:getAQIDataForDate/spilled", threads, [&]()
+                  {
+                      const std::string &date = allDates[nextDate++ % allDates.size()];
+                      sink += budgeted.getAQIDataForDate(date).size();
+                  });
+        suite.run("budget:getDaysWithAQIAbove", threads, [&]()
+                  { sink += budgeted.getDaysWithAQIAbove(100).size(); });
+
+        // Repeated calls answered from the result cache; getAQIDataForDate
+        // copies the day's records out, the shared form does not
+        analyzer.setResultCacheBytes(FireDataAnalyzer::kDefaultCacheBytes);
+        suite.run("cache:getAQIDataForDate", threads, [&]()
+                  { sink += analyzer.getAQIDataForDate("2020-08-15").size(); });
+        suite.run("cache:getAQIDataForDateShared", threads, [&]()
+                  { sink += analyzer.getAQIDataForDateShared("2020-08-15")->size(); });
+        suite.run("cache:getDaysWithAQIAbove", threads, [&]()
+                  { sink += analyzer.getDaysWithAQIAbove(100).size(); });
+        suite.run("cache:getAverageAQIForDate", threads, [&]()
+                  { sink += static_cast<size_t>(analyzer.getAverageAQIForDate("2020-08-20")); });
+        suite.run("cache:query:pm25SiteMax", threads, [&]()
+                  { sink += analyzer.query(worstSites).rows.size() + 1; });
+    }
+
+    suite.report(std::cout);
+
+    return sink == 0;
+}
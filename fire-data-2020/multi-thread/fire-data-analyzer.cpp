@@ -1,364 +1,166 @@
-#include <iostream>
-#include <fstream>
-#include <sstream>
-#include <vector>
-#include <string>
-#include <chrono>
-#include <map>
-#include <algorithm>
-#include <filesystem>
-#include <iomanip>
-#include <unordered_map>
+#include <csignal>
 
-#include "omp.h"
+#include "FireDataAnalyzer.h"
+#include "FireServer.h"
 
-// Structure to represent a single air quality record
-struct AirQualityRecord
-{
-    double latitude;
-    double longitude;
-    std::string datetime;
-    std::string parameter;
-    double value;
-    std::string unit;
-    double rawConcentration;
-    int aqi;
-    int aqiCategory;
-    std::string siteName;
-    std::string agencyName;
-    std::string siteId;
-    std::string fullSiteId;
-
-    std::string getDate() const
-    {
-        return datetime.substr(0, 10);
-    }
+static FireServer *activeServer = nullptr;
 
-};
-
-class FireDataAnalyzer
+static void stopServer(int)
 {
-private:
-    std::vector<AirQualityRecord> records;
+    if (activeServer)
+        activeServer->stop();
+}
 
-    // Helper function to remove quotes and clean string
-    std::string cleanString(const std::string &str)
+// Load once, then answer requests until SIGINT / SIGTERM
+static int serve(FireDataAnalyzer &analyzer, const std::string &socketPath, int port, int workers)
+{
+    FireServer server(analyzer, workers);
+    if (!socketPath.empty() && !server.listenUnix(socketPath))
     {
-        std::string cleaned = str;
-        if (!cleaned.empty() && cleaned.front() == '"')
-        {
-            cleaned.erase(0, 1);
-        }
-        if (!cleaned.empty() && cleaned.back() == '"')
-        {
-            cleaned.pop_back();
-        }
-        return cleaned;
+        std::cerr << server.lastError() << std::endl;
+        return 1;
     }
-
-    // Parse a single CSV line
-    std::vector<std::string> parseCSVLine(const std::string &line)
+    if (port >= 0 && !server.listenTcp(port))
     {
-        std::vector<std::string> fields;
-        std::stringstream ss(line);
-        std::string field;
-        bool inQuotes = false;
-        std::string currentField;
-
-#pragma omp parallel for
-        for (char c : line)
-        {
-            if (c == '"')
-            {
-                inQuotes = !inQuotes;
-                currentField += c;
-            }
-            else if (c == ',' && !inQuotes)
-            {
-                fields.push_back(cleanString(currentField));
-                currentField.clear();
-            }
-            else
-            {
-                currentField += c;
-            }
-        }
-        fields.push_back(cleanString(currentField));
-
-        return fields;
+        std::cerr << server.lastError() << std::endl;
+        return 1;
     }
 
-public:
-    // Load all CSV files from the data directory
-    void loadData(const std::string &dataDir)
-    {
-        auto start = std::chrono::high_resolution_clock::now();
+    std::cout << "Serving " << analyzer.getRecordCount() << " records on";
+    if (!socketPath.empty())
+        std::cout << " " << socketPath;
+    if (port >= 0)
+        std::cout << " 127.0.0.1:" << server.getTcpPort();
+    std::cout << " (Ctrl-C to stop)" << std::endl;
 
-        std::cout << "Loading fire data from: " << dataDir << std::endl;
+    activeServer = &server;
+    std::signal(SIGINT, stopServer);
+    std::signal(SIGTERM, stopServer);
+    server.run();
+    activeServer = nullptr;
 
-        try
-        {
-            std::vector<std::string> files;
-            for (const auto &entry : std::filesystem::recursive_directory_iterator(dataDir))
-            {
-                if (entry.path().extension() == ".csv")
-                {
-                    files.push_back(entry.path().string());
-                }
-            }
-
-#pragma omp parallel for
-            for (int i = 0; i < files.size(); i++)
-            {
-                loadCSVFile(files[i]);
-            }
-        }
-        catch (const std::filesystem::filesystem_error &e)
-        {
-            std::cerr << "Filesystem error: " << e.what() << std::endl;
-            return;
-        }
-
-        auto end = std::chrono::high_resolution_clock::now();
-        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
-
-        std::cout << "Loaded " << records.size() << " records in "
-                  << duration.count() << " milliseconds" << std::endl;
-    }
+    std::cout << "Served " << server.getRequestCount() << " requests" << std::endl;
+    return 0;
+}
 
-    // Load a single CSV file
-    void loadCSVFile(const std::string &filename)
+// fire-data-analyzer [--metrics FILE] [--trace FILE]
+//                    [--serve SOCKET] [--port N] [--workers N]
+//                    [--columnar FILE] [--export-columnar FILE]
+//                    [--lazy] [--memory-budget-mb N] [--spill-dir DIR]
+//                    [--numa] [--huge-pages off|thp|explicit]
+//   --metrics: FILE.json for JSON, else Prometheus text
+//   --trace:   Chrome trace JSON, open in ui.perfetto.dev or chrome://tracing
+//   --serve / --port: after loading, answer queries (FireServer.h) on a
+//              Unix socket and / or 127.0.0.1:N instead of running the
+//              sample queries; --workers sets the handler threads
+//   --columnar: load a file written by --export-columnar instead of data/
+//   --export-columnar: after loading, write the records as a columnar file
+//              (FireColumnar.h), one row group per date
+//   --lazy:    only catalogue data/YYYYMMDD at startup and load each day on
+//              first access; skips the full-data statistics
+//   --memory-budget-mb: keep at most N MB of records resident, spilling cold
+//              days to a scratch file in --spill-dir (default: the temp
+//              directory) and paging them back in when queried
+//   --numa:    pin the OpenMP team and task workers node by node before
+//              loading, so each thread scans column data on its own node
+//   --huge-pages: back the query column arrays with transparent (thp) or
+//              MAP_HUGETLB (explicit, falling back to thp) 2 MB pages and
+//              report at exit how much of them became huge
+int main(int argc, char *argv[])
+{
+    std::string metricsPath;
+    std::string tracePath;
+    std::string socketPath;
+    int port = -1;
+    int workers = 0;
+    std::string columnarPath;
+    std::string exportPath;
+    bool lazy = false;
+    bool numa = false;
+    size_t memoryBudgetMB = 0;
+    std::string spillDir;
+    std::string hugePages;
+    for (int i = 1; i < argc; i++)
     {
-        std::ifstream file(filename);
-        if (!file.is_open())
-        {
-            std::cerr << "Error opening file: " << filename << std::endl;
-            return;
-        }
-        std::vector<std::string> lines;
-        std::string line;
-        int lineCount = 0;
-
-        while (std::getline(file, line))
-        {
-            lines.push_back(line);
-            if (line.empty())
-                continue;
-        }
-
-        std::vector<AirQualityRecord> localRecords((lines.size()));
-
-#pragma omp parallel for
-        for (int i = 0; i < lines.size(); i++)
+        std::string arg = argv[i];
+        if (arg == "--lazy")
         {
-            std::vector<std::string> fields = parseCSVLine(lines[i]);
-            if (fields.size() >= 13)
-            {
-                AirQualityRecord record;
-                record.latitude = std::stod(fields[0]);
-                record.longitude = std::stod(fields[1]);
-                record.datetime = fields[2];
-                record.parameter = fields[3];
-                record.value = std::stod(fields[4]);
-                record.unit = fields[5];
-                record.rawConcentration = std::stod(fields[6]);
-                record.aqi = std::stoi(fields[7]);
-                record.aqiCategory = std::stoi(fields[8]);
-                record.siteName = fields[9];
-                record.agencyName = fields[10];
-                record.siteId = fields[11];
-                record.fullSiteId = fields[12];
-
-                localRecords[i] = record;
-            }
+            lazy = true;
+            continue;
         }
-
-        for (const auto &rec : localRecords)
+        if (arg == "--numa")
         {
-            if (!rec.datetime.empty())
-            {
-#pragma omp critical
-                records.push_back(rec);
-            }
+            numa = true;
+            continue;
         }
-
-        file.close();
+        if (i + 1 == argc)
+            break;
+        if (arg == "--metrics")
+            metricsPath = argv[i + 1];
+        else if (arg == "--trace")
+            tracePath = argv[i + 1];
+        else if (arg == "--serve")
+            socketPath = argv[i + 1];
+        else if (arg == "--port")
+            port = std::atoi(argv[i + 1]);
+        else if (arg == "--workers")
+            workers = std::atoi(argv[i + 1]);
+        else if (arg == "--columnar")
+            columnarPath = argv[i + 1];
+        else if (arg == "--export-columnar")
+            exportPath = argv[i + 1];
+        else if (arg == "--memory-budget-mb")
+            memoryBudgetMB = std::strtoull(argv[i + 1], nullptr, 10);
+        else if (arg == "--spill-dir")
+            spillDir = argv[i + 1];
+        else if (arg == "--huge-pages")
+            hugePages = argv[i + 1];
+        i++;
     }
-
-    // Get AQI data for a specific date
-    std::vector<AirQualityRecord> getAQIDataForDate(const std::string &targetDate)
+    if (!tracePath.empty())
     {
-        auto start = std::chrono::high_resolution_clock::now();
-
-        std::vector<AirQualityRecord> results;
-
-
-int nThreads = omp_get_max_threads();
-std::vector<std::vector<AirQualityRecord>> localResults(nThreads);
-
-#pragma omp parallel
-{
-    int tid = omp_get_thread_num();
-    auto &local = localResults[tid];
-
-    #pragma omp for nowait
-    for (int i = 0; i < records.size(); i++) {
-        if (records[i].getDate() == targetDate) {
-            local.push_back(records[i]);
-        }
+        TraceRecorder::instance().start();
+        TraceRecorder::instance().setThreadName("main");
     }
-}
 
-// merge results
-for (auto &local : localResults) {
-    results.insert(results.end(),
-                   std::make_move_iterator(local.begin()),
-                   std::make_move_iterator(local.end()));
-}
-
-        auto end = std::chrono::high_resolution_clock::now();
-        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
-
-        std::cout << "Query completed in " << duration.count() << " microseconds" << std::endl;
-        std::cout << "Found " << results.size() << " records for date: " << targetDate << std::endl;
+    // formatting of output done by AI
+    std::cout << "=== Fire Data Analyzer ===" << std::endl;
 
-        return results;
-    }
+    FireDataAnalyzer analyzer;
 
-    // Get dates where AQI was above a threshold
-    std::vector<std::string> getDaysWithAQIAbove(int threshold)
+    if (numa)
     {
-        auto start = std::chrono::high_resolution_clock::now();
-
-        std::map<std::string, int> dateMaxAQI;
-
-        // Find max AQI for each date
-        std::vector<std::unordered_map<std::string, int>> localMaps(omp_get_max_threads());
-
-#pragma omp parallel
-        {
-            int tid = omp_get_thread_num();
-            auto &localMap = localMaps[tid];
-
-#pragma omp for nowait
-            for (int i = 0; i < records.size(); i++)
-            {
-                std::string date = records[i].getDate();
-                int aqi = records[i].aqi;
-                auto it = localMap.find(date);
-                if (it == localMap.end() || aqi > it->second)
-                {
-                    localMap[date] = aqi;
-                }
-            }
-        }
-
-        // merge results
-        for (auto &localMap : localMaps)
-        {
-            for (auto &p : localMap)
-            {
-                auto it = dateMaxAQI.find(p.first);
-                if (it == dateMaxAQI.end() || p.second > it->second)
-                {
-                    dateMaxAQI[p.first] = p.second;
-                }
-            }
-        }
-
-        std::vector<std::string> results;
-        for (const auto &pair : dateMaxAQI)
-        {
-            if (pair.second > threshold)
-            {
-                results.push_back(pair.first);
-            }
-        }
-
-        std::sort(results.begin(), results.end());
-
-        auto end = std::chrono::high_resolution_clock::now();
-        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
-
-        std::cout << "Query completed in " << duration.count() << " microseconds" << std::endl;
-        std::cout << "Found " << results.size() << " days with AQI above " << threshold << std::endl;
-
-        return results;
+        FireDataAnalyzer::pinWorkers();
+        std::cout << "NUMA: " << NumaTopology::instance().describe() << ", " << omp_get_max_threads()
+                  << " threads pinned node by node" << std::endl;
     }
-
-    // Get average AQI for a date
-    double getAverageAQIForDate(const std::string &targetDate)
+    HugePages::Mode hugePageMode = HugePages::OFF;
+    if (!hugePages.empty() && !HugePages::parseMode(hugePages, hugePageMode))
     {
-        auto start = std::chrono::high_resolution_clock::now();
-
-        double totalAQI = 0.0;
-        int count = 0;
-
-#pragma omp parallel for reduction(+:totalAQI, count)
-        for (const auto &record : records)
-        {
-            if (record.getDate() == targetDate)
-            {
-                totalAQI += record.aqi;
-                count++;
-            }
-        }
-
-        auto end = std::chrono::high_resolution_clock::now();
-        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
-
-        std::cout << "Average AQI query completed in " << duration.count() << " microseconds" << std::endl;
-
-        return count > 0 ? totalAQI / count : 0.0;
+        std::cerr << "--huge-pages takes off, thp or explicit" << std::endl;
+        return 1;
     }
-
-    // Get statistics about the loaded data
-    // done by AI
-    void printDataStatistics()
+    analyzer.setHugePages(hugePageMode);
+    if ((lazy || memoryBudgetMB > 0) && (!socketPath.empty() || port >= 0))
     {
-        if (records.empty())
-        {
-            std::cout << "No data loaded." << std::endl;
-            return;
-        }
-
-        std::map<std::string, int> parameterCounts;
-        std::map<std::string, int> dateCounts;
-        int minAQI = records[0].aqi;
-        int maxAQI = records[0].aqi;
-
-        for (const auto &record : records)
-        {
-            parameterCounts[record.parameter]++;
-            dateCounts[record.getDate()]++;
-            minAQI = std::min(minAQI, record.aqi);
-            maxAQI = std::max(maxAQI, record.aqi);
-        }
-
-        std::cout << "\n=== DATA STATISTICS ===" << std::endl;
-        std::cout << "Total records: " << records.size() << std::endl;
-        std::cout << "Date range: " << dateCounts.begin()->first << " to "
-                  << dateCounts.rbegin()->first << std::endl;
-        std::cout << "AQI range: " << minAQI << " to " << maxAQI << std::endl;
-        std::cout << "Number of unique dates: " << dateCounts.size() << std::endl;
-
-        std::cout << "\nParameter distribution:" << std::endl;
-        for (const auto &pair : parameterCounts)
-        {
-            std::cout << "  " << pair.first << ": " << pair.second << " records" << std::endl;
-        }
+        std::cerr << "--lazy / --memory-budget-mb cannot be combined with --serve / --port" << std::endl;
+        return 1;
     }
-};
-
-int main()
-{
-    // formatting of output done by AI
-    std::cout << "=== Fire Data Analyzer ===" << std::endl;
-
-    FireDataAnalyzer analyzer;
-
-    analyzer.loadData("data");
-    analyzer.printDataStatistics();
+    analyzer.setMemoryBudget(memoryBudgetMB << 20);
+    if (!spillDir.empty())
+        analyzer.setSpillDirectory(spillDir);
+    if (lazy)
+        analyzer.openLazy("data");
+    else if (columnarPath.empty())
+        analyzer.loadData("data");
+    else if (!analyzer.loadColumnar(columnarPath))
+        return 1;
+    if (!exportPath.empty() && !analyzer.exportColumnar(exportPath))
+        return 1;
+    if (!socketPath.empty() || port >= 0)
+        return serve(analyzer, socketPath, port, workers);
+    if (!lazy)
+        analyzer.printDataStatistics();
 
     std::cout << "\n=== SAMPLE QUERIES ===" << std::endl;
 
@@ -393,6 +195,19 @@ int main()
     double avgAQI = analyzer.getAverageAQIForDate("2020-08-20");
     std::cout << "Average AQI: " << std::fixed << std::setprecision(2) << avgAQI << std::endl;
 
+    // Composed query: worst PM2.5 sites in the second week of September
+    std::cout << "\n4. Max PM2.5 AQI per site above 150, 2020-09-08 to 2020-09-15 (top 10):" << std::endl;
+    Query worstSites;
+    worstSites.where(Predicate::eq(Column::PARAMETER, "PM2.5"))
+        .where(Predicate::gt(Column::AQI, 150))
+        .where(Predicate::between(Column::DATE, "2020-09-08", "2020-09-15"))
+        .groupBy(Column::SITE_NAME)
+        .aggregate(Aggregate::MAX, Column::AQI)
+        .aggregate(Aggregate::COUNT)
+        .orderBy(0)
+        .limit(10);
+    analyzer.query(worstSites).print(std::cout);
+
     // Additional performance test with multiple queries
     std::cout << "\n=== PERFORMANCE TESTING ===" << std::endl;
 
@@ -407,5 +222,35 @@ int main()
     std::cout << "10 date queries took " << perfDuration.count()
               << " microseconds (avg: " << perfDuration.count() / 10 << " μs per query)" << std::endl;
 
+    if (analyzer.isPartitioned())
+    {
+        FireDataAnalyzer::PartitionStats stats = analyzer.getPartitionStats();
+        std::cout << "\nPartitions: " << stats.resident << " of " << stats.partitions << " resident ("
+                  << stats.residentBytes / (1 << 20) << " MB), " << stats.spilled << " spilled ("
+                  << stats.scratchBytes / (1 << 20) << " MB scratch); " << stats.loads << " loads, "
+                  << stats.pageIns << " page-ins, " << stats.spills << " spills, " << stats.evictions
+                  << " evictions" << std::endl;
+    }
+
+    if (!hugePages.empty())
+    {
+        KernelColumns::PageStats pages = analyzer.getColumnPageStats();
+        HugePages::Stats maps = HugePages::stats();
+        std::cout << "\nColumn arrays: " << pages.bytes / (1 << 20) << " MB, " << pages.hugeBytes / (1 << 20)
+                  << " MB on 2 MB pages (" << HugePages::modeName(hugePageMode) << "; " << maps.explicitMaps
+                  << " hugetlb maps, " << maps.explicitFallbacks << " fallbacks, " << maps.advisedMaps
+                  << " advised)" << std::endl;
+    }
+
+    if (!metricsPath.empty() && MetricsRegistry::instance().writeFile(metricsPath))
+        std::cout << "\nMetrics written to " << metricsPath << std::endl;
+
+    if (!tracePath.empty())
+    {
+        TraceRecorder::instance().stop();
+        if (TraceRecorder::instance().writeFile(tracePath))
+            std::cout << "Trace written to " << tracePath << std::endl;
+    }
+
     return 0;
 }
@@ -0,0 +1,190 @@
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "FireServer.h"
+
+static bool connectTo(QueryClient &client, const std::string &socketPath, int port)
+{
+    return socketPath.empty() ? client.connectTcp(port) : client.connectUnix(socketPath);
+}
+
+// Body and opcode of one load-test request
+static uint16_t loadRequest(const std::string &kind, WireWriter &body)
+{
+    if (kind == "ping")
+        return FireProtocol::PING;
+    if (kind == "avg")
+    {
+        body.str("2020-08-20");
+        return FireProtocol::AVERAGE_AQI;
+    }
+    // Answered from bitmap cardinalities alone
+    Query count;
+    count.where(Predicate::eq(Column::PARAMETER, "PM2.5"))
+        .where(Predicate::eq(Column::DATE, "2020-09-10"))
+        .groupBy(Column::AQI_CATEGORY);
+    FireProtocol::encodeQuery(count, body);
+    return FireProtocol::QUERY;
+}
+
+// connections threads, each sending requests one at a time
+static int loadTest(const std::string &socketPath, int port, int connections, int requests, const std::string &kind)
+{
+    WireWriter body;
+    uint16_t opcode = loadRequest(kind, body);
+    std::vector<std::vector<double>> latencies(connections);
+    std::vector<int> failures(connections, 0);
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int c = 0; c < connections; c++)
+    {
+        threads.emplace_back([&, c]()
+                             {
+            QueryClient client;
+            if (!connectTo(client, socketPath, port))
+            {
+                failures[c] = requests;
+                return;
+            }
+            std::string response;
+            latencies[c].reserve(requests);
+            for (int i = 0; i < requests; i++)
+            {
+                auto sent = std::chrono::steady_clock::now();
+                if (client.call(opcode, body.bytes(), response) != QueryServer::OK)
+                    failures[c]++;
+                latencies[c].push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - sent).count());
+            } });
+    }
+    for (std::thread &t : threads)
+        t.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<double> all;
+    int failed = 0;
+    for (int c = 0; c < connections; c++)
+    {
+        all.insert(all.end(), latencies[c].begin(), latencies[c].end());
+        failed += failures[c];
+    }
+    if (all.empty())
+    {
+        std::cerr << "could not connect" << std::endl;
+        return 1;
+    }
+    std::sort(all.begin(), all.end());
+    auto percentile = [&](double p) { return all[std::min(all.size() - 1, static_cast<size_t>(p * all.size()))]; };
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << kind << ": " << all.size() << " requests over " << connections << " connections in "
+              << seconds * 1000 << " ms" << std::endl;
+    std::cout << "  throughput: " << all.size() / seconds << " requests/s" << std::endl;
+    std::cout << "  latency:    p50 " << percentile(0.50) << " us, p99 " << percentile(0.99)
+              << " us, max " << all.back() << " us" << std::endl;
+    if (failed > 0)
+        std::cout << "  failed:     " << failed << std::endl;
+    return failed > 0 ? 1 : 0;
+}
+
+static void check(uint16_t status, const std::string &response)
+{
+    if (status != QueryServer::OK)
+    {
+        WireReader in(response);
+        throw std::runtime_error("server error " + std::to_string(status) + ": " + in.str());
+    }
+}
+
+// A few sample requests, printed like the analyzer's own output
+static int samples(const std::string &socketPath, int port)
+{
+    QueryClient client;
+    if (!connectTo(client, socketPath, port))
+    {
+        std::cerr << "could not connect" << std::endl;
+        return 1;
+    }
+    std::string response;
+
+    WireWriter date;
+    date.str("2020-08-20");
+    check(client.call(FireProtocol::AVERAGE_AQI, date.bytes(), response), response);
+    WireReader average(response);
+    std::cout << "Average AQI for 2020-08-20: " << std::fixed << std::setprecision(2) << average.f64() << std::endl;
+
+    WireWriter threshold;
+    threshold.i32(150);
+    check(client.call(FireProtocol::DAYS_ABOVE, threshold.bytes(), response), response);
+    WireReader days(response);
+    std::cout << "Days with AQI above 150: " << days.u32() << std::endl;
+
+    Query worstSites;
+    worstSites.where(Predicate::eq(Column::PARAMETER, "PM2.5"))
+        .where(Predicate::gt(Column::AQI, 150))
+        .where(Predicate::between(Column::DATE, "2020-09-08", "2020-09-15"))
+        .groupBy(Column::SITE_NAME)
+        .aggregate(Aggregate::MAX, Column::AQI)
+        .aggregate(Aggregate::COUNT)
+        .orderBy(0)
+        .limit(10);
+    WireWriter request;
+    FireProtocol::encodeQuery(worstSites, request);
+    check(client.call(FireProtocol::QUERY, request.bytes(), response), response);
+    WireReader result(response);
+    QueryResult top = FireProtocol::decodeResult(result);
+    std::cout << "\nMax PM2.5 AQI per site above 150, 2020-09-08 to 2020-09-15 (top 10), "
+              << top.plan << ":" << std::endl;
+    top.print(std::cout);
+    return 0;
+}
+
+// fire-data-client (--socket PATH | --port N) [--load CONNECTIONS REQUESTS [ping|count|avg]]
+//   without --load: a few sample requests
+//   --load: closed-loop load test reporting requests/s and p50 / p99 latency
+int main(int argc, char *argv[])
+{
+    std::string socketPath;
+    int port = -1;
+    int connections = 0;
+    int requests = 0;
+    std::string kind = "count";
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--socket" && i + 1 < argc)
+            socketPath = argv[++i];
+        else if (arg == "--port" && i + 1 < argc)
+            port = std::atoi(argv[++i]);
+        else if (arg == "--load" && i + 2 < argc)
+        {
+            connections = std::max(1, std::atoi(argv[++i]));
+            requests = std::max(1, std::atoi(argv[++i]));
+            if (i + 1 < argc && argv[i + 1][0] != '-')
+                kind = argv[++i];
+        }
+    }
+    if (socketPath.empty() && port < 0)
+    {
+        std::cerr << "usage: fire-data-client (--socket PATH | --port N) [--load CONNECTIONS REQUESTS [ping|count|avg]]"
+                  << std::endl;
+        return 2;
+    }
+
+    try
+    {
+        if (connections > 0)
+            return loadTest(socketPath, port, connections, requests, kind);
+        return samples(socketPath, port);
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+}
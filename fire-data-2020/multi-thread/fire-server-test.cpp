@@ -0,0 +1,172 @@
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <set>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+#include "FireServer.h"
+
+static int failures = 0;
+
+static void expect(bool condition, const std::string &what)
+{
+    std::cout << (condition ? "ok:   " : "FAIL: ") << what << std::endl;
+    if (!condition)
+        failures++;
+}
+
+// Status of one QUERY round trip
+static uint16_t sendQuery(QueryClient &client, const Query &query)
+{
+    WireWriter request;
+    FireProtocol::encodeQuery(query, request);
+    std::string response;
+    return client.call(FireProtocol::QUERY, request.bytes(), response);
+}
+
+// fire-server-test DATA_DIR: serves DATA_DIR on a Unix socket and checks
+// the server's answers to well-formed and malformed requests
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "usage: fire-server-test DATA_DIR" << std::endl;
+        return 2;
+    }
+
+    FireDataAnalyzer analyzer;
+    analyzer.setVerbose(false);
+    analyzer.loadData(argv[1]);
+    if (analyzer.getRecordCount() == 0)
+    {
+        std::cerr << "no records in " << argv[1] << std::endl;
+        return 1;
+    }
+
+    // Numeric group keys keep every distinct value apart, both in one
+    // query and when partial results are merged
+    {
+        std::shared_ptr<const std::vector<AirQualityRecord>> day = analyzer.getAQIDataForDateShared("2020-08-10");
+        std::set<double> latitudes;
+        for (const AirQualityRecord &record : *day)
+            latitudes.insert(record.latitude);
+        Query perLatitude;
+        perLatitude.groupBy(Column::LATITUDE).aggregate(Aggregate::COUNT);
+        QueryResult grouped = analyzer.query(perLatitude);
+        expect(grouped.rows.size() == latitudes.size(),
+               "group by LATITUDE: " + std::to_string(grouped.rows.size()) + " groups for " +
+                   std::to_string(latitudes.size()) + " distinct values");
+
+        QueryEngine engine(*day);
+        std::vector<QueryResult> partials;
+        for (const Predicate &half : {Predicate::eq(Column::PARAMETER, "PM2.5"), Predicate::ne(Column::PARAMETER, "PM2.5")})
+            partials.push_back(engine.execute(QueryEngine::partialQuery(perLatitude).where(half)));
+        QueryResult merged = QueryEngine::mergePartials(perLatitude, partials);
+        expect(merged.rows.size() == latitudes.size(),
+               "merged group by LATITUDE: " + std::to_string(merged.rows.size()) + " groups");
+    }
+
+    std::string socketPath =
+        (std::filesystem::temp_directory_path() / ("fire-server-test-" + std::to_string(getpid()) + ".sock")).string();
+    FireServer server(analyzer, 2);
+    if (!server.listenUnix(socketPath))
+    {
+        std::cerr << server.lastError() << std::endl;
+        return 1;
+    }
+    std::thread loop([&server]() { server.run(); });
+
+    QueryClient client;
+    expect(client.connectUnix(socketPath), "connect");
+
+    Query perSite;
+    perSite.where(Predicate::eq(Column::PARAMETER, "PM2.5"))
+        .groupBy(Column::SITE_NAME)
+        .aggregate(Aggregate::MAX, Column::AQI)
+        .aggregate(Aggregate::COUNT)
+        .orderBy(1);
+    expect(sendQuery(client, perSite) == QueryServer::OK, "order by the last aggregate");
+
+    // orderBy() is not checked until the query runs, so these encode as is
+    Query pastEnd = perSite;
+    pastEnd.orderBy(2);
+    expect(sendQuery(client, pastEnd) == QueryServer::BAD_REQUEST, "order by aggregate past the end is BAD_REQUEST");
+    Query negative = perSite;
+    negative.orderBy(-2);
+    expect(sendQuery(client, negative) == QueryServer::BAD_REQUEST, "order by aggregate -2 is BAD_REQUEST");
+    Query countOnly;
+    countOnly.orderBy(0);
+    expect(sendQuery(client, countOnly) == QueryServer::OK, "order by the implicit COUNT");
+    countOnly.orderBy(1);
+    expect(sendQuery(client, countOnly) == QueryServer::BAD_REQUEST, "order by past the implicit COUNT is BAD_REQUEST");
+
+    // The connection survives the rejected requests
+    std::string response;
+    expect(client.call(FireProtocol::PING, "", response) == QueryServer::OK, "ping after bad requests");
+
+    client.close();
+
+    // Requests sent before a half-close are all answered, then the server
+    // closes the connection
+    {
+        QueryClient halfClosed;
+        halfClosed.connectUnix(socketPath);
+        WireWriter date;
+        date.str("2020-08-10");
+        for (int i = 0; i < 3; i++)
+            halfClosed.send(FireProtocol::AVERAGE_AQI, date.bytes());
+        halfClosed.shutdownWrite();
+        int answered = 0;
+        try
+        {
+            uint32_t id;
+            uint16_t status;
+            while (true)
+            {
+                halfClosed.receive(id, status, response);
+                answered += status == QueryServer::OK;
+            }
+        }
+        catch (const std::runtime_error &)
+        {
+        }
+        expect(answered == 3, "3 requests answered after half-close (got " + std::to_string(answered) + ")");
+    }
+
+    // A client that pipelines far past the in-flight and output caps
+    // without reading still gets every answer once it does read
+    {
+        // A day's records are a few MB, so a dozen fill the output cap;
+        // the pings go past the in-flight cap
+        const int recordRequests = 12;
+        const int requests = recordRequests + 2 * static_cast<int>(wire::kMaxInFlight);
+        QueryClient pipelined;
+        pipelined.connectUnix(socketPath);
+        WireWriter body;
+        body.str("2020-08-10");
+        body.u32(1000000);
+        std::thread sender([&]()
+                           {
+            for (int i = 0; i < requests; i++)
+                pipelined.send(i < recordRequests ? FireProtocol::RECORDS_FOR_DATE : FireProtocol::PING,
+                               i < recordRequests ? body.bytes() : std::string()); });
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        int answered = 0;
+        uint32_t id;
+        uint16_t status;
+        for (int i = 0; i < requests; i++)
+        {
+            pipelined.receive(id, status, response);
+            answered += status == QueryServer::OK;
+        }
+        sender.join();
+        expect(answered == requests, std::to_string(requests) + " pipelined requests answered");
+    }
+
+    server.stop();
+    loop.join();
+    std::cout << (failures == 0 ? "all passed" : std::to_string(failures) + " failed") << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,706 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Synthetic data generator for scaling the fire-data and world-bank
+// benchmarks past the bundled datasets.
+//
+//   datagen --format airnow    --seed-data DIR --out DIR [--site-scale K] [--param-scale K]
+//           [--start YYYY-MM-DD] [--days N | --rows N] [--hour-step H] [--threads N] [--seed S]
+//   datagen --format worldbank --seed-data DIR --out DIR [--country-scale K] [--indicators N]
+//           [--first-year Y] [--last-year Y] [--missing P] [--seed S]
+//
+// Everything is learned from the seed files: AirNow sites, which
+// parameters each site reports and the empirical distribution of every
+// parameter's (value, raw concentration, AQI, category) readings; World
+// Bank population series and the Region / IncomeGroup of every country.
+// Output depends only on the seed, not on the thread count.
+
+namespace {
+
+struct Options {
+    std::string format = "airnow";
+    std::string seedData;
+    std::string outDir;
+    int siteScale = 1;
+    int paramScale = 1;
+    std::string startDate;
+    int days = 0;
+    long long rows = 0;
+    int hourStep = 2;
+    int threads = 0;
+    int countryScale = 1;
+    int indicators = 1;
+    int firstYear = 0;
+    int lastYear = 0;
+    double missing = 0.05;
+    uint64_t seed = 2020;
+};
+
+// ---------------------------------------------------------------------------
+// Deterministic randomness: every value is a hash of (seed, series, time),
+// so files can be written in any order on any number of threads.
+
+uint64_t splitmix(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+uint64_t hashOf(uint64_t a, uint64_t b, uint64_t c = 0) {
+    return splitmix(a ^ splitmix(b ^ splitmix(c)));
+}
+
+double uniformOf(uint64_t h) {
+    return (static_cast<double>(h >> 11) + 0.5) * (1.0 / 9007199254740992.0);
+}
+
+double gaussianOf(uint64_t h) {
+    double u1 = uniformOf(h);
+    double u2 = uniformOf(splitmix(h));
+    return std::sqrt(-2.0 * std::log(u1)) * std::cos(6.283185307179586 * u2);
+}
+
+// Smooth noise: Gaussian values at knots `period` apart, cosine-interpolated
+double smoothNoise(uint64_t key, double t, double period) {
+    double x = t / period;
+    double k = std::floor(x);
+    double f = x - k;
+    double w = (1.0 - std::cos(f * 3.141592653589793)) / 2.0;
+    double a = gaussianOf(hashOf(key, static_cast<uint64_t>(static_cast<int64_t>(k)), 1));
+    double b = gaussianOf(hashOf(key, static_cast<uint64_t>(static_cast<int64_t>(k) + 1), 1));
+    // Interpolation shrinks the variance; rescale back towards 1
+    return (a * (1.0 - w) + b * w) / std::sqrt((1.0 - w) * (1.0 - w) + w * w);
+}
+
+double normalCdf(double z) {
+    return 0.5 * std::erfc(-z / std::sqrt(2.0));
+}
+
+// ---------------------------------------------------------------------------
+// Calendar helpers (proleptic Gregorian, days since 1970-01-01)
+
+long long daysFromCivil(int y, int m, int d) {
+    y -= m <= 2;
+    long long era = (y >= 0 ? y : y - 399) / 400;
+    unsigned yoe = static_cast<unsigned>(y - era * 400);
+    unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<long long>(doe) - 719468;
+}
+
+void civilFromDays(long long z, int& y, int& m, int& d) {
+    z += 719468;
+    long long era = (z >= 0 ? z : z - 146096) / 146097;
+    unsigned doe = static_cast<unsigned>(z - era * 146097);
+    unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    unsigned mp = (5 * doy + 2) / 153;
+    d = static_cast<int>(doy - (153 * mp + 2) / 5 + 1);
+    m = static_cast<int>(mp < 10 ? mp + 3 : mp - 9);
+    y = static_cast<int>(yoe + era * 400 + (m <= 2));
+}
+
+bool parseDate(const std::string& text, long long& day) {
+    int y, m, d;
+    if (std::sscanf(text.c_str(), "%d-%d-%d", &y, &m, &d) != 3 &&
+        std::sscanf(text.c_str(), "%4d%2d%2d", &y, &m, &d) != 3) {
+        return false;
+    }
+    day = daysFromCivil(y, m, d);
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// CSV helpers
+
+// Splits one line of double-quoted, comma-separated fields
+void splitQuoted(const std::string& line, std::vector<std::string>& fields) {
+    fields.clear();
+    std::string current;
+    bool inQuotes = false;
+    for (size_t i = 0; i < line.size(); ++i) {
+        char c = line[i];
+        if (c == '"') {
+            if (inQuotes && i + 1 < line.size() && line[i + 1] == '"') {
+                current += '"';
+                ++i;
+            } else {
+                inQuotes = !inQuotes;
+            }
+        } else if (c == ',' && !inQuotes) {
+            fields.push_back(current);
+            current.clear();
+        } else if (c != '\r') {
+            current += c;
+        }
+    }
+    fields.push_back(current);
+}
+
+void appendQuoted(std::string& out, const std::string& field) {
+    out += '"';
+    for (char c : field) {
+        if (c == '"') out += '"';
+        out += c;
+    }
+    out += '"';
+}
+
+std::vector<std::string> listFiles(const std::string& dir, const std::string& extension) {
+    std::vector<std::string> files;
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(dir)) {
+        if (entry.is_regular_file() && entry.path().extension() == extension) {
+            files.push_back(entry.path().string());
+        }
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+// ---------------------------------------------------------------------------
+// AirNow hourly files
+
+struct Reading {
+    double value;   // sort key for quantile lookups
+    std::string valueText;
+    std::string rawText;
+    std::string aqi;
+    std::string category;
+};
+
+struct ParameterModel {
+    std::string name;
+    std::string unit;
+    std::vector<Reading> readings; // reservoir sample, sorted by value
+    long long seen = 0;
+};
+
+struct Site {
+    double latitude;
+    double longitude;
+    std::string latitudeText;
+    std::string longitudeText;
+    std::string name;
+    std::string agency;
+    std::string siteId;
+    std::string fullSiteId;
+    std::vector<int> parameters;
+};
+
+struct AirNowModel {
+    std::vector<ParameterModel> parameters;
+    std::vector<Site> sites;
+    long long firstDay = 0;
+    long long lastDay = 0;
+};
+
+const size_t kReservoirSize = 50000;
+
+bool learnAirNow(const std::string& seedDir, uint64_t seed, AirNowModel& model) {
+    std::vector<std::string> files = listFiles(seedDir, ".csv");
+    if (files.empty()) {
+        std::cerr << "Error: no .csv files under " << seedDir << std::endl;
+        return false;
+    }
+
+    std::unordered_map<std::string, int> parameterIndex;
+    std::unordered_map<std::string, int> siteIndex;
+    std::vector<std::unordered_set<int>> siteParameters;
+    std::vector<std::string> fields;
+    std::string line;
+    bool anyDate = false;
+
+    for (const std::string& filename : files) {
+        std::ifstream file(filename);
+        while (std::getline(file, line)) {
+            splitQuoted(line, fields);
+            if (fields.size() < 13) continue;
+
+            long long day;
+            if (parseDate(fields[2].substr(0, 10), day)) {
+                model.firstDay = anyDate ? std::min(model.firstDay, day) : day;
+                model.lastDay = anyDate ? std::max(model.lastDay, day) : day;
+                anyDate = true;
+            }
+
+            auto p = parameterIndex.find(fields[3]);
+            if (p == parameterIndex.end()) {
+                p = parameterIndex.emplace(fields[3], static_cast<int>(model.parameters.size())).first;
+                model.parameters.push_back(ParameterModel());
+                model.parameters.back().name = fields[3];
+                model.parameters.back().unit = fields[5];
+            }
+            ParameterModel& parameter = model.parameters[p->second];
+
+            // Reservoir sampling keeps a uniform sample of every reading
+            Reading reading{std::atof(fields[4].c_str()), fields[4], fields[6], fields[7], fields[8]};
+            long long n = ++parameter.seen;
+            if (parameter.readings.size() < kReservoirSize) {
+                parameter.readings.push_back(reading);
+            } else {
+                uint64_t slot = hashOf(seed, static_cast<uint64_t>(p->second), static_cast<uint64_t>(n)) % n;
+                if (slot < kReservoirSize) parameter.readings[slot] = reading;
+            }
+
+            auto s = siteIndex.find(fields[12]);
+            if (s == siteIndex.end()) {
+                s = siteIndex.emplace(fields[12], static_cast<int>(model.sites.size())).first;
+                Site site;
+                site.latitudeText = fields[0];
+                site.longitudeText = fields[1];
+                site.latitude = std::atof(fields[0].c_str());
+                site.longitude = std::atof(fields[1].c_str());
+                site.name = fields[9];
+                site.agency = fields[10];
+                site.siteId = fields[11];
+                site.fullSiteId = fields[12];
+                model.sites.push_back(site);
+                siteParameters.push_back(std::unordered_set<int>());
+            }
+            siteParameters[s->second].insert(p->second);
+        }
+    }
+
+    for (ParameterModel& parameter : model.parameters) {
+        std::sort(parameter.readings.begin(), parameter.readings.end(),
+                  [](const Reading& a, const Reading& b) { return a.value < b.value; });
+    }
+    for (size_t i = 0; i < model.sites.size(); ++i) {
+        model.sites[i].parameters.assign(siteParameters[i].begin(), siteParameters[i].end());
+        std::sort(model.sites[i].parameters.begin(), model.sites[i].parameters.end());
+    }
+
+    std::cout << "Seed: " << files.size() << " files, " << model.sites.size() << " sites, "
+              << model.parameters.size() << " parameters" << std::endl;
+    return true;
+}
+
+// Standardised level of one (site, parameter) series at an absolute hour:
+// a diurnal cycle, multi-day weather swings and hourly noise
+double seriesLevel(uint64_t seriesKey, long long hour) {
+    double phase = uniformOf(hashOf(seriesKey, 7)) * 6.283185307179586;
+    double diurnal = std::sin(6.283185307179586 * (hour % 24) / 24.0 + phase) * std::sqrt(2.0);
+    double weather = smoothNoise(seriesKey, static_cast<double>(hour), 72.0);
+    double hourly = gaussianOf(hashOf(seriesKey, static_cast<uint64_t>(hour), 3));
+    return 0.35 * diurnal + 0.8 * weather + 0.48 * hourly;
+}
+
+struct AirNowPlan {
+    const AirNowModel* model;
+    const Options* options;
+    long long firstDay;
+    int days;
+    std::vector<int> hours;
+};
+
+size_t writeAirNowFile(const AirNowPlan& plan, long long day, int hour) {
+    const AirNowModel& model = *plan.model;
+    const Options& options = *plan.options;
+
+    int y, m, d;
+    civilFromDays(day, y, m, d);
+    char dateDir[16];
+    char fileName[32];
+    char timestamp[32];
+    std::snprintf(dateDir, sizeof(dateDir), "%04d%02d%02d", y, m, d);
+    std::snprintf(fileName, sizeof(fileName), "%s-%02d.csv", dateDir, hour);
+    std::snprintf(timestamp, sizeof(timestamp), "%04d-%02d-%02dT%02d:00", y, m, d, hour);
+    long long absoluteHour = day * 24 + hour;
+
+    std::string out;
+    out.reserve(model.sites.size() * options.siteScale * 4 * options.paramScale * 200);
+    size_t rows = 0;
+    char coordinate[32];
+
+    for (int replica = 0; replica < options.siteScale; ++replica) {
+        for (size_t s = 0; s < model.sites.size(); ++s) {
+            const Site& site = model.sites[s];
+            std::string latitude = site.latitudeText;
+            std::string longitude = site.longitudeText;
+            std::string name = site.name;
+            std::string siteId = site.siteId;
+            std::string fullSiteId = site.fullSiteId;
+            if (replica > 0) {
+                // Replicas scatter around the original site
+                uint64_t h = hashOf(options.seed, s, static_cast<uint64_t>(replica));
+                std::snprintf(coordinate, sizeof(coordinate), "%.6f", site.latitude + gaussianOf(h) * 0.25);
+                latitude = coordinate;
+                std::snprintf(coordinate, sizeof(coordinate), "%.6f", site.longitude + gaussianOf(splitmix(h)) * 0.25);
+                longitude = coordinate;
+                name += " #" + std::to_string(replica);
+                siteId += "-" + std::to_string(replica);
+                fullSiteId += "-" + std::to_string(replica);
+            }
+
+            for (int p : site.parameters) {
+                const ParameterModel& parameter = model.parameters[p];
+                for (int variant = 0; variant < options.paramScale; ++variant) {
+                    uint64_t seriesKey = hashOf(options.seed, (s << 20) | static_cast<uint64_t>(p) << 8 | variant,
+                                                static_cast<uint64_t>(replica));
+                    double u = normalCdf(seriesLevel(seriesKey, absoluteHour));
+                    size_t index = std::min(parameter.readings.size() - 1,
+                                            static_cast<size_t>(u * parameter.readings.size()));
+                    const Reading& reading = parameter.readings[index];
+
+                    std::string parameterName = parameter.name;
+                    if (variant > 0) parameterName += "-" + std::to_string(variant + 1);
+
+                    appendQuoted(out, latitude); out += ',';
+                    appendQuoted(out, longitude); out += ',';
+                    appendQuoted(out, timestamp); out += ',';
+                    appendQuoted(out, parameterName); out += ',';
+                    appendQuoted(out, reading.valueText); out += ',';
+                    appendQuoted(out, parameter.unit); out += ',';
+                    appendQuoted(out, reading.rawText); out += ',';
+                    appendQuoted(out, reading.aqi); out += ',';
+                    appendQuoted(out, reading.category); out += ',';
+                    appendQuoted(out, name); out += ',';
+                    appendQuoted(out, site.agency); out += ',';
+                    appendQuoted(out, siteId); out += ',';
+                    appendQuoted(out, fullSiteId);
+                    out += '\n';
+                    ++rows;
+                }
+            }
+        }
+    }
+
+    std::filesystem::path dir = std::filesystem::path(options.outDir) / dateDir;
+    std::ofstream file(dir / fileName, std::ios::binary);
+    file.write(out.data(), out.size());
+    return rows;
+}
+
+int generateAirNow(const Options& options) {
+    AirNowModel model;
+    if (!learnAirNow(options.seedData, options.seed, model)) {
+        return 1;
+    }
+
+    AirNowPlan plan;
+    plan.model = &model;
+    plan.options = &options;
+    plan.firstDay = model.firstDay;
+    if (!options.startDate.empty() && !parseDate(options.startDate, plan.firstDay)) {
+        std::cerr << "Error: bad --start date " << options.startDate << std::endl;
+        return 1;
+    }
+    for (int hour = 1; hour < 24; hour += options.hourStep) {
+        plan.hours.push_back(hour);
+    }
+
+    size_t readingsPerSite = 0;
+    for (const Site& site : model.sites) readingsPerSite += site.parameters.size();
+    long long rowsPerFile = static_cast<long long>(readingsPerSite) * options.siteScale * options.paramScale;
+    long long rowsPerDay = rowsPerFile * static_cast<long long>(plan.hours.size());
+
+    plan.days = options.days > 0 ? options.days : static_cast<int>(model.lastDay - model.firstDay + 1);
+    if (options.rows > 0) {
+        plan.days = static_cast<int>((options.rows + rowsPerDay - 1) / rowsPerDay);
+    }
+
+    std::cout << "Generating " << plan.days << " days x " << plan.hours.size() << " files x "
+              << rowsPerFile << " rows = " << rowsPerDay * plan.days << " rows into " << options.outDir << std::endl;
+
+    for (int d = 0; d < plan.days; ++d) {
+        int y, m, dd;
+        civilFromDays(plan.firstDay + d, y, m, dd);
+        char dateDir[16];
+        std::snprintf(dateDir, sizeof(dateDir), "%04d%02d%02d", y, m, dd);
+        std::filesystem::create_directories(std::filesystem::path(options.outDir) / dateDir);
+    }
+
+    // Files are independent, so workers just take the next file index
+    long long fileCount = static_cast<long long>(plan.days) * plan.hours.size();
+    std::atomic<long long> next(0);
+    std::atomic<long long> written(0);
+    int threadCount = options.threads > 0 ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threadCount; ++t) {
+        workers.emplace_back([&]() {
+            long long i;
+            while ((i = next.fetch_add(1)) < fileCount) {
+                written += writeAirNowFile(plan, plan.firstDay + i / plan.hours.size(),
+                                           plan.hours[i % plan.hours.size()]);
+            }
+        });
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    std::cout << "Wrote " << written.load() << " rows in " << fileCount << " files" << std::endl;
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+// World Bank wide-format indicator file plus country metadata
+
+struct CountrySeries {
+    std::string name;
+    std::string code;
+    std::vector<double> population; // NaN if missing
+};
+
+int generateWorldBank(const Options& options) {
+    std::string dataFile;
+    std::string metadataFile;
+    for (const auto& entry : std::filesystem::directory_iterator(options.seedData)) {
+        std::string name = entry.path().filename().string();
+        if (name.rfind("API_", 0) == 0 && entry.path().extension() == ".csv") dataFile = entry.path().string();
+        if (name.rfind("Metadata_Country_", 0) == 0) metadataFile = entry.path().string();
+    }
+    if (dataFile.empty() || metadataFile.empty()) {
+        std::cerr << "Error: " << options.seedData << " needs an API_*.csv and a Metadata_Country_*.csv file" << std::endl;
+        return 1;
+    }
+
+    // Population series of every country in the seed
+    std::ifstream data(dataFile, std::ios::binary);
+    std::string line;
+    std::vector<std::string> fields;
+    int seedFirstYear = 0;
+    std::string lastUpdated = "unknown";
+    std::vector<CountrySeries> countries;
+    while (std::getline(data, line)) {
+        splitQuoted(line, fields);
+        if (fields.size() >= 2 && fields[0].find("Last Updated Date") != std::string::npos) {
+            lastUpdated = fields[1];
+        }
+        if (fields.size() < 5) continue;
+        if (fields[0].find("Country Name") != std::string::npos) {
+            seedFirstYear = std::atoi(fields[4].c_str());
+            continue;
+        }
+        if (seedFirstYear == 0 || fields[3] != "SP.POP.TOTL") continue;
+
+        CountrySeries series;
+        series.name = fields[0];
+        series.code = fields[1];
+        for (size_t i = 4; i < fields.size(); ++i) {
+            if (i == fields.size() - 1 && fields[i].empty()) break; // trailing comma
+            series.population.push_back(fields[i].empty() ? NAN : std::atof(fields[i].c_str()));
+        }
+        countries.push_back(series);
+    }
+    if (countries.empty()) {
+        std::cerr << "Error: no SP.POP.TOTL rows in " << dataFile << std::endl;
+        return 1;
+    }
+    int seedYears = static_cast<int>(countries.front().population.size());
+
+    // Region / IncomeGroup per code; aggregates (empty Region) are not replicated
+    std::ifstream metadata(metadataFile, std::ios::binary);
+    std::unordered_map<std::string, std::pair<std::string, std::string>> groups;
+    std::getline(metadata, line);
+    while (std::getline(metadata, line)) {
+        splitQuoted(line, fields);
+        if (fields.size() >= 3) groups[fields[0]] = {fields[1], fields[2]};
+    }
+
+    int firstYear = options.firstYear > 0 ? options.firstYear : seedFirstYear;
+    int lastYear = options.lastYear > 0 ? options.lastYear : seedFirstYear + seedYears - 1;
+    int yearCount = lastYear - firstYear + 1;
+    if (yearCount <= 0) {
+        std::cerr << "Error: empty year range" << std::endl;
+        return 1;
+    }
+
+    // Unused three-letter codes for the replicas
+    std::unordered_set<std::string> usedCodes;
+    for (const CountrySeries& c : countries) usedCodes.insert(c.code);
+    long long nextCode = 0;
+    auto freshCode = [&]() {
+        std::string code;
+        do {
+            long long n = nextCode++;
+            code.clear();
+            if (n < 26 * 26 * 26) {
+                code = {static_cast<char>('A' + n / 676), static_cast<char>('A' + n / 26 % 26), static_cast<char>('A' + n % 26)};
+            } else {
+                code = "X" + std::to_string(n);
+            }
+        } while (usedCodes.count(code));
+        usedCodes.insert(code);
+        return code;
+    };
+
+    std::filesystem::create_directories(options.outDir);
+    std::filesystem::path outData = std::filesystem::path(options.outDir) / std::filesystem::path(dataFile).filename();
+    std::filesystem::path outMetadata = std::filesystem::path(options.outDir) / std::filesystem::path(metadataFile).filename();
+    std::ofstream out(outData, std::ios::binary);
+    std::ofstream outMeta(outMetadata, std::ios::binary);
+
+    out << "\xEF\xBB\xBF\"Data Source\",\"World Development Indicators\",\r\n\r\n"
+        << "\"Last Updated Date\",\"" << lastUpdated << "\",\r\n\r\n"
+        << "\"Country Name\",\"Country Code\",\"Indicator Name\",\"Indicator Code\"";
+    for (int year = firstYear; year <= lastYear; ++year) out << ",\"" << year << "\"";
+    out << ",\r\n";
+    outMeta << "\xEF\xBB\xBF\"Country Code\",\"Region\",\"IncomeGroup\",\"SpecialNotes\",\"TableName\",\r\n";
+
+    std::vector<double> population(yearCount);
+    std::string row;
+    char number[48];
+    long long rowsWritten = 0;
+
+    for (size_t c = 0; c < countries.size(); ++c) {
+        const CountrySeries& source = countries[c];
+        const auto& group = groups[source.code];
+        bool aggregate = group.first.empty();
+        int replicas = aggregate ? 1 : options.countryScale;
+
+        for (int replica = 0; replica < replicas; ++replica) {
+            uint64_t countryKey = hashOf(options.seed, c, static_cast<uint64_t>(replica));
+            std::string code = replica == 0 ? source.code : freshCode();
+            std::string name = replica == 0 ? source.name : source.name + " " + std::to_string(replica + 1);
+
+            // Replicas get a different size and their own growth wobble;
+            // years outside the seed extrapolate the nearest decade's growth
+            double scale = replica == 0 ? 1.0 : std::exp(gaussianOf(countryKey) * 0.5);
+            double drift = 0.0;
+            for (int y = 0; y < yearCount; ++y) {
+                int seedIndex = firstYear + y - seedFirstYear;
+                double base;
+                if (seedIndex >= 0 && seedIndex < seedYears) {
+                    base = source.population[seedIndex];
+                } else {
+                    int edge = seedIndex < 0 ? 0 : seedYears - 1;
+                    int other = seedIndex < 0 ? std::min(10, seedYears - 1) : std::max(0, seedYears - 11);
+                    double a = source.population[edge];
+                    double b = source.population[other];
+                    double rate = (a > 0 && b > 0 && edge != other) ? std::log(a / b) / (edge - other) : 0.0;
+                    base = a * std::exp(rate * (seedIndex - edge));
+                }
+                if (replica > 0) drift += gaussianOf(hashOf(countryKey, static_cast<uint64_t>(y), 5)) * 0.004;
+                population[y] = base * scale * std::exp(drift);
+            }
+
+            for (int k = 0; k < options.indicators; ++k) {
+                row.clear();
+                appendQuoted(row, name); row += ',';
+                appendQuoted(row, code); row += ',';
+                if (k == 0) {
+                    appendQuoted(row, "Population, total"); row += ',';
+                    appendQuoted(row, "SP.POP.TOTL");
+                } else {
+                    appendQuoted(row, "Synthetic indicator " + std::to_string(k)); row += ',';
+                    appendQuoted(row, "SYN.IND." + std::to_string(k));
+                }
+
+                uint64_t seriesKey = hashOf(countryKey, static_cast<uint64_t>(k), 11);
+                double level = std::exp(gaussianOf(seriesKey) * 1.5);
+                for (int y = 0; y < yearCount; ++y) {
+                    row += ',';
+                    double p = population[y];
+                    bool drop = k > 0 && uniformOf(hashOf(seriesKey, static_cast<uint64_t>(y), 13)) < options.missing;
+                    if (!(p > 0) || drop) continue;
+
+                    double value;
+                    if (k == 0) {
+                        std::snprintf(number, sizeof(number), "%.0f", p);
+                    } else if (k % 3 == 1) {
+                        // Share of population (counts)
+                        value = p * std::min(1.0, 0.1 * level) * (1.0 + 0.02 * smoothNoise(seriesKey, y, 8.0));
+                        std::snprintf(number, sizeof(number), "%.0f", value);
+                    } else if (k % 3 == 2) {
+                        // Percentage that wanders over the years
+                        value = 100.0 * normalCdf(std::log(level) + 0.8 * smoothNoise(seriesKey, y, 12.0));
+                        std::snprintf(number, sizeof(number), "%.10g", value);
+                    } else {
+                        // Per-capita amount growing with noise
+                        value = 1000.0 * level * std::exp(0.02 * y + 0.1 * smoothNoise(seriesKey, y, 6.0));
+                        std::snprintf(number, sizeof(number), "%.10g", value);
+                    }
+                    appendQuoted(row, number);
+                }
+                row += ",\r\n";
+                out << row;
+                ++rowsWritten;
+            }
+
+            std::string metaRow;
+            appendQuoted(metaRow, code); metaRow += ',';
+            appendQuoted(metaRow, group.first); metaRow += ',';
+            appendQuoted(metaRow, group.second); metaRow += ',';
+            appendQuoted(metaRow, ""); metaRow += ',';
+            appendQuoted(metaRow, name);
+            outMeta << metaRow << ",\r\n";
+        }
+    }
+
+    std::cout << "Wrote " << rowsWritten << " rows (" << options.indicators << " indicators, "
+              << firstYear << "-" << lastYear << ") to " << outData.string() << std::endl;
+    std::cout << "Wrote country metadata to " << outMetadata.string() << std::endl;
+    return 0;
+}
+
+void usage(const char* program) {
+    std::cerr << "Usage: " << program << " --format airnow|worldbank --seed-data DIR --out DIR [options]\n"
+              << "  airnow:    --site-scale K --param-scale K --start YYYY-MM-DD --days N | --rows N\n"
+              << "             --hour-step H --threads N\n"
+              << "  worldbank: --country-scale K --indicators N --first-year Y --last-year Y --missing P\n"
+              << "  both:      --seed S" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+            return 1;
+        }
+        std::string value = argv[++i];
+        if (arg == "--format") options.format = value;
+        else if (arg == "--seed-data") options.seedData = value;
+        else if (arg == "--out") options.outDir = value;
+        else if (arg == "--site-scale") options.siteScale = std::max(1, std::atoi(value.c_str()));
+        else if (arg == "--param-scale") options.paramScale = std::max(1, std::atoi(value.c_str()));
+        else if (arg == "--start") options.startDate = value;
+        else if (arg == "--days") options.days = std::atoi(value.c_str());
+        else if (arg == "--rows") options.rows = std::atoll(value.c_str());
+        else if (arg == "--hour-step") options.hourStep = std::max(1, std::atoi(value.c_str()));
+        else if (arg == "--threads") options.threads = std::atoi(value.c_str());
+        else if (arg == "--country-scale") options.countryScale = std::max(1, std::atoi(value.c_str()));
+        else if (arg == "--indicators") options.indicators = std::max(1, std::atoi(value.c_str()));
+        else if (arg == "--first-year") options.firstYear = std::atoi(value.c_str());
+        else if (arg == "--last-year") options.lastYear = std::atoi(value.c_str());
+        else if (arg == "--missing") options.missing = std::atof(value.c_str());
+        else if (arg == "--seed") options.seed = std::strtoull(value.c_str(), nullptr, 10);
+        else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (options.seedData.empty() || options.outDir.empty()) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    try {
+        if (options.format == "airnow") return generateAirNow(options);
+        if (options.format == "worldbank") return generateWorldBank(options);
+    } catch (const std::filesystem::filesystem_error& e) {
+        std::cerr << "Filesystem error: " << e.what() << std::endl;
+        return 1;
+    }
+    usage(argv[0]);
+    return 1;
+}
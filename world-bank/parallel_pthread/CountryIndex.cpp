@@ -0,0 +1,115 @@
+#include "CountryIndex.h"
+#include <algorithm>
+#include <unordered_set>
+
+void CountryCodeIndex::build(const std::vector<std::string>& codes) {
+    table.assign(kTableSize, -1);
+    fallback.clear();
+
+    for (size_t i = 0; i < codes.size(); ++i) {
+        int key = pack(codes[i].data(), codes[i].size());
+        if (key >= 0) {
+            if (table[key] < 0) {
+                table[key] = static_cast<int32_t>(i);
+            }
+        } else {
+            fallback.emplace(codes[i], static_cast<int>(i));
+        }
+    }
+}
+
+uint64_t CountryNameIndex::hashName(const char* data, size_t length) {
+    // FNV-1a
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < length; ++i) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+uint64_t CountryNameIndex::mix(uint64_t hash, uint64_t seed) {
+    // splitmix64 finaliser over the seeded hash
+    uint64_t z = hash + seed * 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+void CountryNameIndex::build(const std::vector<std::string>& names) {
+    keys = names;
+    seeds.clear();
+    slotToId.clear();
+
+    // Ids of the distinct names; duplicates keep the first id
+    std::vector<int> ids;
+    std::unordered_set<std::string> seen;
+    for (size_t i = 0; i < names.size(); ++i) {
+        if (seen.insert(names[i]).second) {
+            ids.push_back(static_cast<int>(i));
+        }
+    }
+    if (ids.empty()) {
+        return;
+    }
+
+    size_t slotCount = ids.size();
+    size_t bucketCount = std::max<size_t>(1, slotCount / 4);
+
+    std::vector<uint64_t> hashes(names.size());
+    std::vector<std::vector<int>> buckets(bucketCount);
+    for (int id : ids) {
+        hashes[id] = hashName(names[id].data(), names[id].size());
+        buckets[mix(hashes[id], 0) % bucketCount].push_back(id);
+    }
+
+    std::vector<size_t> order(bucketCount);
+    for (size_t b = 0; b < bucketCount; ++b) {
+        order[b] = b;
+    }
+    std::sort(order.begin(), order.end(),
+              [&](size_t a, size_t b) { return buckets[a].size() > buckets[b].size(); });
+
+    seeds.assign(bucketCount, 0);
+    slotToId.assign(slotCount, -1);
+    std::vector<size_t> slots;
+
+    for (size_t b : order) {
+        const std::vector<int>& bucket = buckets[b];
+        if (bucket.empty()) {
+            break;
+        }
+
+        for (uint32_t seed = 1;; ++seed) {
+            slots.clear();
+            bool fits = true;
+            for (int id : bucket) {
+                size_t slot = mix(hashes[id], seed) % slotCount;
+                if (slotToId[slot] >= 0 || std::find(slots.begin(), slots.end(), slot) != slots.end()) {
+                    fits = false;
+                    break;
+                }
+                slots.push_back(slot);
+            }
+
+            if (fits) {
+                seeds[b] = seed;
+                for (size_t i = 0; i < bucket.size(); ++i) {
+                    slotToId[slots[i]] = bucket[i];
+                }
+                break;
+            }
+        }
+    }
+}
+
+int CountryNameIndex::find(const std::string& name) const {
+    if (slotToId.empty()) {
+        return -1;
+    }
+
+    uint64_t hash = hashName(name.data(), name.size());
+    uint32_t seed = seeds[mix(hash, 0) % seeds.size()];
+    int id = slotToId[mix(hash, seed) % slotToId.size()];
+    return (id >= 0 && keys[id] == name) ? id : -1;
+}
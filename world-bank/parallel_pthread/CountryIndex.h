@@ -0,0 +1,69 @@
+#ifndef COUNTRY_INDEX_H
+#define COUNTRY_INDEX_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Direct-indexed lookup for 3-letter country codes. A code made of A-Z is
+// packed into a 15-bit key (5 bits per letter) that indexes a flat table;
+// anything else falls back to a hash map.
+class CountryCodeIndex {
+private:
+    static const int kTableSize = 1 << 15;
+
+    std::vector<int32_t> table;
+    std::unordered_map<std::string, int> fallback;
+
+public:
+    // Packed key for [A-Z]{3}, -1 for any other code
+    static int pack(const char* code, size_t length) {
+        if (length != 3) {
+            return -1;
+        }
+        unsigned a = static_cast<unsigned char>(code[0]) - 'A';
+        unsigned b = static_cast<unsigned char>(code[1]) - 'A';
+        unsigned c = static_cast<unsigned char>(code[2]) - 'A';
+        if (a >= 26 || b >= 26 || c >= 26) {
+            return -1;
+        }
+        return static_cast<int>((a << 10) | (b << 5) | c);
+    }
+
+    // codes[i] gets id i
+    void build(const std::vector<std::string>& codes);
+
+    // Id of a code, -1 if unknown
+    int find(const std::string& code) const {
+        int key = pack(code.data(), code.size());
+        if (key >= 0) {
+            return table.empty() ? -1 : table[key];
+        }
+        auto it = fallback.find(code);
+        return it != fallback.end() ? it->second : -1;
+    }
+};
+
+// Minimal perfect hash over full country names, built at load time with
+// hash-and-displace: keys are grouped into buckets, and each bucket (largest
+// first) searches for a seed that sends all its keys to free slots. A lookup
+// is two hashes, one seed read and one string compare to reject non-members.
+class CountryNameIndex {
+private:
+    std::vector<uint32_t> seeds;     // one per bucket
+    std::vector<int32_t> slotToId;   // n slots, id of the key stored there
+    std::vector<std::string> keys;   // by id, for membership checks
+
+    static uint64_t hashName(const char* data, size_t length);
+    static uint64_t mix(uint64_t hash, uint64_t seed);
+
+public:
+    // names[i] gets id i; repeated names keep their first id
+    void build(const std::vector<std::string>& names);
+
+    // Id of a name, -1 if unknown
+    int find(const std::string& name) const;
+};
+
+#endif // COUNTRY_INDEX_H
@@ -0,0 +1,195 @@
+#include "GrowthTables.h"
+#include <cmath>
+#include <limits>
+
+namespace {
+
+const double kMissing = std::numeric_limits<double>::quiet_NaN();
+
+int floorLog2(int n) {
+    int result = 0;
+    while ((2 << result) <= n) {
+        ++result;
+    }
+    return result;
+}
+
+} // namespace
+
+GrowthTables::GrowthTables() : firstYear(0), yearCount(0), levels(0), countryCount(0) {
+}
+
+void GrowthTables::build(const IndicatorMatrix& matrix, int first, int years, const std::vector<char>& includedRows) {
+    firstYear = first;
+    yearCount = years;
+    countryCount = includedRows.size();
+    levels = years > 0 ? floorLog2(years) + 1 : 0;
+    included = includedRows;
+
+    // Non-positive values are treated like missing cells, as in countryData
+    population.assign(matrix.values.begin(), matrix.values.begin() + countryCount * yearCount);
+    for (double& value : population) {
+        if (!(value > 0)) {
+            value = kMissing;
+        }
+    }
+
+    yoyDelta.assign(countryCount * yearCount, kMissing);
+    logPrefix.assign(countryCount * yearCount, 0.0);
+    validPairPrefix.assign(countryCount * yearCount, 0);
+    globalTotals.assign(yearCount, 0.0);
+
+    for (size_t row = 0; row < countryCount; ++row) {
+        const double* p = population.data() + cell(row, 0);
+        for (int y = 0; y < yearCount; ++y) {
+            if (included[row] && p[y] == p[y]) {
+                globalTotals[y] += p[y];
+            }
+            if (y == 0) {
+                continue;
+            }
+
+            bool validPair = (p[y] == p[y]) && (p[y - 1] == p[y - 1]);
+            logPrefix[cell(row, y)] = logPrefix[cell(row, y - 1)] + (validPair ? std::log(p[y] / p[y - 1]) : 0.0);
+            validPairPrefix[cell(row, y)] = validPairPrefix[cell(row, y - 1)] + (validPair ? 1 : 0);
+            if (validPair) {
+                yoyDelta[cell(row, y)] = p[y] - p[y - 1];
+            }
+        }
+    }
+
+    // Sparse tables, level 0 is the year itself (or -1 when missing)
+    maxTable.assign(static_cast<size_t>(levels) * countryCount * yearCount, -1);
+    minTable.assign(static_cast<size_t>(levels) * countryCount * yearCount, -1);
+    for (size_t row = 0; row < countryCount; ++row) {
+        for (int y = 0; y < yearCount; ++y) {
+            int16_t offset = population[cell(row, y)] == population[cell(row, y)] ? y : -1;
+            maxTable[tableCell(0, row, y)] = offset;
+            minTable[tableCell(0, row, y)] = offset;
+        }
+    }
+    for (int k = 1; k < levels; ++k) {
+        int half = 1 << (k - 1);
+        for (size_t row = 0; row < countryCount; ++row) {
+            const double* p = population.data() + cell(row, 0);
+            for (int y = 0; y + (1 << k) <= yearCount; ++y) {
+                int16_t a = maxTable[tableCell(k - 1, row, y)];
+                int16_t b = maxTable[tableCell(k - 1, row, y + half)];
+                maxTable[tableCell(k, row, y)] = (a < 0 || (b >= 0 && p[b] > p[a])) ? b : a;
+
+                a = minTable[tableCell(k - 1, row, y)];
+                b = minTable[tableCell(k - 1, row, y + half)];
+                minTable[tableCell(k, row, y)] = (a < 0 || (b >= 0 && p[b] < p[a])) ? b : a;
+            }
+        }
+    }
+}
+
+bool GrowthTables::toColumns(int startYear, int endYear, int& startColumn, int& endColumn) const {
+    startColumn = startYear - firstYear;
+    endColumn = endYear - firstYear;
+    return startColumn >= 0 && endColumn < yearCount && startColumn <= endColumn;
+}
+
+int GrowthTables::rangeArg(const std::vector<int16_t>& table, size_t row, int startColumn, int endColumn, bool wantMax) const {
+    int k = floorLog2(endColumn - startColumn + 1);
+    int a = table[tableCell(k, row, startColumn)];
+    int b = table[tableCell(k, row, endColumn - (1 << k) + 1)];
+    if (a < 0) return b;
+    if (b < 0) return a;
+
+    const double* p = population.data() + cell(row, 0);
+    if (wantMax) {
+        return p[b] > p[a] ? b : a;
+    }
+    return p[b] < p[a] ? b : a;
+}
+
+double GrowthTables::getGlobalTotal(int year) const {
+    int column = year - firstYear;
+    if (column < 0 || column >= yearCount) {
+        return 0.0;
+    }
+    return globalTotals[column];
+}
+
+double GrowthTables::getGlobalGrowth(int startYear, int endYear) const {
+    double startTotal = getGlobalTotal(startYear);
+    double endTotal = getGlobalTotal(endYear);
+    if (startTotal == 0) return 0.0;
+    return (endTotal - startTotal) / startTotal * 100.0;
+}
+
+double GrowthTables::getGrowthRate(size_t row, int startYear, int endYear) const {
+    int s = startYear - firstYear;
+    int e = endYear - firstYear;
+    if (s < 0 || e < 0 || s >= yearCount || e >= yearCount) {
+        return kMissing;
+    }
+    double start = population[cell(row, s)];
+    double end = population[cell(row, e)];
+    return (end - start) / start * 100.0; // NaN propagates from missing cells
+}
+
+double GrowthTables::getCAGR(size_t row, int startYear, int endYear) const {
+    int s, e;
+    if (!toColumns(startYear, endYear, s, e)) {
+        return kMissing;
+    }
+    double ratio = population[cell(row, e)] / population[cell(row, s)];
+    if (std::isnan(ratio)) {
+        return kMissing;
+    }
+    if (s == e) {
+        return 0.0;
+    }
+    return (std::pow(ratio, 1.0 / (e - s)) - 1.0) * 100.0;
+}
+
+double GrowthTables::getMeanLogGrowth(size_t row, int startYear, int endYear) const {
+    int s, e;
+    if (!toColumns(startYear, endYear, s, e)) {
+        return kMissing;
+    }
+    int pairs = validPairPrefix[cell(row, e)] - validPairPrefix[cell(row, s)];
+    if (pairs == 0) {
+        return kMissing;
+    }
+    return (logPrefix[cell(row, e)] - logPrefix[cell(row, s)]) / pairs;
+}
+
+double GrowthTables::getYearOverYearDelta(size_t row, int year) const {
+    int column = year - firstYear;
+    if (column < 0 || column >= yearCount) {
+        return kMissing;
+    }
+    return yoyDelta[cell(row, column)];
+}
+
+bool GrowthTables::getPeak(size_t row, int startYear, int endYear, int& peakYear, double& peakValue) const {
+    int s, e;
+    if (!toColumns(startYear, endYear, s, e)) {
+        return false;
+    }
+    int column = rangeArg(maxTable, row, s, e, true);
+    if (column < 0) {
+        return false;
+    }
+    peakYear = firstYear + column;
+    peakValue = population[cell(row, column)];
+    return true;
+}
+
+bool GrowthTables::getTrough(size_t row, int startYear, int endYear, int& troughYear, double& troughValue) const {
+    int s, e;
+    if (!toColumns(startYear, endYear, s, e)) {
+        return false;
+    }
+    int column = rangeArg(minTable, row, s, e, false);
+    if (column < 0) {
+        return false;
+    }
+    troughYear = firstYear + column;
+    troughValue = population[cell(row, column)];
+    return true;
+}
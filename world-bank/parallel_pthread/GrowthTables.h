@@ -0,0 +1,78 @@
+#ifndef GROWTH_TABLES_H
+#define GROWTH_TABLES_H
+
+#include <cstdint>
+#include <vector>
+#include "IndicatorRegistry.h"
+
+// Tables precomputed from the population matrix at load time so that growth
+// queries over any (startYear, endYear) pair are O(1) per country:
+//   - year-over-year deltas
+//   - prefix sums of log growth (and of the number of valid year pairs)
+//   - per-year global totals over the included (non-aggregate) countries
+//   - sparse tables for range min / max population
+class GrowthTables {
+private:
+    int firstYear;
+    int yearCount;
+    int levels;
+    size_t countryCount;
+
+    // All countries x years, row-major, NaN for missing cells
+    std::vector<double> population;
+    std::vector<double> yoyDelta;
+
+    // logPrefix[y] = sum of log(p[k] / p[k - 1]) over valid k <= y
+    std::vector<double> logPrefix;
+    std::vector<int> validPairPrefix;
+
+    std::vector<double> globalTotals;
+    std::vector<char> included;
+
+    // Sparse tables: level k holds, for every country and year y, the year
+    // offset of the max / min of [y, y + 2^k); -1 if the range has no data
+    std::vector<int16_t> maxTable;
+    std::vector<int16_t> minTable;
+
+    size_t cell(size_t row, int column) const { return row * yearCount + column; }
+    size_t tableCell(int level, size_t row, int column) const {
+        return (static_cast<size_t>(level) * countryCount + row) * yearCount + column;
+    }
+    bool toColumns(int startYear, int endYear, int& startColumn, int& endColumn) const;
+    int rangeArg(const std::vector<int16_t>& table, size_t row, int startColumn, int endColumn, bool wantMax) const;
+
+public:
+    GrowthTables();
+
+    // includedRows[i] is false for aggregates; they keep their per-country
+    // tables but are left out of the global totals
+    void build(const IndicatorMatrix& matrix, int firstYear, int yearCount, const std::vector<char>& includedRows);
+
+    bool isBuilt() const { return yearCount > 0; }
+    bool isIncluded(size_t row) const { return included[row] != 0; }
+    size_t getCountryCount() const { return countryCount; }
+
+    // Sum over included countries with data that year, 0 outside the range
+    double getGlobalTotal(int year) const;
+
+    // Percent change of the global total, 0 if the start total is 0
+    double getGlobalGrowth(int startYear, int endYear) const;
+
+    // Percent change for one country, NaN if either year is missing
+    double getGrowthRate(size_t row, int startYear, int endYear) const;
+
+    // Compound annual growth rate in percent, NaN if either year is missing
+    double getCAGR(size_t row, int startYear, int endYear) const;
+
+    // Mean annual log growth over the valid year pairs in the range
+    double getMeanLogGrowth(size_t row, int startYear, int endYear) const;
+
+    // Change from the previous year, NaN if either year is missing
+    double getYearOverYearDelta(size_t row, int year) const;
+
+    // Largest / smallest population in [startYear, endYear]; false if no data
+    bool getPeak(size_t row, int startYear, int endYear, int& peakYear, double& peakValue) const;
+    bool getTrough(size_t row, int startYear, int endYear, int& troughYear, double& troughValue) const;
+};
+
+#endif // GROWTH_TABLES_H
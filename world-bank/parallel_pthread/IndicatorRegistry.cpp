@@ -0,0 +1,418 @@
+#include "IndicatorRegistry.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include "Decompress.h"
+#include "Metrics.h"
+#include "ThreadAffinity.h"
+
+namespace {
+
+const double kMissing = std::numeric_limits<double>::quiet_NaN();
+
+// Scans one CSV field starting at p. On return [begin, begin + len) holds the
+// field without its surrounding quotes and the result points past the comma.
+const char* scanField(const char* p, const char* end, const char*& begin, size_t& len) {
+    if (p < end && *p == '"') {
+        ++p;
+        begin = p;
+        while (p < end) {
+            if (*p == '"') {
+                if (p + 1 < end && p[1] == '"') {
+                    p += 2; // escaped quote
+                    continue;
+                }
+                break;
+            }
+            ++p;
+        }
+        len = p - begin;
+        while (p < end && *p != ',') {
+            ++p;
+        }
+    } else {
+        begin = p;
+        while (p < end && *p != ',') {
+            ++p;
+        }
+        len = p - begin;
+    }
+    if (p < end) {
+        ++p; // skip the comma
+    }
+    return p;
+}
+
+// Copies a field, collapsing "" escapes
+std::string fieldToString(const char* begin, size_t len) {
+    std::string result(begin, len);
+    if (std::memchr(begin, '"', len) != nullptr) {
+        std::string unescaped;
+        for (size_t i = 0; i < result.size(); ++i) {
+            unescaped += result[i];
+            if (result[i] == '"' && i + 1 < result.size() && result[i + 1] == '"') {
+                ++i;
+            }
+        }
+        result.swap(unescaped);
+    }
+    return result;
+}
+
+// Integers (the common case for counts such as population) are converted
+// inline; anything else goes through strtod
+double parseValue(const char* begin, size_t len) {
+    if (len == 0) {
+        return kMissing;
+    }
+
+    const char* p = begin;
+    const char* end = begin + len;
+    bool negative = (*p == '-');
+    if (negative) {
+        ++p;
+    }
+
+    const char* digits = p;
+    long long value = 0;
+    while (p < end && p - digits < 18 && *p >= '0' && *p <= '9') {
+        value = value * 10 + (*p - '0');
+        ++p;
+    }
+    if (p == end && p != digits) {
+        return negative ? -static_cast<double>(value) : static_cast<double>(value);
+    }
+
+    char* stop = nullptr;
+    double parsed = std::strtod(begin, &stop);
+    return stop == begin ? kMissing : parsed;
+}
+
+// Splits [begin, end) into lines, handling CRLF
+const char* nextLine(const char* p, const char* end, const char*& lineEnd) {
+    const char* newline = static_cast<const char*>(std::memchr(p, '\n', end - p));
+    const char* next = newline ? newline + 1 : end;
+    lineEnd = newline ? newline : end;
+    if (lineEnd > p && lineEnd[-1] == '\r') {
+        --lineEnd;
+    }
+    return next;
+}
+
+void parseChunk(ThreadDataParseChunk* data) {
+    const char* p = data->begin;
+    size_t lineCount = 0;
+    size_t parseErrors = 0;
+
+    while (p < data->end) {
+        const char* lineEnd;
+        const char* next = nextLine(p, data->end, lineEnd);
+
+        if (lineEnd > p) {
+            ++lineCount;
+            IndicatorRegistry::ParsedRow row;
+            const char* cursor = p;
+            int fieldCount = 0;
+            while (fieldCount < 4 && cursor < lineEnd) {
+                cursor = scanField(cursor, lineEnd, row.fields[fieldCount], row.lengths[fieldCount]);
+                ++fieldCount;
+            }
+
+            if (fieldCount == 4 && row.lengths[1] > 0 && row.lengths[3] > 0) {
+                for (int column = 4; column < data->firstYearColumn && cursor < lineEnd; ++column) {
+                    const char* ignored;
+                    size_t ignoredLen;
+                    cursor = scanField(cursor, lineEnd, ignored, ignoredLen);
+                }
+
+                row.valueOffset = data->values->size();
+                for (int y = 0; y < data->yearCount; ++y) {
+                    if (cursor < lineEnd) {
+                        const char* field;
+                        size_t len;
+                        cursor = scanField(cursor, lineEnd, field, len);
+                        double value = parseValue(field, len);
+                        if (value != value && len > 0) {
+                            ++parseErrors; // non-empty cell that is not a number
+                        }
+                        data->values->push_back(value);
+                    } else {
+                        data->values->push_back(kMissing);
+                    }
+                }
+                data->rows->push_back(row);
+            } else {
+                ++parseErrors;
+            }
+        }
+
+        p = next;
+    }
+
+    // Recorded in this worker's thread-local shard
+    METRICS_COUNTER_ADD("indicator_lines_parsed_total", lineCount);
+    METRICS_COUNTER_ADD("indicator_parse_errors_total", parseErrors);
+}
+
+} // namespace
+
+IndicatorRegistry::IndicatorRegistry() : firstYear(0), yearCount(0) {
+}
+
+void IndicatorRegistry::clear() {
+    firstYear = 0;
+    yearCount = 0;
+    countryCodes.clear();
+    countryNames.clear();
+    countryIndex.clear();
+    indicators.clear();
+    indicatorOrder.clear();
+}
+
+bool IndicatorRegistry::parseHeader(const char* begin, const char* end) {
+    const char* p = begin;
+    int column = 0;
+    int firstYearColumn = -1;
+    yearCount = 0;
+
+    while (p < end) {
+        const char* field;
+        size_t len;
+        p = scanField(p, end, field, len);
+
+        if (column >= 4 && len > 0 && len <= 4) {
+            int year = std::atoi(std::string(field, len).c_str());
+            if (year > 0) {
+                if (firstYearColumn < 0) {
+                    firstYearColumn = column;
+                    firstYear = year;
+                }
+                ++yearCount;
+            }
+        }
+        ++column;
+    }
+
+    return firstYearColumn == 4 && yearCount > 0;
+}
+
+bool IndicatorRegistry::loadFromCSV(const std::string& filename, int numThreads, bool pinThreads) {
+    // Read the whole file in one go; the parser threads work on views into it.
+    // .gz / .zst files are decompressed in chunks straight into the buffer.
+    std::string buffer;
+    uint64_t ioStart = MetricsRegistry::now();
+    if (Decompressor::formatOf(filename) != Decompressor::NONE) {
+        std::string error;
+        if (!Decompressor::readAll(filename, buffer, error)) {
+            std::cerr << "Error: " << error << std::endl;
+            return false;
+        }
+    } else {
+        std::ifstream file(filename, std::ios::binary);
+        if (!file.is_open()) {
+            std::cerr << "Error: Could not open file " << filename << std::endl;
+            return false;
+        }
+        file.seekg(0, std::ios::end);
+        buffer.resize(static_cast<size_t>(file.tellg()));
+        file.seekg(0, std::ios::beg);
+        file.read(&buffer[0], buffer.size());
+        file.close();
+    }
+    METRICS_TIME_OBSERVE("indicator_load_phase_seconds{phase=\"io\"}", MetricsRegistry::now() - ioStart);
+    METRICS_COUNTER_ADD("indicator_bytes_read_total", buffer.size());
+
+    clear();
+
+    const char* p = buffer.data();
+    const char* end = p + buffer.size();
+    if (buffer.compare(0, 3, "\xEF\xBB\xBF") == 0) {
+        p += 3; // UTF-8 BOM
+    }
+
+    // Skip the "Data Source" / "Last Updated Date" preamble up to the header
+    const char* dataBegin = nullptr;
+    while (p < end) {
+        const char* lineEnd;
+        const char* next = nextLine(p, end, lineEnd);
+        if (lineEnd - p >= 14 && std::strncmp(p, "\"Country Name\"", 14) == 0) {
+            if (!parseHeader(p, lineEnd)) {
+                std::cerr << "Error: No year columns in header of " << filename << std::endl;
+                return false;
+            }
+            dataBegin = next;
+            break;
+        }
+        p = next;
+    }
+
+    if (dataBegin == nullptr) {
+        std::cerr << "Error: Missing \"Country Name\" header in " << filename << std::endl;
+        return false;
+    }
+
+    // Split the data section into line-aligned chunks, one per thread
+    if (numThreads < 1) {
+        numThreads = 1;
+    }
+    size_t dataSize = end - dataBegin;
+
+    std::vector<pthread_t> threads(numThreads);
+    std::vector<ThreadDataParseChunk> threadData(numThreads);
+    std::vector<std::vector<ParsedRow>> rows(numThreads);
+    std::vector<std::vector<double>> values(numThreads);
+
+    uint64_t parseStart = MetricsRegistry::now();
+    const char* chunkBegin = dataBegin;
+    for (int t = 0; t < numThreads; ++t) {
+        const char* chunkEnd = (t == numThreads - 1) ? end : dataBegin + dataSize * (t + 1) / numThreads;
+        if (chunkEnd < chunkBegin) {
+            chunkEnd = chunkBegin;
+        }
+        if (chunkEnd < end) {
+            const char* newline = static_cast<const char*>(std::memchr(chunkEnd, '\n', end - chunkEnd));
+            chunkEnd = newline ? newline + 1 : end;
+        }
+
+        threadData[t].begin = chunkBegin;
+        threadData[t].end = chunkEnd;
+        threadData[t].firstYearColumn = 4;
+        threadData[t].yearCount = yearCount;
+        threadData[t].rows = &rows[t];
+        threadData[t].values = &values[t];
+        threadData[t].pinIndex = pinThreads ? t : -1;
+
+        pthread_create(&threads[t], NULL, threadWorkerParseChunk, &threadData[t]);
+        chunkBegin = chunkEnd;
+    }
+
+    for (int t = 0; t < numThreads; ++t) {
+        pthread_join(threads[t], NULL);
+    }
+    uint64_t mergeStart = MetricsRegistry::now();
+    METRICS_TIME_OBSERVE("indicator_load_phase_seconds{phase=\"parse\"}", mergeStart - parseStart);
+
+    // Merge in file order: first assign country rows and indicators ...
+    std::vector<std::vector<std::pair<int, IndicatorMatrix*>>> targets(numThreads);
+    for (int t = 0; t < numThreads; ++t) {
+        targets[t].reserve(rows[t].size());
+        for (const ParsedRow& row : rows[t]) {
+            std::string code(row.fields[1], row.lengths[1]);
+            auto countryIt = countryIndex.find(code);
+            if (countryIt == countryIndex.end()) {
+                countryIt = countryIndex.emplace(code, static_cast<int>(countryCodes.size())).first;
+                countryCodes.push_back(code);
+                countryNames.push_back(fieldToString(row.fields[0], row.lengths[0]));
+            }
+
+            std::string indicatorCode(row.fields[3], row.lengths[3]);
+            auto indicatorIt = indicators.find(indicatorCode);
+            if (indicatorIt == indicators.end()) {
+                indicatorIt = indicators.emplace(indicatorCode, IndicatorMatrix()).first;
+                indicatorIt->second.code = indicatorCode;
+                indicatorIt->second.name = fieldToString(row.fields[2], row.lengths[2]);
+                indicatorOrder.push_back(indicatorCode);
+            }
+
+            targets[t].push_back({countryIt->second, &indicatorIt->second});
+        }
+    }
+
+    // ... then size every matrix once and copy the parsed rows into place.
+    // resize() leaves the cells untouched; thread t then writes country
+    // rows [t * n / numThreads, (t + 1) * n / numThreads) of every matrix,
+    // on the CPU it parsed on, so with pinned threads each block of rows
+    // is placed on that thread's node. Workers pin themselves before
+    // touching anything; pinning them after pthread_create returns could
+    // come after the first writes.
+    size_t countryCount = countryCodes.size();
+    std::vector<IndicatorMatrix*> matrices;
+    for (auto& pair : indicators) {
+        pair.second.values.resize(countryCount * yearCount);
+        matrices.push_back(&pair.second);
+    }
+    std::vector<ThreadDataPlaceRows> placeData(numThreads);
+    std::vector<int> owner(countryCount);
+    for (int t = 0; t < numThreads; ++t) {
+        placeData[t].matrices = &matrices;
+        placeData[t].firstRow = countryCount * t / numThreads;
+        placeData[t].endRow = countryCount * (t + 1) / numThreads;
+        placeData[t].yearCount = yearCount;
+        placeData[t].pinIndex = pinThreads ? t : -1;
+        std::fill(owner.begin() + placeData[t].firstRow, owner.begin() + placeData[t].endRow, t);
+    }
+    for (int t = 0; t < numThreads; ++t) {
+        for (size_t i = 0; i < rows[t].size(); ++i) {
+            size_t row = static_cast<size_t>(targets[t][i].first);
+            double* target = targets[t][i].second->values.data() + row * yearCount;
+            const double* source = values[t].data() + rows[t][i].valueOffset;
+            placeData[owner[row]].copies.push_back({target, source});
+        }
+    }
+    for (int t = 0; t < numThreads; ++t) {
+        pthread_create(&threads[t], NULL, threadWorkerPlaceRows, &placeData[t]);
+    }
+    for (int t = 0; t < numThreads; ++t) {
+        pthread_join(threads[t], NULL);
+    }
+
+    size_t rowCount = 0;
+    for (int t = 0; t < numThreads; ++t) {
+        rowCount += rows[t].size();
+    }
+    METRICS_TIME_OBSERVE("indicator_load_phase_seconds{phase=\"merge\"}", MetricsRegistry::now() - mergeStart);
+    METRICS_HISTOGRAM_OBSERVE("indicator_rows_per_file", rowCount);
+
+    return true;
+}
+
+void* IndicatorRegistry::threadWorkerParseChunk(void* arg) {
+    ThreadDataParseChunk* data = static_cast<ThreadDataParseChunk*>(arg);
+    if (data->pinIndex >= 0) {
+        ThreadAffinity::pinCurrent(data->pinIndex);
+    }
+    parseChunk(data);
+    return NULL;
+}
+
+void* IndicatorRegistry::threadWorkerPlaceRows(void* arg) {
+    ThreadDataPlaceRows* data = static_cast<ThreadDataPlaceRows*>(arg);
+    if (data->pinIndex >= 0) {
+        ThreadAffinity::pinCurrent(data->pinIndex);
+    }
+    size_t begin = data->firstRow * data->yearCount;
+    size_t end = data->endRow * data->yearCount;
+    if (begin < end) {
+        for (IndicatorMatrix* matrix : *data->matrices) {
+            double* block = matrix->values.data() + begin;
+            NumaTopology::bindToCurrentNode(block, (end - begin) * sizeof(double));
+            std::fill(block, block + (end - begin), kMissing);
+        }
+    }
+    for (const auto& copy : data->copies) {
+        std::memcpy(copy.first, copy.second, data->yearCount * sizeof(double));
+    }
+    return NULL;
+}
+
+int IndicatorRegistry::getCountryIndex(const std::string& countryCode) const {
+    auto it = countryIndex.find(countryCode);
+    return it != countryIndex.end() ? it->second : -1;
+}
+
+const IndicatorMatrix* IndicatorRegistry::getIndicator(const std::string& indicatorCode) const {
+    auto it = indicators.find(indicatorCode);
+    return it != indicators.end() ? &it->second : nullptr;
+}
+
+double IndicatorRegistry::getValue(const std::string& indicatorCode, const std::string& countryCode, int year) const {
+    const IndicatorMatrix* matrix = getIndicator(indicatorCode);
+    int row = getCountryIndex(countryCode);
+    if (matrix == nullptr || row < 0 || year < firstYear || year >= firstYear + yearCount) {
+        return kMissing;
+    }
+    return matrix->values[static_cast<size_t>(row) * yearCount + (year - firstYear)];
+}
@@ -2,8 +2,12 @@
 #include <algorithm>
 #include <iomanip>
 #include <numeric>
+#include <limits>
+#include "Metrics.h"
+#include "ThreadAffinity.h"
 
-PopulationData::PopulationData() {
+PopulationData::PopulationData()
+    : firstYear(0), yearCount(0), includeAggregates(false), threadCount(4), pinThreads(false) {
     // Initialize available years (1960-2023)
     for (int year = 1960; year <= 2023; ++year) {
         availableYears.push_back(year);
@@ -23,125 +27,154 @@ PopulationData::~PopulationData() {
     pthread_attr_destroy(&threadAttr);
 }
 
-std::vector<std::string> PopulationData::parseCSVLine(const std::string& line) {
-    std::vector<std::string> result;
-    std::string current;
-    bool inQuotes = false;
-    
-    for (size_t i = 0; i < line.length(); ++i) {
-        char c = line[i];
-        
-        if (c == '"') {
-            inQuotes = !inQuotes;
-        } else if (c == ',' && !inQuotes) {
-            result.push_back(current);
-            current.clear();
-        } else {
-            current += c;
-        }
-    }
-    
-    // To Add the last field
-    if (!current.empty()) {
-        result.push_back(current);
-    }
-    
-    return result;
-}
-
-long long PopulationData::stringToLongLong(const std::string& str) {
-    if (str.empty() || str == "\"\"") {
-        return -1; // Indicates no data available
+bool PopulationData::loadFromCSV(const std::string& filename) {
+    METRICS_SCOPED_TIMER("population_load_seconds");
+    if (!indicators.loadFromCSV(filename, threadCount, pinThreads)) {
+        return false;
     }
     
-    try {
-        return std::stoll(str);
-    } catch (const std::exception&) {
-        return -1; // Indicates invalid data
-    }
-}
-
-bool PopulationData::loadFromCSV(const std::string& filename) {
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-        std::cerr << "Error: Could not open file " << filename << std::endl;
+    const IndicatorMatrix* population = indicators.getIndicator("SP.POP.TOTL");
+    if (population == nullptr) {
+        std::cerr << "Error: No \"Population, total\" (SP.POP.TOTL) rows in " << filename << std::endl;
         return false;
     }
     
-    std::string line;
+    // Year range comes from the file header
+    firstYear = indicators.getFirstYear();
+    yearCount = indicators.getYearCount();
+    availableYears.clear();
+    for (int year = firstYear; year <= indicators.getLastYear(); ++year) {
+        availableYears.push_back(year);
+    }
     
-    while (std::getline(file, line)) {
-        
-        // To Skip empty lines and header lines
-        if (line.empty() || line.find("Data Source") != std::string::npos || 
-            line.find("Last Updated Date") != std::string::npos) {
-            continue;
-        }
-        
-        // To Skip the header line with column names (starts with "Country Name")
-        if (line.find("Country Name") != std::string::npos) {
-            continue;
-        }
+    countryData.clear();
+    countryNames.clear();
+    populationMatrix.assign(indicators.getCountryCount() * yearCount, -1);
+    for (size_t row = 0; row < indicators.getCountryCount(); ++row) {
+        const std::string& countryCode = indicators.getCountryCode(row);
+        const double* values = population->values.data() + row * yearCount;
         
-        std::vector<std::string> fields = parseCSVLine(line);
+        countryNames[countryCode] = indicators.getCountryName(row);
         
-        // Expected format: Country Name, Country Code, Indicator Name, Indicator Code, 1960, 1961, ..., 2023
-        if (fields.size() < 68) { // 4 metadata columns + 64 years (1960-2023)
-            continue;
-        }
-        
-        std::string countryName = fields[0];
-        std::string countryCode = fields[1];
-        std::string indicatorName = fields[2];
-        
-        
-        if (indicatorName != "Population, total") {
-            continue;
-        }
-        
-        // Store country name
-        countryNames[countryCode] = countryName;
-        
-        // Parse population data for each year
-        for (int i = 4; i < static_cast<int>(fields.size()) && i < 68; ++i) {
-            int year = 1960 + (i - 4);
-            long long population = stringToLongLong(fields[i]);
-            
-            if (population > 0) { // Only store valid population data
-                countryData[countryCode][year] = population;
+        for (int y = 0; y < yearCount; ++y) {
+            if (values[y] > 0) { // Only store valid population data (NaN marks a missing cell)
+                countryData[countryCode][firstYear + y] = static_cast<long long>(values[y]);
+                populationMatrix[row * yearCount + y] = static_cast<long long>(values[y]);
             }
         }
     }
     
-    file.close();
+    codeIndex.build(indicators.getCountryCodes());
+    nameIndex.build(indicators.getCountryNames());
+    
+    if (countryGroups.isLoaded()) {
+        countryGroups.bind(indicators);
+    }
+    rebuildGrowthTables();
     
     std::cout << "Loaded data for " << countryData.size() << " countries" << std::endl;
     return true;
 }
 
-long long PopulationData::getPopulation(const std::string& countryCode, int year) {
-    auto countryIt = countryData.find(countryCode);
-    if (countryIt == countryData.end()) {
-        return -1; // Country not found
+const IndicatorRegistry& PopulationData::getIndicators() const {
+    return indicators;
+}
+
+void PopulationData::setThreadCount(int threads) {
+    threadCount = std::max(1, threads);
+}
+
+int PopulationData::getThreadCount() const {
+    return threadCount;
+}
+
+void PopulationData::setPinThreads(bool pin) {
+    pinThreads = pin;
+}
+
+bool PopulationData::loadCountryMetadata(const std::string& filename) {
+    if (!countryGroups.loadFromCSV(filename)) {
+        return false;
     }
+    countryGroups.bind(indicators);
+    rebuildGrowthTables();
+    return true;
+}
+
+bool PopulationData::isAggregate(const std::string& countryCode) const {
+    return countryGroups.isAggregate(countryCode);
+}
+
+void PopulationData::setIncludeAggregates(bool include) {
+    includeAggregates = include;
+    rebuildGrowthTables();
+}
+
+bool PopulationData::includeInScan(const std::string& countryCode) const {
+    return includeAggregates || !countryGroups.isAggregate(countryCode);
+}
+
+std::vector<std::pair<std::string, long long>> PopulationData::getPopulationByGroup(int year, CountryGroups::Grouping grouping) const {
+    METRICS_SCOPED_TIMER("population_query_seconds{query=\"population_by_group\"}");
+    std::vector<std::pair<std::string, long long>> results;
     
-    auto yearIt = countryIt->second.find(year);
-    if (yearIt == countryIt->second.end()) {
-        return -1; // Year not found for this country
+    const IndicatorMatrix* population = indicators.getIndicator("SP.POP.TOTL");
+    if (population == nullptr || year < indicators.getFirstYear() || year > indicators.getLastYear()) {
+        return results;
     }
     
-    return yearIt->second;
+    int yearCount = indicators.getYearCount();
+    std::vector<double> totals = countryGroups.sumByGroup(*population, yearCount, grouping);
+    const std::vector<std::string>& names = countryGroups.getGroupNames(grouping);
+    
+    int column = year - indicators.getFirstYear();
+    for (size_t g = 0; g < names.size(); ++g) {
+        results.push_back({names[g], static_cast<long long>(totals[g * yearCount + column])});
+    }
+    return results;
+}
+
+std::vector<std::pair<std::string, long long>> PopulationData::getPopulationByRegion(int year) const {
+    return getPopulationByGroup(year, CountryGroups::REGION);
+}
+
+std::vector<std::pair<std::string, long long>> PopulationData::getPopulationByIncomeGroup(int year) const {
+    return getPopulationByGroup(year, CountryGroups::INCOME_GROUP);
+}
+
+long long PopulationData::getPopulation(const std::string& countryCode, int year) {
+    return getPopulationById(codeIndex.find(countryCode), year);
 }
 
 long long PopulationData::getPopulationByName(const std::string& countryName, int year) {
-    // Find country code by name
-    for (const auto& pair : countryNames) {
-        if (pair.second == countryName) {
-            return getPopulation(pair.first, year);
+    return getPopulationById(nameIndex.find(countryName), year);
+}
+
+int PopulationData::resolveCountry(const std::string& countryCode) const {
+    return codeIndex.find(countryCode);
+}
+
+void PopulationData::getPopulationBatch(const int* countryIds, const int* years, size_t count, long long* out) const {
+    const size_t prefetchDistance = 16;
+    const long long* matrix = populationMatrix.data();
+    const unsigned countryCount = static_cast<unsigned>(indicators.getCountryCount());
+    
+    for (size_t i = 0; i < count; ++i) {
+#if defined(__GNUC__)
+        if (i + prefetchDistance < count) {
+            unsigned aheadId = static_cast<unsigned>(countryIds[i + prefetchDistance]);
+            unsigned aheadColumn = static_cast<unsigned>(years[i + prefetchDistance] - firstYear);
+            if (aheadId < countryCount && aheadColumn < static_cast<unsigned>(yearCount)) {
+                __builtin_prefetch(matrix + static_cast<size_t>(aheadId) * yearCount + aheadColumn);
+            }
         }
+#endif
+        unsigned id = static_cast<unsigned>(countryIds[i]);
+        unsigned column = static_cast<unsigned>(years[i] - firstYear);
+        out[i] = (id < countryCount && column < static_cast<unsigned>(yearCount))
+                     ? matrix[static_cast<size_t>(id) * yearCount + column]
+                     : -1;
     }
-    
-    return -1; 
 }
 
 const std::vector<int>& PopulationData::getAvailableYears() const {
@@ -149,11 +182,8 @@ const std::vector<int>& PopulationData::getAvailableYears() const {
 }
 
 std::string PopulationData::getCountryName(const std::string& countryCode) const {
-    auto it = countryNames.find(countryCode);
-    if (it != countryNames.end()) {
-        return it->second;
-    }
-    return "";
+    int id = codeIndex.find(countryCode);
+    return id >= 0 ? indicators.getCountryName(id) : "";
 }
 
 std::vector<std::string> PopulationData::getAllCountries() const {
@@ -228,6 +258,7 @@ void PopulationData::printAllCountries() const {
 
 // Parallel processing implementations
 std::vector<std::pair<std::string, long long>> PopulationData::getTopCountriesByPopulation(int year, int topN, bool useParallel) {
+    METRICS_SCOPED_TIMER("population_query_seconds{query=\"top_countries\"}");
     std::vector<std::pair<std::string, long long>> results;
     
     if (useParallel) {
@@ -236,12 +267,14 @@ std::vector<std::pair<std::string, long long>> PopulationData::getTopCountriesBy
         
         std::vector<std::pair<std::string, std::unordered_map<int, long long>>> countryVector;
         for (const auto& country : countryData) {
-            countryVector.push_back(country);
+            if (includeInScan(country.first)) {
+                countryVector.push_back(country);
+            }
         }
         
         // Get number of threads
-        int numThreads = 4; // Use fixed number for better control
-        if (countryVector.size() < numThreads) {
+        int numThreads = threadCount;
+        if (countryVector.size() < static_cast<size_t>(numThreads)) {
             numThreads = countryVector.size();
         }
         
@@ -259,6 +292,9 @@ std::vector<std::pair<std::string, long long>> PopulationData::getTopCountriesBy
             threadData[t].end = (t == numThreads - 1) ? countryVector.size() : (t + 1) * chunkSize;
             
             pthread_create(&threads[t], &threadAttr, threadWorkerTopCountries, &threadData[t]);
+            if (pinThreads) {
+                ThreadAffinity::pin(threads[t], t);
+            }
         }
         
         // Wait for all threads to complete
@@ -276,6 +312,8 @@ std::vector<std::pair<std::string, long long>> PopulationData::getTopCountriesBy
     } else {
         // Single-threaded implementation
         for (const auto& country : countryData) {
+            if (!includeInScan(country.first)) continue;
+            
             auto yearIt = country.second.find(year);
             if (yearIt != country.second.end() && yearIt->second > 0) {
                 results.push_back({country.first, yearIt->second});
@@ -296,93 +334,42 @@ std::vector<std::pair<std::string, long long>> PopulationData::getTopCountriesBy
 }
 
 double PopulationData::calculateGlobalPopulationGrowth(int startYear, int endYear, bool useParallel) {
-    long long startPopulation = 0;
-    long long endPopulation = 0;
-    
-    if (useParallel) {
-        // Parallel implementation using pthreads
-
-        std::vector<std::pair<std::string, std::unordered_map<int, long long>>> countryVector;
-        for (const auto& country : countryData) {
-            countryVector.push_back(country);
-        }
-        
-        int numThreads = 4;
-        if (countryVector.size() < numThreads) {
-            numThreads = countryVector.size();
-        }
-        
-        pthread_t threads[numThreads];
-        ThreadDataGlobalGrowth threadData[numThreads];
-        size_t chunkSize = countryVector.size() / numThreads;
-        
-        for (int t = 0; t < numThreads; ++t) {
-            threadData[t].data = this;
-            threadData[t].countryVector = &countryVector;
-            threadData[t].startYear = startYear;
-            threadData[t].endYear = endYear;
-            threadData[t].startPopulation = &startPopulation;
-            threadData[t].endPopulation = &endPopulation;
-            threadData[t].start = t * chunkSize;
-            threadData[t].end = (t == numThreads - 1) ? countryVector.size() : (t + 1) * chunkSize;
-            
-            pthread_create(&threads[t], &threadAttr, threadWorkerGlobalGrowth, &threadData[t]);
-        }
-        
-        // Wait for all threads to complete
-        for (int t = 0; t < numThreads; ++t) {
-            pthread_join(threads[t], NULL);
-        }
-    } else {
-        // Single-threaded implementation
-        for (const auto& country : countryData) {
-            auto startIt = country.second.find(startYear);
-            auto endIt = country.second.find(endYear);
-            
-            if (startIt != country.second.end() && startIt->second > 0) {
-                startPopulation += startIt->second;
-            }
-            if (endIt != country.second.end() && endIt->second > 0) {
-                endPopulation += endIt->second;
-            }
-        }
-    }
-    
-    if (startPopulation == 0) return 0.0;
-    return ((double)(endPopulation - startPopulation) / startPopulation) * 100.0;
+    METRICS_SCOPED_TIMER("population_query_seconds{query=\"global_growth\"}");
+    // Answered from the per-year global totals built at load time, so there is
+    // nothing left to split across threads
+    (void)useParallel;
+    return growthTables.getGlobalGrowth(startYear, endYear);
 }
 
 std::vector<std::pair<std::string, double>> PopulationData::calculateCountryGrowthRates(int startYear, int endYear, bool useParallel) {
+    METRICS_SCOPED_TIMER("population_query_seconds{query=\"country_growth_rates\"}");
     std::vector<std::pair<std::string, double>> results;
+    size_t countryCount = growthTables.getCountryCount();
     
     if (useParallel) {
         std::vector<std::pair<std::string, double>> tempResults;
         
-        // Convert to vector for parallel processing
-        std::vector<std::pair<std::string, std::unordered_map<int, long long>>> countryVector;
-        for (const auto& country : countryData) {
-            countryVector.push_back(country);
-        }
-        
-        int numThreads = 4;
-        if (countryVector.size() < numThreads) {
-            numThreads = countryVector.size();
+        int numThreads = threadCount;
+        if (countryCount < static_cast<size_t>(numThreads)) {
+            numThreads = countryCount;
         }
         
         pthread_t threads[numThreads];
         ThreadDataGrowthRates threadData[numThreads];
-        size_t chunkSize = countryVector.size() / numThreads;
+        size_t chunkSize = numThreads > 0 ? countryCount / numThreads : 0;
         
         for (int t = 0; t < numThreads; ++t) {
             threadData[t].data = this;
-            threadData[t].countryVector = &countryVector;
             threadData[t].startYear = startYear;
             threadData[t].endYear = endYear;
             threadData[t].results = &tempResults;
             threadData[t].start = t * chunkSize;
-            threadData[t].end = (t == numThreads - 1) ? countryVector.size() : (t + 1) * chunkSize;
+            threadData[t].end = (t == numThreads - 1) ? countryCount : (t + 1) * chunkSize;
             
             pthread_create(&threads[t], &threadAttr, threadWorkerGrowthRates, &threadData[t]);
+            if (pinThreads) {
+                ThreadAffinity::pin(threads[t], t);
+            }
         }
         
         for (int t = 0; t < numThreads; ++t) {
@@ -391,15 +378,13 @@ std::vector<std::pair<std::string, double>> PopulationData::calculateCountryGrow
         
         results = std::move(tempResults);
     } else {
-        // Single-threaded implementation
-        for (const auto& country : countryData) {
-            auto startIt = country.second.find(startYear);
-            auto endIt = country.second.find(endYear);
+        // Single-threaded implementation, O(1) per country from the growth tables
+        for (size_t row = 0; row < countryCount; ++row) {
+            if (!growthTables.isIncluded(row)) continue;
             
-            if (startIt != country.second.end() && endIt != country.second.end() && 
-                startIt->second > 0 && endIt->second > 0) {
-                double growthRate = ((double)(endIt->second - startIt->second) / startIt->second) * 100.0;
-                results.push_back({country.first, growthRate});
+            double growthRate = growthTables.getGrowthRate(row, startYear, endYear);
+            if (growthRate == growthRate) {
+                results.push_back({indicators.getCountryCode(row), growthRate});
             }
         }
     }
@@ -411,19 +396,70 @@ std::vector<std::pair<std::string, double>> PopulationData::calculateCountryGrow
     return results;
 }
 
+double PopulationData::calculateCAGR(const std::string& countryCode, int startYear, int endYear) const {
+    int row = indicators.getCountryIndex(countryCode);
+    if (row < 0 || !growthTables.isBuilt()) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    return growthTables.getCAGR(row, startYear, endYear);
+}
+
+std::pair<int, long long> PopulationData::getPeakPopulation(const std::string& countryCode, int startYear, int endYear) const {
+    int row = indicators.getCountryIndex(countryCode);
+    int peakYear;
+    double peakValue;
+    if (row < 0 || !growthTables.isBuilt() || !growthTables.getPeak(row, startYear, endYear, peakYear, peakValue)) {
+        return {-1, -1};
+    }
+    return {peakYear, static_cast<long long>(peakValue)};
+}
+
+std::vector<double> PopulationData::calculateGlobalGrowthMatrix() const {
+    METRICS_SCOPED_TIMER("population_query_seconds{query=\"global_growth_matrix\"}");
+    size_t years = availableYears.size();
+    std::vector<double> matrix(years * years, 0.0);
+    
+    for (size_t s = 0; s < years; ++s) {
+        for (size_t e = 0; e < years; ++e) {
+            matrix[s * years + e] = growthTables.getGlobalGrowth(availableYears[s], availableYears[e]);
+        }
+    }
+    return matrix;
+}
+
+const GrowthTables& PopulationData::getGrowthTables() const {
+    return growthTables;
+}
+
+void PopulationData::rebuildGrowthTables() {
+    const IndicatorMatrix* population = indicators.getIndicator("SP.POP.TOTL");
+    if (population == nullptr) {
+        return;
+    }
+    
+    std::vector<char> includedRows(indicators.getCountryCount());
+    for (size_t row = 0; row < includedRows.size(); ++row) {
+        includedRows[row] = includeInScan(indicators.getCountryCode(row)) ? 1 : 0;
+    }
+    growthTables.build(*population, indicators.getFirstYear(), indicators.getYearCount(), includedRows);
+}
+
 long long PopulationData::calculateTotalWorldPopulation(int year, bool useParallel) {
+    METRICS_SCOPED_TIMER("population_query_seconds{query=\"world_population\"}");
     long long totalPopulation = 0;
     
     if (useParallel) {
 
         std::vector<std::pair<std::string, std::unordered_map<int, long long>>> countryVector;
         for (const auto& country : countryData) {
-            countryVector.push_back(country);
+            if (includeInScan(country.first)) {
+                countryVector.push_back(country);
+            }
         }
         
         // Get number of threads
-        int numThreads = 4;
-        if (countryVector.size() < numThreads) {
+        int numThreads = threadCount;
+        if (countryVector.size() < static_cast<size_t>(numThreads)) {
             numThreads = countryVector.size();
         }
         
@@ -440,6 +476,9 @@ long long PopulationData::calculateTotalWorldPopulation(int year, bool useParall
             threadData[t].end = (t == numThreads - 1) ? countryVector.size() : (t + 1) * chunkSize;
             
             pthread_create(&threads[t], &threadAttr, threadWorkerWorldPopulation, &threadData[t]);
+            if (pinThreads) {
+                ThreadAffinity::pin(threads[t], t);
+            }
         }
         
         // Wait for all threads to complete
@@ -449,6 +488,8 @@ long long PopulationData::calculateTotalWorldPopulation(int year, bool useParall
     } else {
         // Single-threaded implementation
         for (const auto& country : countryData) {
+            if (!includeInScan(country.first)) continue;
+            
             auto yearIt = country.second.find(year);
             if (yearIt != country.second.end() && yearIt->second > 0) {
                 totalPopulation += yearIt->second;
@@ -460,6 +501,7 @@ long long PopulationData::calculateTotalWorldPopulation(int year, bool useParall
 }
 
 std::vector<std::pair<std::string, long long>> PopulationData::findCountriesWithPopulationAbove(long long threshold, int year, bool useParallel) {
+    METRICS_SCOPED_TIMER("population_query_seconds{query=\"countries_above\"}");
     std::vector<std::pair<std::string, long long>> results;
     
     if (useParallel) {
@@ -469,12 +511,14 @@ std::vector<std::pair<std::string, long long>> PopulationData::findCountriesWith
         // Convert to vector for parallel processing
         std::vector<std::pair<std::string, std::unordered_map<int, long long>>> countryVector;
         for (const auto& country : countryData) {
-            countryVector.push_back(country);
+            if (includeInScan(country.first)) {
+                countryVector.push_back(country);
+            }
         }
         
         // Get number of threads
-        int numThreads = 4;
-        if (countryVector.size() < numThreads) {
+        int numThreads = threadCount;
+        if (countryVector.size() < static_cast<size_t>(numThreads)) {
             numThreads = countryVector.size();
         }
         
@@ -492,6 +536,9 @@ std::vector<std::pair<std::string, long long>> PopulationData::findCountriesWith
             threadData[t].end = (t == numThreads - 1) ? countryVector.size() : (t + 1) * chunkSize;
             
             pthread_create(&threads[t], &threadAttr, threadWorkerLargeCountries, &threadData[t]);
+            if (pinThreads) {
+                ThreadAffinity::pin(threads[t], t);
+            }
         }
         
         // Wait for all threads to complete
@@ -503,6 +550,8 @@ std::vector<std::pair<std::string, long long>> PopulationData::findCountriesWith
     } else {
         // Single-threaded implementation
         for (const auto& country : countryData) {
+            if (!includeInScan(country.first)) continue;
+            
             auto yearIt = country.second.find(year);
             if (yearIt != country.second.end() && yearIt->second >= threshold) {
                 results.push_back({country.first, yearIt->second});
@@ -567,6 +616,16 @@ void PopulationData::performComprehensiveAnalysis(bool useParallel) {
                   << std::setw(8) << std::right << std::fixed << std::setprecision(2) 
                   << growthRates[i].second << "%" << std::endl;
     }
+    
+    // Analysis 6: Population by region in 2020
+    auto regions = getPopulationByRegion(2020);
+    if (!regions.empty()) {
+        std::cout << "\n6. Population by Region (2020):" << std::endl;
+        for (const auto& region : regions) {
+            std::cout << "  " << std::setw(30) << std::left << region.first 
+                      << std::setw(15) << std::right << region.second << std::endl;
+        }
+    }
 }
 
 // Pthread worker functions
@@ -588,43 +647,17 @@ void* PopulationData::threadWorkerTopCountries(void* arg) {
     return NULL;
 }
 
-void* PopulationData::threadWorkerGlobalGrowth(void* arg) {
-    ThreadDataGlobalGrowth* data = static_cast<ThreadDataGlobalGrowth*>(arg);
-    long long localStartPop = 0;
-    long long localEndPop = 0;
-    
-    for (size_t i = data->start; i < data->end; ++i) {
-        auto startIt = (*data->countryVector)[i].second.find(data->startYear);
-        auto endIt = (*data->countryVector)[i].second.find(data->endYear);
-        
-        if (startIt != (*data->countryVector)[i].second.end() && startIt->second > 0) {
-            localStartPop += startIt->second;
-        }
-        if (endIt != (*data->countryVector)[i].second.end() && endIt->second > 0) {
-            localEndPop += endIt->second;
-        }
-    }
-    
-    pthread_mutex_lock(&data->data->resultsMutex);
-    *data->startPopulation += localStartPop;
-    *data->endPopulation += localEndPop;
-    pthread_mutex_unlock(&data->data->resultsMutex);
-    
-    return NULL;
-}
-
 void* PopulationData::threadWorkerGrowthRates(void* arg) {
     ThreadDataGrowthRates* data = static_cast<ThreadDataGrowthRates*>(arg);
+    const GrowthTables& tables = data->data->growthTables;
     std::vector<std::pair<std::string, double>> localResults;
     
-    for (size_t i = data->start; i < data->end; ++i) {
-        auto startIt = (*data->countryVector)[i].second.find(data->startYear);
-        auto endIt = (*data->countryVector)[i].second.find(data->endYear);
+    for (size_t row = data->start; row < data->end; ++row) {
+        if (!tables.isIncluded(row)) continue;
         
-        if (startIt != (*data->countryVector)[i].second.end() && endIt != (*data->countryVector)[i].second.end() && 
-            startIt->second > 0 && endIt->second > 0) {
-            double growthRate = ((double)(endIt->second - startIt->second) / startIt->second) * 100.0;
-            localResults.push_back({(*data->countryVector)[i].first, growthRate});
+        double growthRate = tables.getGrowthRate(row, data->startYear, data->endYear);
+        if (growthRate == growthRate) {
+            localResults.push_back({data->data->indicators.getCountryCode(row), growthRate});
         }
     }
     
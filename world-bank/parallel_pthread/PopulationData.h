@@ -10,6 +10,10 @@
 #include <iostream>
 #include <pthread.h>
 #include <cstring>
+#include "IndicatorRegistry.h"
+#include "CountryGroups.h"
+#include "CountryIndex.h"
+#include "GrowthTables.h"
 
 class PopulationData {
 private:
@@ -24,19 +28,42 @@ private:
     // Available years for queries
     std::vector<int> availableYears;
     
+    // Every indicator found in the loaded file, keyed by indicator code
+    IndicatorRegistry indicators;
+    
+    // Dense copy of the population matrix for id-based lookups:
+    // populationMatrix[countryId * yearCount + (year - firstYear)], -1 if missing
+    std::vector<long long> populationMatrix;
+    int firstYear;
+    int yearCount;
+    
+    // Perfect-hash indexes from country code / full name to matrix row
+    CountryCodeIndex codeIndex;
+    CountryNameIndex nameIndex;
+    
+    // Region / IncomeGroup metadata; aggregates are left out of country scans
+    // unless includeAggregates is set
+    CountryGroups countryGroups;
+    bool includeAggregates;
+    
+    // Prefix sums / sparse tables over the population matrix, rebuilt
+    // whenever the data or the aggregate filter changes
+    GrowthTables growthTables;
+    
+    bool includeInScan(const std::string& countryCode) const;
+    void rebuildGrowthTables();
+    std::vector<std::pair<std::string, long long>> getPopulationByGroup(int year, CountryGroups::Grouping grouping) const;
+    
+    // Worker threads per parallel query / load, optionally pinned to CPUs
+    int threadCount;
+    bool pinThreads;
+    
     // Pthread synchronization
     pthread_mutex_t resultsMutex;
     pthread_attr_t threadAttr;
     
-    // Helper function to parse CSV line
-    std::vector<std::string> parseCSVLine(const std::string& line);
-    
-    // Helper function to convert string to long long
-    long long stringToLongLong(const std::string& str);
-    
     // Pthread helper functions
     static void* threadWorkerTopCountries(void* arg);
-    static void* threadWorkerGlobalGrowth(void* arg);
     static void* threadWorkerGrowthRates(void* arg);
     static void* threadWorkerWorldPopulation(void* arg);
     static void* threadWorkerLargeCountries(void* arg);
@@ -51,10 +78,47 @@ public:
     // Load data from CSV file
     bool loadFromCSV(const std::string& filename);
     
+    // Threads used by the load and the parallel queries (default 4)
+    void setThreadCount(int threads);
+    int getThreadCount() const;
+    
+    // Pin worker i to the i-th allowed CPU, for scaling runs
+    void setPinThreads(bool pin);
+    
+    // All indicators from the last loaded file (population is SP.POP.TOTL)
+    const IndicatorRegistry& getIndicators() const;
+    
+    // Load Region / IncomeGroup from the Metadata_Country_*.csv file
+    bool loadCountryMetadata(const std::string& filename);
+    
+    // Aggregates ("World", regions, income bands) per the metadata file
+    bool isAggregate(const std::string& countryCode) const;
+    void setIncludeAggregates(bool include);
+    
+    // Population per Region / IncomeGroup for a year, sorted by group name
+    std::vector<std::pair<std::string, long long>> getPopulationByRegion(int year) const;
+    std::vector<std::pair<std::string, long long>> getPopulationByIncomeGroup(int year) const;
+    
     // Query functions
     long long getPopulation(const std::string& countryCode, int year);
     long long getPopulationByName(const std::string& countryName, int year);
     
+    // Resolve a country code once and reuse the id; -1 if unknown
+    int resolveCountry(const std::string& countryCode) const;
+    
+    // Lookup by resolved id, -1 if the id, year or value is missing
+    long long getPopulationById(int countryId, int year) const {
+        unsigned column = static_cast<unsigned>(year - firstYear);
+        if (countryId < 0 || countryId >= static_cast<int>(indicators.getCountryCount()) || column >= static_cast<unsigned>(yearCount)) {
+            return -1;
+        }
+        return populationMatrix[static_cast<size_t>(countryId) * yearCount + column];
+    }
+    
+    // Batched lookups: out[i] = population of (countryIds[i], years[i]) or -1.
+    // Cells a few iterations ahead are prefetched while the current one is read.
+    void getPopulationBatch(const int* countryIds, const int* years, size_t count, long long* out) const;
+    
     // Get all available years
     const std::vector<int>& getAvailableYears() const;
     
@@ -76,8 +140,7 @@ public:
         auto start = std::chrono::high_resolution_clock::now();
         func();
         auto end = std::chrono::high_resolution_clock::now();
-        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
-        return duration.count() / 1000.0; // Return time in milliseconds
+        return std::chrono::duration<double, std::milli>(end - start).count(); // Return time in milliseconds
     }
     
     // Display functions
@@ -88,6 +151,15 @@ public:
     std::vector<std::pair<std::string, long long>> getTopCountriesByPopulation(int year, int topN = 10, bool useParallel = true);
     double calculateGlobalPopulationGrowth(int startYear, int endYear, bool useParallel = true);
     std::vector<std::pair<std::string, double>> calculateCountryGrowthRates(int startYear, int endYear, bool useParallel = true);
+    
+    // O(1) range queries from the growth tables
+    double calculateCAGR(const std::string& countryCode, int startYear, int endYear) const;
+    std::pair<int, long long> getPeakPopulation(const std::string& countryCode, int startYear, int endYear) const;
+    
+    // Global growth (%) for every (startYear, endYear) pair, years x years row-major
+    std::vector<double> calculateGlobalGrowthMatrix() const;
+    
+    const GrowthTables& getGrowthTables() const;
     long long calculateTotalWorldPopulation(int year, bool useParallel = true);
     std::vector<std::pair<std::string, long long>> findCountriesWithPopulationAbove(long long threshold, int year, bool useParallel = true);
     
@@ -106,20 +178,8 @@ struct ThreadDataTopCountries {
     size_t end;
 };
 
-struct ThreadDataGlobalGrowth {
-    PopulationData* data;
-    std::vector<std::pair<std::string, std::unordered_map<int, long long>>>* countryVector;
-    int startYear;
-    int endYear;
-    long long* startPopulation;
-    long long* endPopulation;
-    size_t start;
-    size_t end;
-};
-
 struct ThreadDataGrowthRates {
     PopulationData* data;
-    std::vector<std::pair<std::string, std::unordered_map<int, long long>>>* countryVector;
     int startYear;
     int endYear;
     std::vector<std::pair<std::string, double>>* results;
@@ -0,0 +1,91 @@
+#include "PopulationServer.h"
+#include <vector>
+
+namespace PopulationProtocol {
+
+void writeList(WireWriter& out, const std::vector<std::pair<std::string, long long>>& list) {
+    out.u32(static_cast<uint32_t>(list.size()));
+    for (const auto& entry : list) {
+        out.str(entry.first);
+        out.i64(entry.second);
+    }
+}
+
+std::vector<std::pair<std::string, long long>> readList(WireReader& in) {
+    std::vector<std::pair<std::string, long long>> list(in.u32());
+    for (auto& entry : list) {
+        entry.first = in.str();
+        entry.second = in.i64();
+    }
+    return list;
+}
+
+} // namespace PopulationProtocol
+
+PopulationServer::PopulationServer(PopulationData& populationData, int workers)
+    : data(populationData),
+      server([this](uint16_t opcode, WireReader& in, WireWriter& out) { handle(opcode, in, out); }, workers) {
+}
+
+void PopulationServer::handle(uint16_t opcode, WireReader& in, WireWriter& out) {
+    using namespace PopulationProtocol;
+
+    switch (opcode) {
+    case PING:
+        break;
+    case POPULATION: {
+        std::string code = in.str();
+        out.i64(data.getPopulation(code, in.i32()));
+        break;
+    }
+    case POPULATION_BATCH: {
+        // Resolve every code first, then one prefetching batch lookup
+        uint32_t count = in.u32();
+        std::vector<int> ids;
+        std::vector<int> years;
+        for (uint32_t i = 0; i < count; ++i) {
+            ids.push_back(data.resolveCountry(in.str()));
+            years.push_back(in.i32());
+        }
+        std::vector<long long> populations(count);
+        data.getPopulationBatch(ids.data(), years.data(), count, populations.data());
+        for (long long population : populations) {
+            out.i64(population);
+        }
+        break;
+    }
+    case TOP_COUNTRIES: {
+        int year = in.i32();
+        int topN = static_cast<int>(in.u32());
+        writeList(out, data.getTopCountriesByPopulation(year, topN, false));
+        break;
+    }
+    case WORLD_POPULATION:
+        out.i64(data.calculateTotalWorldPopulation(in.i32(), false));
+        break;
+    case CAGR: {
+        std::string code = in.str();
+        int startYear = in.i32();
+        out.f64(data.calculateCAGR(code, startYear, in.i32()));
+        break;
+    }
+    case PEAK: {
+        std::string code = in.str();
+        int startYear = in.i32();
+        std::pair<int, long long> peak = data.getPeakPopulation(code, startYear, in.i32());
+        out.i32(peak.first);
+        out.i64(peak.second);
+        break;
+    }
+    case COUNTRIES_ABOVE: {
+        long long threshold = in.i64();
+        writeList(out, data.findCountriesWithPopulationAbove(threshold, in.i32(), false));
+        break;
+    }
+    case BY_REGION:
+        writeList(out, data.getPopulationByRegion(in.i32()));
+        break;
+    default:
+        throw QueryServer::UnknownOpcode();
+    }
+}
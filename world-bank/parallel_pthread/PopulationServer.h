@@ -0,0 +1,65 @@
+#ifndef POPULATION_SERVER_H
+#define POPULATION_SERVER_H
+
+#include <string>
+#include "PopulationData.h"
+#include "QueryServer.h"
+
+// Request / response bodies of the population server (framing in
+// common/QueryServer.h). Missing values are -1 (NaN for CAGR); country
+// lists are u32 n, n x (str code, i64 population).
+//
+//   PING              -> (empty)
+//   POPULATION        str code, i32 year            -> i64
+//   POPULATION_BATCH  u32 n, n x (str code, i32 year) -> n x i64
+//   TOP_COUNTRIES     i32 year, u32 n               -> country list
+//   WORLD_POPULATION  i32 year                      -> i64
+//   CAGR              str code, i32 start, i32 end  -> f64 (percent)
+//   PEAK              str code, i32 start, i32 end  -> i32 year, i64
+//   COUNTRIES_ABOVE   i64 threshold, i32 year       -> country list
+//   BY_REGION         i32 year                      -> region list (same shape)
+namespace PopulationProtocol {
+
+enum Op : uint16_t {
+    PING = 0,
+    POPULATION = 1,
+    POPULATION_BATCH = 2,
+    TOP_COUNTRIES = 3,
+    WORLD_POPULATION = 4,
+    CAGR = 5,
+    PEAK = 6,
+    COUNTRIES_ABOVE = 7,
+    BY_REGION = 8
+};
+
+void writeList(WireWriter& out, const std::vector<std::pair<std::string, long long>>& list);
+std::vector<std::pair<std::string, long long>> readList(WireReader& in);
+
+} // namespace PopulationProtocol
+
+// Serves loaded population data over QueryServer. The queries it calls only
+// read the data, so requests run concurrently on the server's workers; scans
+// use their single-threaded form, since the table is small and the
+// workers already keep the cores busy.
+class PopulationServer {
+private:
+    PopulationData& data;
+    QueryServer server;
+
+    void handle(uint16_t opcode, WireReader& in, WireWriter& out);
+
+public:
+    // workers = 0: one per core
+    explicit PopulationServer(PopulationData& populationData, int workers = 0);
+
+    bool listenUnix(const std::string& path) { return server.listenUnix(path); }
+    bool listenTcp(int port) { return server.listenTcp(port); }
+    const std::string& lastError() const { return server.lastError(); }
+    int getTcpPort() const { return server.getTcpPort(); }
+    uint64_t getRequestCount() const { return server.getRequestCount(); }
+
+    void run() { server.run(); }
+    void stop() { server.stop(); }
+};
+
+#endif // POPULATION_SERVER_H
@@ -0,0 +1,121 @@
+#include "PopulationData.h"
+#include "BenchHarness.h"
+#include "Decompress.h"
+#include <random>
+
+// Benchmarks the load and every query at each thread count. threads:1 is
+// the single-threaded implementation, higher counts the pthread one.
+//   population_bench [--data DIR] [--threads 1,2,4] [--reps N] [--filter TEXT]
+//                    [--json FILE] [--csv FILE] [--scaling] [--pin] [--perf]
+// --scaling only runs the cases that have a parallel form and prints
+// speedup / efficiency per thread count.
+int main(int argc, char* argv[]) {
+    BenchOptions options = BenchSuite::parseArgs(argc, argv);
+    if (options.dataPath.empty()) {
+        options.dataPath = "data";
+    }
+    if (options.threadCounts.empty()) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        options.threadCounts = BenchSuite::defaultThreadCounts(std::max(4L, cpus));
+    }
+    std::string csvFile = Decompressor::findInput(options.dataPath + "/API_SP.POP.TOTL_DS2_en_csv_v2_3401680.csv");
+    std::string metadataFile = Decompressor::findInput(options.dataPath + "/Metadata_Country_API_SP.POP.TOTL_DS2_en_csv_v2_3401680.csv");
+    
+    // The load prints a summary line; keep it out of the report
+    std::streambuf* coutBuffer = std::cout.rdbuf();
+    std::ostringstream discard;
+    std::cout.rdbuf(discard.rdbuf());
+    
+    BenchSuite suite("population-data", options);
+    long long sink = 0;
+    
+    PopulationData data;
+    data.setPinThreads(options.pinThreads);
+    if (!data.loadFromCSV(csvFile)) {
+        std::cout.rdbuf(coutBuffer);
+        return 1;
+    }
+    data.loadCountryMetadata(metadataFile);
+    
+    // Per-row counter figures: the load touches every (country, indicator) row
+    const IndicatorRegistry& registry = data.getIndicators();
+    suite.setRowsPerRun(registry.getCountryCount() * registry.getIndicatorCount());
+    for (int threads : options.threadCounts) {
+        suite.run("load", threads, [&]() {
+            PopulationData fresh;
+            fresh.setThreadCount(threads);
+            fresh.setPinThreads(options.pinThreads);
+            fresh.loadFromCSV(csvFile);
+            fresh.loadCountryMetadata(metadataFile);
+            sink += fresh.getCountryCount();
+        }, 5);
+    }
+    
+    // Point lookups use the same random (country, year) pairs as main.cpp
+    std::vector<std::string> countries = data.getAllCountries();
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<> countryDist(0, countries.size() - 1);
+    std::uniform_int_distribution<> yearDist(1960, 2023);
+    const int lookups = 10000;
+    std::vector<std::string> codes(lookups);
+    std::vector<std::string> names(lookups);
+    std::vector<int> ids(lookups);
+    std::vector<int> years(lookups);
+    std::vector<long long> out(lookups);
+    for (int i = 0; i < lookups; ++i) {
+        codes[i] = countries[countryDist(gen)];
+        names[i] = data.getCountryName(codes[i]);
+        ids[i] = data.resolveCountry(codes[i]);
+        years[i] = yearDist(gen);
+    }
+    
+    // Single-threaded lookups and group queries, skipped in a scaling sweep
+    if (!options.scaling) {
+        suite.setRowsPerRun(lookups);
+        suite.run("getPopulation x10000", 1, [&]() {
+            for (int i = 0; i < lookups; ++i) sink += data.getPopulation(codes[i], years[i]);
+        });
+        suite.run("getPopulationByName x10000", 1, [&]() {
+            for (int i = 0; i < lookups; ++i) sink += data.getPopulationByName(names[i], years[i]);
+        });
+        suite.run("getPopulationBatch x10000", 1, [&]() {
+            data.getPopulationBatch(ids.data(), years.data(), lookups, out.data());
+            sink += out[0];
+        });
+        suite.setRowsPerRun(data.getCountryCount());
+        suite.run("getPopulationByRegion", 1, [&]() {
+            sink += data.getPopulationByRegion(2020).size();
+        });
+        suite.run("calculateGlobalGrowthMatrix", 1, [&]() {
+            sink += data.calculateGlobalGrowthMatrix().size();
+        });
+    }
+    
+    // Queries with a single-threaded and a pthread implementation
+    suite.setRowsPerRun(data.getCountryCount());
+    for (int threads : options.threadCounts) {
+        bool useParallel = threads > 1;
+        data.setThreadCount(threads);
+        
+        suite.run("getTopCountriesByPopulation", threads, [&]() {
+            sink += data.getTopCountriesByPopulation(2020, 10, useParallel).size();
+        });
+        suite.run("calculateGlobalPopulationGrowth", threads, [&]() {
+            sink += static_cast<long long>(data.calculateGlobalPopulationGrowth(1960, 2020, useParallel));
+        });
+        suite.run("calculateCountryGrowthRates", threads, [&]() {
+            sink += data.calculateCountryGrowthRates(1960, 2020, useParallel).size();
+        });
+        suite.run("calculateTotalWorldPopulation", threads, [&]() {
+            sink += data.calculateTotalWorldPopulation(2020, useParallel);
+        });
+        suite.run("findCountriesWithPopulationAbove", threads, [&]() {
+            sink += data.findCountriesWithPopulationAbove(100000000, 2020, useParallel).size();
+        });
+    }
+    
+    std::cout.rdbuf(coutBuffer);
+    suite.report(std::cout);
+    
+    return sink == 0;
+}
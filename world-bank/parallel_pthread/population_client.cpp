@@ -0,0 +1,189 @@
+#include "PopulationServer.h"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+namespace {
+
+bool connectTo(QueryClient& client, const std::string& socketPath, int port) {
+    return socketPath.empty() ? client.connectTcp(port) : client.connectUnix(socketPath);
+}
+
+// Body and opcode of one load-test request
+uint16_t loadRequest(const std::string& kind, WireWriter& body) {
+    if (kind == "ping") {
+        return PopulationProtocol::PING;
+    }
+    if (kind == "top") {
+        body.i32(2020);
+        body.u32(10);
+        return PopulationProtocol::TOP_COUNTRIES;
+    }
+    if (kind == "batch") {
+        const char* codes[] = {"USA", "CHN", "IND", "BRA", "NGA", "DEU", "JPN", "IDN"};
+        body.u32(64);
+        for (int i = 0; i < 64; ++i) {
+            body.str(codes[i % 8]);
+            body.i32(1960 + i);
+        }
+        return PopulationProtocol::POPULATION_BATCH;
+    }
+    body.str("USA");
+    body.i32(2020);
+    return PopulationProtocol::POPULATION;
+}
+
+// connections threads, each sending requests one at a time
+int loadTest(const std::string& socketPath, int port, int connections, int requests, const std::string& kind) {
+    WireWriter body;
+    uint16_t opcode = loadRequest(kind, body);
+    std::vector<std::vector<double>> latencies(connections);
+    std::vector<int> failures(connections, 0);
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int c = 0; c < connections; ++c) {
+        threads.emplace_back([&, c]() {
+            QueryClient client;
+            if (!connectTo(client, socketPath, port)) {
+                failures[c] = requests;
+                return;
+            }
+            std::string response;
+            latencies[c].reserve(requests);
+            for (int i = 0; i < requests; ++i) {
+                auto sent = std::chrono::steady_clock::now();
+                if (client.call(opcode, body.bytes(), response) != QueryServer::OK) {
+                    failures[c]++;
+                }
+                latencies[c].push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - sent).count());
+            }
+        });
+    }
+    for (std::thread& t : threads) {
+        t.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<double> all;
+    int failed = 0;
+    for (int c = 0; c < connections; ++c) {
+        all.insert(all.end(), latencies[c].begin(), latencies[c].end());
+        failed += failures[c];
+    }
+    if (all.empty()) {
+        std::cerr << "could not connect" << std::endl;
+        return 1;
+    }
+    std::sort(all.begin(), all.end());
+    auto percentile = [&](double p) { return all[std::min(all.size() - 1, static_cast<size_t>(p * all.size()))]; };
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << kind << ": " << all.size() << " requests over " << connections << " connections in "
+              << seconds * 1000 << " ms" << std::endl;
+    std::cout << "  throughput: " << all.size() / seconds << " requests/s" << std::endl;
+    std::cout << "  latency:    p50 " << percentile(0.50) << " us, p99 " << percentile(0.99)
+              << " us, max " << all.back() << " us" << std::endl;
+    if (failed > 0) {
+        std::cout << "  failed:     " << failed << std::endl;
+    }
+    return failed > 0 ? 1 : 0;
+}
+
+void check(uint16_t status, const std::string& response) {
+    if (status != QueryServer::OK) {
+        WireReader in(response);
+        throw std::runtime_error("server error " + std::to_string(status) + ": " + in.str());
+    }
+}
+
+int samples(const std::string& socketPath, int port) {
+    QueryClient client;
+    if (!connectTo(client, socketPath, port)) {
+        std::cerr << "could not connect" << std::endl;
+        return 1;
+    }
+    std::string response;
+
+    WireWriter lookup;
+    lookup.str("USA");
+    lookup.i32(2020);
+    check(client.call(PopulationProtocol::POPULATION, lookup.bytes(), response), response);
+    std::cout << "USA population 2020: " << WireReader(response).i64() << std::endl;
+
+    WireWriter world;
+    world.i32(2020);
+    check(client.call(PopulationProtocol::WORLD_POPULATION, world.bytes(), response), response);
+    std::cout << "World population 2020: " << WireReader(response).i64() << std::endl;
+
+    WireWriter cagr;
+    cagr.str("IND");
+    cagr.i32(1960);
+    cagr.i32(2020);
+    check(client.call(PopulationProtocol::CAGR, cagr.bytes(), response), response);
+    std::cout << "India CAGR 1960-2020: " << std::fixed << std::setprecision(2)
+              << WireReader(response).f64() << "%" << std::endl;
+
+    WireWriter top;
+    top.i32(2020);
+    top.u32(5);
+    check(client.call(PopulationProtocol::TOP_COUNTRIES, top.bytes(), response), response);
+    WireReader topReader(response);
+    std::cout << "\nTop 5 countries by population (2020):" << std::endl;
+    for (const auto& entry : PopulationProtocol::readList(topReader)) {
+        std::cout << "  " << entry.first << ": " << entry.second << std::endl;
+    }
+
+    check(client.call(PopulationProtocol::BY_REGION, world.bytes(), response), response);
+    WireReader regionReader(response);
+    std::cout << "\nPopulation by region (2020):" << std::endl;
+    for (const auto& entry : PopulationProtocol::readList(regionReader)) {
+        std::cout << "  " << entry.first << ": " << entry.second << std::endl;
+    }
+    return 0;
+}
+
+} // namespace
+
+// population_client (--socket PATH | --port N) [--load CONNECTIONS REQUESTS [ping|lookup|batch|top]]
+//   without --load: a few sample requests
+//   --load: closed-loop load test reporting requests/s and p50 / p99 latency
+int main(int argc, char* argv[]) {
+    std::string socketPath;
+    int port = -1;
+    int connections = 0;
+    int requests = 0;
+    std::string kind = "lookup";
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--socket" && i + 1 < argc) {
+            socketPath = argv[++i];
+        } else if (arg == "--port" && i + 1 < argc) {
+            port = std::atoi(argv[++i]);
+        } else if (arg == "--load" && i + 2 < argc) {
+            connections = std::max(1, std::atoi(argv[++i]));
+            requests = std::max(1, std::atoi(argv[++i]));
+            if (i + 1 < argc && argv[i + 1][0] != '-') {
+                kind = argv[++i];
+            }
+        }
+    }
+    if (socketPath.empty() && port < 0) {
+        std::cerr << "usage: population_client (--socket PATH | --port N) "
+                  << "[--load CONNECTIONS REQUESTS [ping|lookup|batch|top]]" << std::endl;
+        return 2;
+    }
+
+    try {
+        if (connections > 0) {
+            return loadTest(socketPath, port, connections, requests, kind);
+        }
+        return samples(socketPath, port);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+}
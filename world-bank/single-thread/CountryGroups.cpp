@@ -0,0 +1,174 @@
+#include "CountryGroups.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+// Reads one CSV record. Unlike the data files, the metadata notes contain
+// quoted commas and line breaks, so quoting is tracked across lines.
+bool readRecord(std::istream& in, std::vector<std::string>& fields) {
+    fields.clear();
+    std::string current;
+    bool inQuotes = false;
+    bool any = false;
+    char c;
+
+    while (in.get(c)) {
+        any = true;
+        if (inQuotes) {
+            if (c == '"') {
+                if (in.peek() == '"') {
+                    in.get(c);
+                    current += '"';
+                } else {
+                    inQuotes = false;
+                }
+            } else {
+                current += c;
+            }
+        } else if (c == '"') {
+            inQuotes = true;
+        } else if (c == ',') {
+            fields.push_back(current);
+            current.clear();
+        } else if (c == '\n') {
+            break;
+        } else if (c != '\r') {
+            current += c;
+        }
+    }
+
+    if (any) {
+        fields.push_back(current);
+    }
+    return any;
+}
+
+} // namespace
+
+bool CountryGroups::loadFromCSV(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open file " << filename << std::endl;
+        return false;
+    }
+
+    std::vector<std::string> fields;
+    if (!readRecord(file, fields) || fields.empty()) {
+        return false;
+    }
+    if (fields[0].compare(0, 3, "\xEF\xBB\xBF") == 0) {
+        fields[0].erase(0, 3); // UTF-8 BOM
+    }
+
+    // Locate the columns by name
+    int codeColumn = -1;
+    int regionColumn = -1;
+    int incomeColumn = -1;
+    for (size_t i = 0; i < fields.size(); ++i) {
+        if (fields[i] == "Country Code") codeColumn = i;
+        else if (fields[i] == "Region") regionColumn = i;
+        else if (fields[i] == "IncomeGroup") incomeColumn = i;
+    }
+    if (codeColumn < 0 || regionColumn < 0 || incomeColumn < 0) {
+        std::cerr << "Error: " << filename << " has no Country Code/Region/IncomeGroup columns" << std::endl;
+        return false;
+    }
+
+    regionOf.clear();
+    incomeGroupOf.clear();
+    aggregates.clear();
+
+    int maxColumn = std::max(codeColumn, std::max(regionColumn, incomeColumn));
+    while (readRecord(file, fields)) {
+        if (static_cast<int>(fields.size()) <= maxColumn || fields[codeColumn].empty()) {
+            continue;
+        }
+
+        const std::string& code = fields[codeColumn];
+        regionOf[code] = fields[regionColumn];
+        incomeGroupOf[code] = fields[incomeColumn];
+        if (fields[regionColumn].empty()) {
+            aggregates.insert(code);
+        }
+    }
+
+    std::cout << "Loaded metadata for " << regionOf.size() << " economies ("
+              << aggregates.size() << " aggregates)" << std::endl;
+    return true;
+}
+
+bool CountryGroups::isAggregate(const std::string& countryCode) const {
+    return aggregates.count(countryCode) > 0;
+}
+
+std::string CountryGroups::getRegion(const std::string& countryCode) const {
+    auto it = regionOf.find(countryCode);
+    return it != regionOf.end() ? it->second : "";
+}
+
+std::string CountryGroups::getIncomeGroup(const std::string& countryCode) const {
+    auto it = incomeGroupOf.find(countryCode);
+    return it != incomeGroupOf.end() ? it->second : "";
+}
+
+void CountryGroups::buildSegments(Segments& target, const std::unordered_map<std::string, std::string>& groupOf,
+                                  const IndicatorRegistry& registry) {
+    // (group, row) pairs for every classified non-aggregate country
+    std::vector<std::pair<std::string, int>> members;
+    for (size_t row = 0; row < registry.getCountryCount(); ++row) {
+        auto it = groupOf.find(registry.getCountryCode(row));
+        if (it != groupOf.end() && !it->second.empty()) {
+            members.push_back({it->second, static_cast<int>(row)});
+        }
+    }
+    std::sort(members.begin(), members.end());
+
+    target.names.clear();
+    target.rows.clear();
+    target.ends.clear();
+    for (const auto& member : members) {
+        if (target.names.empty() || target.names.back() != member.first) {
+            if (!target.names.empty()) {
+                target.ends.push_back(target.rows.size());
+            }
+            target.names.push_back(member.first);
+        }
+        target.rows.push_back(member.second);
+    }
+    if (!target.names.empty()) {
+        target.ends.push_back(target.rows.size());
+    }
+}
+
+void CountryGroups::bind(const IndicatorRegistry& registry) {
+    buildSegments(segments[REGION], regionOf, registry);
+    buildSegments(segments[INCOME_GROUP], incomeGroupOf, registry);
+}
+
+const std::vector<std::string>& CountryGroups::getGroupNames(Grouping grouping) const {
+    return segments[grouping].names;
+}
+
+std::vector<double> CountryGroups::sumByGroup(const IndicatorMatrix& matrix, int yearCount, Grouping grouping) const {
+    const Segments& seg = segments[grouping];
+    std::vector<double> totals(seg.names.size() * yearCount, 0.0);
+
+    size_t begin = 0;
+    for (size_t g = 0; g < seg.names.size(); ++g) {
+        double* acc = totals.data() + g * yearCount;
+        for (size_t i = begin; i < seg.ends[g]; ++i) {
+            const double* values = matrix.values.data() + static_cast<size_t>(seg.rows[i]) * yearCount;
+            // Contiguous over years, so this inner loop vectorises; the
+            // self-comparison drops NaN (missing) cells
+            for (int y = 0; y < yearCount; ++y) {
+                double v = values[y];
+                acc[y] += (v == v) ? v : 0.0;
+            }
+        }
+        begin = seg.ends[g];
+    }
+
+    return totals;
+}
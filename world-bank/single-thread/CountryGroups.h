@@ -0,0 +1,62 @@
+#ifndef COUNTRY_GROUPS_H
+#define COUNTRY_GROUPS_H
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "IndicatorRegistry.h"
+
+// Region / IncomeGroup classification from the World Bank
+// Metadata_Country_*.csv file. Rows with an empty Region are aggregates
+// ("World", "Africa Eastern and Southern", income bands, ...).
+class CountryGroups {
+public:
+    enum Grouping {
+        REGION = 0,
+        INCOME_GROUP = 1
+    };
+
+private:
+    // Key: Country Code, Value: Region / IncomeGroup name
+    std::unordered_map<std::string, std::string> regionOf;
+    std::unordered_map<std::string, std::string> incomeGroupOf;
+    std::unordered_set<std::string> aggregates;
+
+    // Registry rows laid out group by group, so every group is one
+    // contiguous segment rows[ends[g - 1]..ends[g])
+    struct Segments {
+        std::vector<std::string> names;
+        std::vector<int> rows;
+        std::vector<size_t> ends;
+    };
+    Segments segments[2];
+
+    void buildSegments(Segments& target, const std::unordered_map<std::string, std::string>& groupOf,
+                       const IndicatorRegistry& registry);
+
+public:
+    // Load the country metadata file
+    bool loadFromCSV(const std::string& filename);
+
+    bool isLoaded() const { return !regionOf.empty(); }
+
+    // True for regional / income aggregates; unknown codes are not aggregates
+    bool isAggregate(const std::string& countryCode) const;
+
+    std::string getRegion(const std::string& countryCode) const;
+    std::string getIncomeGroup(const std::string& countryCode) const;
+
+    // Index the registry's country rows by group; call again after reloading data
+    void bind(const IndicatorRegistry& registry);
+
+    // Group names in segment order (sorted), empty until bind()
+    const std::vector<std::string>& getGroupNames(Grouping grouping) const;
+
+    // Segmented reduction: sums an indicator for every group and year in a
+    // single pass over the matrix. Result is groups x years, row-major;
+    // missing cells count as zero.
+    std::vector<double> sumByGroup(const IndicatorMatrix& matrix, int yearCount, Grouping grouping) const;
+};
+
+#endif // COUNTRY_GROUPS_H
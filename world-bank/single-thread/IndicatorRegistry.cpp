@@ -0,0 +1,281 @@
+#include "IndicatorRegistry.h"
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+
+namespace {
+
+const double kMissing = std::numeric_limits<double>::quiet_NaN();
+
+// Scans one CSV field starting at p. On return [begin, begin + len) holds the
+// field without its surrounding quotes and the result points past the comma.
+const char* scanField(const char* p, const char* end, const char*& begin, size_t& len) {
+    if (p < end && *p == '"') {
+        ++p;
+        begin = p;
+        while (p < end) {
+            if (*p == '"') {
+                if (p + 1 < end && p[1] == '"') {
+                    p += 2; // escaped quote
+                    continue;
+                }
+                break;
+            }
+            ++p;
+        }
+        len = p - begin;
+        while (p < end && *p != ',') {
+            ++p;
+        }
+    } else {
+        begin = p;
+        while (p < end && *p != ',') {
+            ++p;
+        }
+        len = p - begin;
+    }
+    if (p < end) {
+        ++p; // skip the comma
+    }
+    return p;
+}
+
+// Copies a field, collapsing "" escapes
+std::string fieldToString(const char* begin, size_t len) {
+    std::string result(begin, len);
+    if (std::memchr(begin, '"', len) != nullptr) {
+        std::string unescaped;
+        for (size_t i = 0; i < result.size(); ++i) {
+            unescaped += result[i];
+            if (result[i] == '"' && i + 1 < result.size() && result[i + 1] == '"') {
+                ++i;
+            }
+        }
+        result.swap(unescaped);
+    }
+    return result;
+}
+
+// Integers (the common case for counts such as population) are converted
+// inline; anything else goes through strtod
+double parseValue(const char* begin, size_t len) {
+    if (len == 0) {
+        return kMissing;
+    }
+
+    const char* p = begin;
+    const char* end = begin + len;
+    bool negative = (*p == '-');
+    if (negative) {
+        ++p;
+    }
+
+    const char* digits = p;
+    long long value = 0;
+    while (p < end && p - digits < 18 && *p >= '0' && *p <= '9') {
+        value = value * 10 + (*p - '0');
+        ++p;
+    }
+    if (p == end && p != digits) {
+        return negative ? -static_cast<double>(value) : static_cast<double>(value);
+    }
+
+    char* stop = nullptr;
+    double parsed = std::strtod(begin, &stop);
+    return stop == begin ? kMissing : parsed;
+}
+
+// Splits [begin, end) into lines, handling CRLF
+const char* nextLine(const char* p, const char* end, const char*& lineEnd) {
+    const char* newline = static_cast<const char*>(std::memchr(p, '\n', end - p));
+    const char* next = newline ? newline + 1 : end;
+    lineEnd = newline ? newline : end;
+    if (lineEnd > p && lineEnd[-1] == '\r') {
+        --lineEnd;
+    }
+    return next;
+}
+
+void parseRows(const char* begin, const char* end, int yearCount,
+               std::vector<IndicatorRegistry::ParsedRow>& rows, std::vector<double>& values) {
+    const char* p = begin;
+
+    while (p < end) {
+        const char* lineEnd;
+        const char* next = nextLine(p, end, lineEnd);
+
+        if (lineEnd > p) {
+            IndicatorRegistry::ParsedRow row;
+            const char* cursor = p;
+            int fieldCount = 0;
+            while (fieldCount < 4 && cursor < lineEnd) {
+                cursor = scanField(cursor, lineEnd, row.fields[fieldCount], row.lengths[fieldCount]);
+                ++fieldCount;
+            }
+
+            if (fieldCount == 4 && row.lengths[1] > 0 && row.lengths[3] > 0) {
+                row.valueOffset = values.size();
+                for (int y = 0; y < yearCount; ++y) {
+                    if (cursor < lineEnd) {
+                        const char* field;
+                        size_t len;
+                        cursor = scanField(cursor, lineEnd, field, len);
+                        values.push_back(parseValue(field, len));
+                    } else {
+                        values.push_back(kMissing);
+                    }
+                }
+                rows.push_back(row);
+            }
+        }
+
+        p = next;
+    }
+}
+
+} // namespace
+
+IndicatorRegistry::IndicatorRegistry() : firstYear(0), yearCount(0) {
+}
+
+void IndicatorRegistry::clear() {
+    firstYear = 0;
+    yearCount = 0;
+    countryCodes.clear();
+    countryNames.clear();
+    countryIndex.clear();
+    indicators.clear();
+    indicatorOrder.clear();
+}
+
+bool IndicatorRegistry::parseHeader(const char* begin, const char* end) {
+    const char* p = begin;
+    int column = 0;
+    int firstYearColumn = -1;
+    yearCount = 0;
+
+    while (p < end) {
+        const char* field;
+        size_t len;
+        p = scanField(p, end, field, len);
+
+        if (column >= 4 && len > 0 && len <= 4) {
+            int year = std::atoi(std::string(field, len).c_str());
+            if (year > 0) {
+                if (firstYearColumn < 0) {
+                    firstYearColumn = column;
+                    firstYear = year;
+                }
+                ++yearCount;
+            }
+        }
+        ++column;
+    }
+
+    return firstYearColumn == 4 && yearCount > 0;
+}
+
+bool IndicatorRegistry::loadFromCSV(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open file " << filename << std::endl;
+        return false;
+    }
+
+    // Read the whole file in one go; rows are parsed as views into it
+    file.seekg(0, std::ios::end);
+    std::string buffer(static_cast<size_t>(file.tellg()), '\0');
+    file.seekg(0, std::ios::beg);
+    file.read(&buffer[0], buffer.size());
+    file.close();
+
+    clear();
+
+    const char* p = buffer.data();
+    const char* end = p + buffer.size();
+    if (buffer.compare(0, 3, "\xEF\xBB\xBF") == 0) {
+        p += 3; // UTF-8 BOM
+    }
+
+    // Skip the "Data Source" / "Last Updated Date" preamble up to the header
+    const char* dataBegin = nullptr;
+    while (p < end) {
+        const char* lineEnd;
+        const char* next = nextLine(p, end, lineEnd);
+        if (lineEnd - p >= 14 && std::strncmp(p, "\"Country Name\"", 14) == 0) {
+            if (!parseHeader(p, lineEnd)) {
+                std::cerr << "Error: No year columns in header of " << filename << std::endl;
+                return false;
+            }
+            dataBegin = next;
+            break;
+        }
+        p = next;
+    }
+
+    if (dataBegin == nullptr) {
+        std::cerr << "Error: Missing \"Country Name\" header in " << filename << std::endl;
+        return false;
+    }
+
+    std::vector<ParsedRow> rows;
+    std::vector<double> values;
+    parseRows(dataBegin, end, yearCount, rows, values);
+
+    // Assign country rows and indicators in file order ...
+    std::vector<std::pair<int, IndicatorMatrix*>> targets;
+    targets.reserve(rows.size());
+    for (const ParsedRow& row : rows) {
+        std::string code(row.fields[1], row.lengths[1]);
+        auto countryIt = countryIndex.find(code);
+        if (countryIt == countryIndex.end()) {
+            countryIt = countryIndex.emplace(code, static_cast<int>(countryCodes.size())).first;
+            countryCodes.push_back(code);
+            countryNames.push_back(fieldToString(row.fields[0], row.lengths[0]));
+        }
+
+        std::string indicatorCode(row.fields[3], row.lengths[3]);
+        auto indicatorIt = indicators.find(indicatorCode);
+        if (indicatorIt == indicators.end()) {
+            indicatorIt = indicators.emplace(indicatorCode, IndicatorMatrix()).first;
+            indicatorIt->second.code = indicatorCode;
+            indicatorIt->second.name = fieldToString(row.fields[2], row.lengths[2]);
+            indicatorOrder.push_back(indicatorCode);
+        }
+
+        targets.push_back({countryIt->second, &indicatorIt->second});
+    }
+
+    // ... then size every matrix once and copy the parsed rows into place
+    for (auto& pair : indicators) {
+        pair.second.values.assign(countryCodes.size() * yearCount, kMissing);
+    }
+    for (size_t i = 0; i < rows.size(); ++i) {
+        const double* source = values.data() + rows[i].valueOffset;
+        double* target = targets[i].second->values.data() + static_cast<size_t>(targets[i].first) * yearCount;
+        std::memcpy(target, source, yearCount * sizeof(double));
+    }
+
+    return true;
+}
+
+int IndicatorRegistry::getCountryIndex(const std::string& countryCode) const {
+    auto it = countryIndex.find(countryCode);
+    return it != countryIndex.end() ? it->second : -1;
+}
+
+const IndicatorMatrix* IndicatorRegistry::getIndicator(const std::string& indicatorCode) const {
+    auto it = indicators.find(indicatorCode);
+    return it != indicators.end() ? &it->second : nullptr;
+}
+
+double IndicatorRegistry::getValue(const std::string& indicatorCode, const std::string& countryCode, int year) const {
+    const IndicatorMatrix* matrix = getIndicator(indicatorCode);
+    int row = getCountryIndex(countryCode);
+    if (matrix == nullptr || row < 0 || year < firstYear || year >= firstYear + yearCount) {
+        return kMissing;
+    }
+    return matrix->values[static_cast<size_t>(row) * yearCount + (year - firstYear)];
+}
@@ -0,0 +1,77 @@
+#ifndef INDICATOR_REGISTRY_H
+#define INDICATOR_REGISTRY_H
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// One World Bank indicator stored as a dense country x year matrix.
+// Row i belongs to the registry's country index i; missing cells are NaN.
+struct IndicatorMatrix {
+    std::string code;   // e.g. "SP.POP.TOTL"
+    std::string name;   // e.g. "Population, total"
+    std::vector<double> values;
+};
+
+// Loads a World Bank wide-format CSV (single indicator file or the full WDI
+// bulk file) and keeps every indicator it contains, keyed by indicator code.
+// The year range is taken from the header instead of being hard-coded.
+class IndicatorRegistry {
+public:
+    // A row of the data section. The string fields point into the file
+    // buffer; values are appended to the value pool starting at valueOffset.
+    struct ParsedRow {
+        const char* fields[4];
+        size_t lengths[4];
+        size_t valueOffset;
+    };
+
+private:
+    int firstYear;
+    int yearCount;
+
+    // Country index: row number in every IndicatorMatrix
+    std::vector<std::string> countryCodes;
+    std::vector<std::string> countryNames;
+    std::unordered_map<std::string, int> countryIndex;
+
+    std::unordered_map<std::string, IndicatorMatrix> indicators;
+    std::vector<std::string> indicatorOrder;
+
+    // Parse the "Country Name","Country Code",... header, returns false when
+    // no year columns are found
+    bool parseHeader(const char* begin, const char* end);
+
+public:
+    IndicatorRegistry();
+
+    // Load all indicators from a CSV file
+    bool loadFromCSV(const std::string& filename);
+
+    void clear();
+
+    int getFirstYear() const { return firstYear; }
+    int getLastYear() const { return firstYear + yearCount - 1; }
+    int getYearCount() const { return yearCount; }
+
+    size_t getCountryCount() const { return countryCodes.size(); }
+    size_t getIndicatorCount() const { return indicators.size(); }
+
+    // Returns the matrix row of a country code, or -1 if unknown
+    int getCountryIndex(const std::string& countryCode) const;
+    const std::string& getCountryCode(int index) const { return countryCodes[index]; }
+    const std::string& getCountryName(int index) const { return countryNames[index]; }
+    const std::vector<std::string>& getCountryCodes() const { return countryCodes; }
+    const std::vector<std::string>& getCountryNames() const { return countryNames; }
+
+    // Returns nullptr if the indicator was not in the loaded file
+    const IndicatorMatrix* getIndicator(const std::string& indicatorCode) const;
+
+    // Indicator codes in file order
+    const std::vector<std::string>& getIndicatorCodes() const { return indicatorOrder; }
+
+    // Single cell lookup, NaN if missing
+    double getValue(const std::string& indicatorCode, const std::string& countryCode, int year) const;
+};
+
+#endif // INDICATOR_REGISTRY_H
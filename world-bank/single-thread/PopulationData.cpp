@@ -2,7 +2,7 @@
 #include <algorithm>
 #include <iomanip>
 
-PopulationData::PopulationData() {
+PopulationData::PopulationData() : firstYear(0), yearCount(0), includeAggregates(false) {
     for (int year = 1960; year <= 2023; ++year) {
         availableYears.push_back(year);
     }
@@ -11,126 +11,152 @@ PopulationData::PopulationData() {
 PopulationData::~PopulationData() {
 }
 
-std::vector<std::string> PopulationData::parseCSVLine(const std::string& line) {
-    std::vector<std::string> result;
-    std::string current;
-    bool inQuotes = false;
+bool PopulationData::loadFromCSV(const std::string& filename) {
+    if (!indicators.loadFromCSV(filename)) {
+        return false;
+    }
+    
+    const IndicatorMatrix* population = indicators.getIndicator("SP.POP.TOTL");
+    if (population == nullptr) {
+        std::cerr << "Error: No \"Population, total\" (SP.POP.TOTL) rows in " << filename << std::endl;
+        return false;
+    }
+    
+    // Year range comes from the file header
+    firstYear = indicators.getFirstYear();
+    yearCount = indicators.getYearCount();
+    availableYears.clear();
+    for (int year = firstYear; year <= indicators.getLastYear(); ++year) {
+        availableYears.push_back(year);
+    }
     
-    for (size_t i = 0; i < line.length(); ++i) {
-        char c = line[i];
+    countryData.clear();
+    countryNames.clear();
+    populationMatrix.assign(indicators.getCountryCount() * yearCount, -1);
+    for (size_t row = 0; row < indicators.getCountryCount(); ++row) {
+        const std::string& countryCode = indicators.getCountryCode(row);
+        const double* values = population->values.data() + row * yearCount;
         
-        if (c == '"') {
-            inQuotes = !inQuotes;
-        } else if (c == ',' && !inQuotes) {
-            result.push_back(current);
-            current.clear();
-        } else {
-            current += c;
+        countryNames[countryCode] = indicators.getCountryName(row);
+        
+        for (int y = 0; y < yearCount; ++y) {
+            if (values[y] > 0) { // Only store valid population data (NaN marks a missing cell)
+                countryData[countryCode][firstYear + y] = static_cast<long long>(values[y]);
+                populationMatrix[row * yearCount + y] = static_cast<long long>(values[y]);
+            }
         }
     }
     
-    if (!current.empty()) {
-        result.push_back(current);
+    codeIndex.build(indicators.getCountryCodes());
+    nameIndex.build(indicators.getCountryNames());
+    
+    if (countryGroups.isLoaded()) {
+        countryGroups.bind(indicators);
     }
     
-    return result;
+    std::cout << "Loaded data for " << countryData.size() << " countries" << std::endl;
+    return true;
 }
 
-long long PopulationData::stringToLongLong(const std::string& str) {
-    if (str.empty() || str == "\"\"") {
-        return -1; // Indicates no data available
-    }
-    
-    try {
-        return std::stoll(str);
-    } catch (const std::exception&) {
-        return -1; // Indicates invalid data
-    }
+const IndicatorRegistry& PopulationData::getIndicators() const {
+    return indicators;
 }
 
-bool PopulationData::loadFromCSV(const std::string& filename) {
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-        std::cerr << "Error: Could not open file " << filename << std::endl;
+bool PopulationData::loadCountryMetadata(const std::string& filename) {
+    if (!countryGroups.loadFromCSV(filename)) {
         return false;
     }
+    countryGroups.bind(indicators);
+    return true;
+}
+
+bool PopulationData::isAggregate(const std::string& countryCode) const {
+    return countryGroups.isAggregate(countryCode);
+}
+
+void PopulationData::setIncludeAggregates(bool include) {
+    includeAggregates = include;
+}
+
+bool PopulationData::includeInScan(const std::string& countryCode) const {
+    return includeAggregates || !countryGroups.isAggregate(countryCode);
+}
+
+long long PopulationData::calculateTotalWorldPopulation(int year) const {
+    long long totalPopulation = 0;
     
-    std::string line;
-    int lineCount = 0;
-    
-    while (std::getline(file, line)) {
-        lineCount++;
-        
-        // TO Skip empty lines and header lines
-        if (line.empty() || line.find("Data Source") != std::string::npos || 
-            line.find("Last Updated Date") != std::string::npos) {
-            continue;
-        }
-        
-        // TO Skip the header line with column names (starts with "Country Name")
-        if (line.find("Country Name") != std::string::npos) {
-            continue;
-        }
-        
-        std::vector<std::string> fields = parseCSVLine(line);
+    for (const auto& country : countryData) {
+        if (!includeInScan(country.first)) continue;
         
-        //  format: Country Name, Country Code, Indicator Name, Indicator Code, 1960, 1961, ..., 2023
-        if (fields.size() < 68) { // 4 metadata columns + 64 years (1960-2023)
-            continue;
-        }
-        
-        std::string countryName = fields[0];
-        std::string countryCode = fields[1];
-        std::string indicatorName = fields[2];
-        
-        
-        if (indicatorName != "Population, total") {
-            continue;
-        }
-        
-        // TO Store country name
-        countryNames[countryCode] = countryName;
-        
-        // TO Parse population data for each year
-        for (int i = 4; i < fields.size() && i < 68; ++i) {
-            int year = 1960 + (i - 4);
-            long long population = stringToLongLong(fields[i]);
-            
-            if (population > 0) { // Only store valid population data
-                countryData[countryCode][year] = population;
-            }
+        auto yearIt = country.second.find(year);
+        if (yearIt != country.second.end()) {
+            totalPopulation += yearIt->second;
         }
     }
     
-    file.close();
-    
-    std::cout << "Loaded data for " << countryData.size() << " countries" << std::endl;
-    return true;
+    return totalPopulation;
 }
 
-long long PopulationData::getPopulation(const std::string& countryCode, int year) {
-    auto countryIt = countryData.find(countryCode);
-    if (countryIt == countryData.end()) {
-        return -1; //  not found
-    }
+std::vector<std::pair<std::string, long long>> PopulationData::getPopulationByGroup(int year, CountryGroups::Grouping grouping) const {
+    std::vector<std::pair<std::string, long long>> results;
     
-    auto yearIt = countryIt->second.find(year);
-    if (yearIt == countryIt->second.end()) {
-        return -1; 
+    const IndicatorMatrix* population = indicators.getIndicator("SP.POP.TOTL");
+    if (population == nullptr || year < indicators.getFirstYear() || year > indicators.getLastYear()) {
+        return results;
     }
     
-    return yearIt->second;
+    int yearCount = indicators.getYearCount();
+    std::vector<double> totals = countryGroups.sumByGroup(*population, yearCount, grouping);
+    const std::vector<std::string>& names = countryGroups.getGroupNames(grouping);
+    
+    int column = year - indicators.getFirstYear();
+    for (size_t g = 0; g < names.size(); ++g) {
+        results.push_back({names[g], static_cast<long long>(totals[g * yearCount + column])});
+    }
+    return results;
+}
+
+std::vector<std::pair<std::string, long long>> PopulationData::getPopulationByRegion(int year) const {
+    return getPopulationByGroup(year, CountryGroups::REGION);
+}
+
+std::vector<std::pair<std::string, long long>> PopulationData::getPopulationByIncomeGroup(int year) const {
+    return getPopulationByGroup(year, CountryGroups::INCOME_GROUP);
+}
+
+long long PopulationData::getPopulation(const std::string& countryCode, int year) {
+    return getPopulationById(codeIndex.find(countryCode), year);
 }
 
 long long PopulationData::getPopulationByName(const std::string& countryName, int year) {
-    // Find country code by name
-    for (const auto& pair : countryNames) {
-        if (pair.second == countryName) {
-            return getPopulation(pair.first, year);
+    return getPopulationById(nameIndex.find(countryName), year);
+}
+
+int PopulationData::resolveCountry(const std::string& countryCode) const {
+    return codeIndex.find(countryCode);
+}
+
+void PopulationData::getPopulationBatch(const int* countryIds, const int* years, size_t count, long long* out) const {
+    const size_t prefetchDistance = 16;
+    const long long* matrix = populationMatrix.data();
+    const unsigned countryCount = static_cast<unsigned>(indicators.getCountryCount());
+    
+    for (size_t i = 0; i < count; ++i) {
+#if defined(__GNUC__)
+        if (i + prefetchDistance < count) {
+            unsigned aheadId = static_cast<unsigned>(countryIds[i + prefetchDistance]);
+            unsigned aheadColumn = static_cast<unsigned>(years[i + prefetchDistance] - firstYear);
+            if (aheadId < countryCount && aheadColumn < static_cast<unsigned>(yearCount)) {
+                __builtin_prefetch(matrix + static_cast<size_t>(aheadId) * yearCount + aheadColumn);
+            }
         }
+#endif
+        unsigned id = static_cast<unsigned>(countryIds[i]);
+        unsigned column = static_cast<unsigned>(years[i] - firstYear);
+        out[i] = (id < countryCount && column < static_cast<unsigned>(yearCount))
+                     ? matrix[static_cast<size_t>(id) * yearCount + column]
+                     : -1;
     }
-    
-    return -1; 
 }
 
 const std::vector<int>& PopulationData::getAvailableYears() const {
@@ -138,11 +164,8 @@ const std::vector<int>& PopulationData::getAvailableYears() const {
 }
 
 std::string PopulationData::getCountryName(const std::string& countryCode) const {
-    auto it = countryNames.find(countryCode);
-    if (it != countryNames.end()) {
-        return it->second;
-    }
-    return "";
+    int id = codeIndex.find(countryCode);
+    return id >= 0 ? indicators.getCountryName(id) : "";
 }
 
 std::vector<std::string> PopulationData::getAllCountries() const {
@@ -8,6 +8,9 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include "IndicatorRegistry.h"
+#include "CountryGroups.h"
+#include "CountryIndex.h"
 
 class PopulationData {
 private:
@@ -21,11 +24,26 @@ private:
     // Available years for queries
     std::vector<int> availableYears;
     
-    // Helper function to parse CSV line
-    std::vector<std::string> parseCSVLine(const std::string& line);
+    // Every indicator found in the loaded file, keyed by indicator code
+    IndicatorRegistry indicators;
     
-    // Helper function to convert string to long long
-    long long stringToLongLong(const std::string& str);
+    // Dense copy of the population matrix for id-based lookups:
+    // populationMatrix[countryId * yearCount + (year - firstYear)], -1 if missing
+    std::vector<long long> populationMatrix;
+    int firstYear;
+    int yearCount;
+    
+    // Perfect-hash indexes from country code / full name to matrix row
+    CountryCodeIndex codeIndex;
+    CountryNameIndex nameIndex;
+    
+    // Region / IncomeGroup metadata; aggregates are left out of country scans
+    // unless includeAggregates is set
+    CountryGroups countryGroups;
+    bool includeAggregates;
+    
+    bool includeInScan(const std::string& countryCode) const;
+    std::vector<std::pair<std::string, long long>> getPopulationByGroup(int year, CountryGroups::Grouping grouping) const;
 
 public:
     PopulationData();
@@ -35,10 +53,43 @@ public:
     // Load data from CSV file
     bool loadFromCSV(const std::string& filename);
     
+    // All indicators from the last loaded file (population is SP.POP.TOTL)
+    const IndicatorRegistry& getIndicators() const;
+    
+    // Load Region / IncomeGroup from the Metadata_Country_*.csv file
+    bool loadCountryMetadata(const std::string& filename);
+    
+    // Aggregates ("World", regions, income bands) per the metadata file
+    bool isAggregate(const std::string& countryCode) const;
+    void setIncludeAggregates(bool include);
+    
+    // Sum of country populations for a year, aggregates excluded by default
+    long long calculateTotalWorldPopulation(int year) const;
+    
+    // Population per Region / IncomeGroup for a year, sorted by group name
+    std::vector<std::pair<std::string, long long>> getPopulationByRegion(int year) const;
+    std::vector<std::pair<std::string, long long>> getPopulationByIncomeGroup(int year) const;
+    
     // Query functions
     long long getPopulation(const std::string& countryCode, int year);
     long long getPopulationByName(const std::string& countryName, int year);
     
+    // Resolve a country code once and reuse the id; -1 if unknown
+    int resolveCountry(const std::string& countryCode) const;
+    
+    // Lookup by resolved id, -1 if the id, year or value is missing
+    long long getPopulationById(int countryId, int year) const {
+        unsigned column = static_cast<unsigned>(year - firstYear);
+        if (countryId < 0 || countryId >= static_cast<int>(indicators.getCountryCount()) || column >= static_cast<unsigned>(yearCount)) {
+            return -1;
+        }
+        return populationMatrix[static_cast<size_t>(countryId) * yearCount + column];
+    }
+    
+    // Batched lookups: out[i] = population of (countryIds[i], years[i]) or -1.
+    // Cells a few iterations ahead are prefetched while the current one is read.
+    void getPopulationBatch(const int* countryIds, const int* years, size_t count, long long* out) const;
+    
     // Get all available years
     const std::vector<int>& getAvailableYears() const;
     